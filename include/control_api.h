@@ -0,0 +1,17 @@
+#pragma once
+
+// JSON control API on the web server, for automations without a HomeKit
+// hub:
+//
+//     GET /api/state    desired state, the heat pump settings it maps to
+//                       and what the heat pump reports, with an ETag
+//     PATCH /api/state  change some of the desired fields, If-Match with
+//                       the ETag is required
+//
+// The desired state is the one HomeKit controls: a PATCH goes through the
+// same setters as a change from the Home app and answers 202 as soon as the
+// heat pump update is queued. The ETag covers the desired fields only, so a
+// PATCH based on a state that has since been changed from HomeKit, the
+// remote or another client fails with 412 instead of overwriting it.
+
+void control_api_init();
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdint.h>
+
+// Totals that survive reboots and power loss. An increment only updates RAM
+// and a copy in RTC user memory, which survives resets but not power loss;
+// every COUNTERS_FLUSH_INTERVAL the counters that changed are appended to a
+// journal file, one small record each, and the journal is rewritten with a
+// record per counter when it reaches COUNTERS_JOURNAL_MAX. Losing power
+// loses at most one interval, and the flash sees a few small appends an
+// hour instead of a file rewrite per change.
+
+#define COUNTERS_FILE "/counters"
+#define COUNTERS_JOURNAL_MAX 256
+#define COUNTERS_FLUSH_INTERVAL (10 * 60 * 1000)
+// in 4 byte blocks, the first 128 bytes of RTC user memory belong to the
+// OTA bootloader; what comes after the counters' blocks starts at
+// COUNTERS_RTC_OFFSET + COUNTERS_RTC_BLOCKS
+#define COUNTERS_RTC_OFFSET 32
+#define COUNTERS_RTC_BLOCKS 8
+
+enum counter_t {
+    COUNTER_BOOTS,
+    // resets by an exception or a watchdog
+    COUNTER_CRASHES,
+    // seconds powered on
+    COUNTER_UPTIME,
+    // seconds the heat pump was heating or cooling
+    COUNTER_RUNTIME,
+    COUNTER_COMPRESSOR_STARTS,
+    COUNTER_COUNT
+};
+
+// needs LittleFS mounted; counts the boot
+void counters_init();
+void counters_add(counter_t counter, uint32_t n = 1);
+uint32_t counters_get(counter_t counter);
+const char *counters_name(counter_t counter);
+// append the changed counters to the journal now
+void counters_flush();
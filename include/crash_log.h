@@ -0,0 +1,20 @@
+#pragma once
+
+// What happened before the last reset. An exception or a software watchdog
+// reset saves its registers, the top of the stack and the cached log lines
+// to a flash sector from the core's crash callback; the next boot writes
+// them to CRASH_LOG_FILE, registers and stack in the form the core prints
+// on the serial port so the exception decoder reads them. A restart the
+// firmware asks for keeps its reason and the last log lines in RTC memory,
+// and the next boot puts them back in the log. Power loss and hardware
+// watchdog resets leave nothing behind.
+
+#define CRASH_LOG_FILE "/crash.log"
+
+// needs LittleFS mounted and the logger started; logs how the last reset
+// happened
+void crash_log_init();
+// keeps why and the last log lines, then restarts
+void crash_log_restart(const char *why);
+// how the last reset happened, for the status
+const char *crash_log_reset_reason();
@@ -1,15 +1,65 @@
 #pragma once
 
-#include <xlogger.h>
-
-extern xLogger Debug;
+#include <stddef.h>
+#include <stdint.h>
 
 void debug_init(const char ssid[]);
 void debug_loop();
+// after settings.debug or the syslog server changed
+void debug_reload();
 void logger_set_serial_enabled(bool enabled);
+// the cached log line after *position as shown, cut to size; moves position
+// past it, start from 0. False past the newest line.
+bool debug_log_line(uint32_t *position, char *str, size_t size);
+
+// MIE_LOG_DEBUG, MIE_LOG (info), MIE_LOG_WARNING and MIE_LOG_ERROR below
+// MIE_LOG_LEVEL compile to nothing: no code, no format string in flash
+#define MIE_LOG_LEVEL_DEBUG 0
+#define MIE_LOG_LEVEL_INFO 1
+#define MIE_LOG_LEVEL_WARNING 2
+#define MIE_LOG_LEVEL_ERROR 3
+#define MIE_LOG_LEVEL_NONE 4
+
+#ifndef MIE_LOG_LEVEL
+#define MIE_LOG_LEVEL MIE_LOG_LEVEL_INFO
+#endif
 
 #ifdef MIE_DEBUG
-#define MIE_LOG(s, ...) Debug.printf(PSTR(s "\r\n"), ##__VA_ARGS__)
+#include <xlogger.h>
+
+#include "heap_tracker.h"
+
+extern xLogger Debug;
+
+// stored packed, formatted only when shown (see xLogger::log)
+#define MIE_LOG_AT(level, s, ...) do { \
+    HeapTag _log_tag(HEAP_TAG_LOGGER); \
+    Debug.log(level, PSTR(s "\r\n"), ##__VA_ARGS__); \
+} while (0)
+#else
+#define MIE_LOG_AT(...)
+#endif
+
+#if MIE_LOG_LEVEL <= MIE_LOG_LEVEL_DEBUG
+#define MIE_LOG_DEBUG(s, ...) MIE_LOG_AT(llDebug, s, ##__VA_ARGS__)
+#else
+#define MIE_LOG_DEBUG(...)
+#endif
+
+#if MIE_LOG_LEVEL <= MIE_LOG_LEVEL_INFO
+#define MIE_LOG(s, ...) MIE_LOG_AT(llInfo, s, ##__VA_ARGS__)
 #else
 #define MIE_LOG(...)
 #endif
+
+#if MIE_LOG_LEVEL <= MIE_LOG_LEVEL_WARNING
+#define MIE_LOG_WARNING(s, ...) MIE_LOG_AT(llWarning, s, ##__VA_ARGS__)
+#else
+#define MIE_LOG_WARNING(...)
+#endif
+
+#if MIE_LOG_LEVEL <= MIE_LOG_LEVEL_ERROR
+#define MIE_LOG_ERROR(s, ...) MIE_LOG_AT(llError, s, ##__VA_ARGS__)
+#else
+#define MIE_LOG_ERROR(...)
+#endif
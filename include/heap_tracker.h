@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Heap usage per subsystem. With HEAP_TRACKING defined and malloc, calloc,
+// realloc and free wrapped by the linker (-Wl,--wrap=malloc ...), every
+// allocation is attributed to the tag current at the time and its size is
+// kept in a fixed table so the free is credited to the same tag. Allocations
+// that don't fit in the table, or are made by code that isn't wrapped (SDK
+// blobs), are not counted.
+//
+// Independently of the wrapping, free heap, largest free block and
+// fragmentation are sampled periodically.
+
+enum heap_tag_t {
+    // setup code, system callbacks and anything not tagged otherwise
+    HEAP_TAG_SYSTEM,
+    HEAP_TAG_WEB,
+    HEAP_TAG_HOMEKIT,
+    HEAP_TAG_HEATPUMP,
+    HEAP_TAG_MQTT,
+    HEAP_TAG_SENSOR,
+    HEAP_TAG_LOGGER,
+    HEAP_TAG_COUNT
+};
+
+#define HEAP_TRACKER_SLOTS 256
+#define HEAP_SAMPLE_INTERVAL 60000
+#define HEAP_SAMPLES 30
+
+struct heap_tag_stats_t {
+    uint32_t live;
+    uint32_t peak;
+    uint32_t allocs;
+    uint32_t frees;
+};
+
+struct heap_sample_t {
+    // seconds since boot
+    uint32_t at;
+    uint32_t free;
+    uint32_t max_block;
+    uint8_t fragmentation;
+};
+
+// set the tag for following allocations, returns the previous one
+heap_tag_t heap_tag_set(heap_tag_t tag);
+
+// tag allocations made in a scope
+class HeapTag {
+public:
+    explicit HeapTag(heap_tag_t tag) : previous(heap_tag_set(tag)) {}
+    ~HeapTag() { heap_tag_set(previous); }
+
+    HeapTag(const HeapTag &) = delete;
+    HeapTag &operator=(const HeapTag &) = delete;
+
+private:
+    heap_tag_t previous;
+};
+
+void heap_tracker_init();
+
+const char *heap_tag_name(heap_tag_t tag);
+const heap_tag_stats_t *heap_tag_stats(heap_tag_t tag);
+// allocations not counted because the table was full
+uint32_t heap_untracked();
+
+// samples oldest first, index < heap_sample_count()
+uint8_t heap_sample_count();
+const heap_sample_t *heap_sample(uint8_t index);
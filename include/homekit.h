@@ -1,5 +1,8 @@
 #pragma once
 
+#include <HeatPump.h>
+#include <homekit/types.h>
+
 #include <functional>
 
 // audo mode doesn't report the fan speed, we set a default to have a
@@ -13,6 +16,18 @@ void homekit_init(const char *ssid, std::function<void()> loop);
 void homekit_loop();
 int homekit_clients_count();
 
+// Change the desired state from outside HomeKit: the value goes through the
+// characteristic's setter like a change from the Home app, controllers are
+// notified and the heat pump update is queued. False when the value is out
+// of the characteristic's range or before the accessory is set up.
+bool homekit_control(homekit_characteristic_t *characteristic, homekit_value_t value);
+// value is in the characteristic's format and range
+bool homekit_control_accepts(const homekit_characteristic_t *characteristic, homekit_value_t value);
+// heat pump settings for the desired state, what the next update sends
+heatpumpSettings homekit_desired_settings();
+// a heat pump update is queued
+bool homekit_update_pending();
+
 // functions from the HomeKit library
 extern "C" bool homekit_is_paired();
 extern "C" int homekit_storage_reset();
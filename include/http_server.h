@@ -0,0 +1,127 @@
+#pragma once
+
+#include <ESP8266WiFi.h>
+#include <LittleFS.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "json_writer.h"
+
+// Non-blocking HTTP/1.1 server for the web UI and OTA updates. Every
+// connection is a state machine that http_server_loop() advances by a
+// bounded amount of work: requests are parsed as bytes arrive, responses are
+// written only as far as the TCP send buffer has room, and a connection that
+// makes no progress for HTTP_TIMEOUT is closed. At most HTTP_MAX_CONNECTIONS
+// are served at the same time, further ones get a 503. Connection buffers
+// are allocated on accept and freed on close.
+//
+// Every response closes the connection. Only the request headers in
+// http_header_t are kept; query and url-encoded form arguments are decoded
+// in place. Uploads (multipart/form-data) are passed to the route's upload
+// callback as they arrive instead of being buffered.
+
+#define HTTP_MAX_CONNECTIONS 3
+#define HTTP_MAX_ROUTES 20
+// milliseconds without progress before a connection is dropped
+#define HTTP_TIMEOUT 5000
+// request line and header lines, longer headers are ignored
+#define HTTP_LINE_SIZE 256
+// path, arguments, kept headers and request body
+#define HTTP_DATA_SIZE 640
+#define HTTP_MAX_ARGS 12
+// response head and body waiting for the socket
+#define HTTP_OUT_SIZE 768
+// extra response headers added with http_add_header()
+#define HTTP_HEADERS_SIZE 160
+// bytes read from a connection per loop
+#define HTTP_READ_BUDGET 1460
+// the most a step of a streamed response may write
+#define HTTP_STEP_SIZE 256
+
+enum http_method_t {
+    HTTP_METHOD_GET,
+    HTTP_METHOD_HEAD,
+    HTTP_METHOD_POST,
+    HTTP_METHOD_PUT,
+    HTTP_METHOD_PATCH,
+    HTTP_METHOD_DELETE,
+    HTTP_METHOD_OTHER,
+};
+
+// request headers kept for handlers
+enum http_header_t {
+    HTTP_HEADER_CONTENT_LENGTH,
+    HTTP_HEADER_CONTENT_TYPE,
+    HTTP_HEADER_IF_MATCH,
+    HTTP_HEADER_IF_NONE_MATCH,
+    HTTP_HEADERS
+};
+
+enum http_upload_stage_t {
+    // data is the form field name
+    HTTP_UPLOAD_START,
+    HTTP_UPLOAD_DATA,
+    HTTP_UPLOAD_END,
+    // the client went away or sent a malformed body, the handler won't run
+    HTTP_UPLOAD_ABORT,
+};
+
+struct http_request_t;
+
+typedef void (*http_handler_t)(http_request_t *request);
+typedef void (*http_upload_t)(http_request_t *request, http_upload_stage_t stage,
+        const uint8_t *data, size_t size);
+// writes the next part of a streamed response, at most HTTP_STEP_SIZE bytes,
+// step counts from 0; returns false after the last part
+typedef bool (*http_step_t)(http_request_t *request, uint16_t step);
+
+void http_server_init(uint16_t port);
+// handler must answer with one of the http_send functions or take the
+// connection with http_detach(); for routes with an upload callback it runs
+// after the upload has been received
+void http_on(const char *path, http_method_t method, http_handler_t handler, http_upload_t upload = nullptr);
+void http_server_loop();
+
+http_method_t http_method(const http_request_t *request);
+const char *http_path(const http_request_t *request);
+// nullptr when the request didn't have it
+const char *http_header(const http_request_t *request, http_header_t header);
+// request body for routes without upload callback, NUL terminated, empty
+// for forms as they are decoded into arguments
+const char *http_body(const http_request_t *request, size_t *size);
+
+uint8_t http_arg_count(const http_request_t *request);
+const char *http_arg_name(const http_request_t *request, uint8_t index);
+const char *http_arg_value(const http_request_t *request, uint8_t index);
+// nullptr when not present
+const char *http_arg(const http_request_t *request, const char *name);
+
+// before one of the http_send functions
+void http_add_header(http_request_t *request, const char *name, const char *value);
+
+// body is copied, size 0 for a NUL terminated one; the response must fit in
+// HTTP_OUT_SIZE
+void http_send(http_request_t *request, int status, const char *type = nullptr,
+        const char *body = nullptr, size_t size = 0);
+// body in flash, sent as it is
+void http_send_P(http_request_t *request, int status, const char *type, PGM_P body, size_t size);
+void http_send_file(http_request_t *request, int status, const char *type, File &file);
+// body produced by step with chunked encoding
+void http_send_steps(http_request_t *request, int status, const char *type, http_step_t step);
+
+// for steps: append to the response
+void http_write(http_request_t *request, const char *data, size_t size);
+void http_printf(http_request_t *request, const char *format, ...) __attribute__((format(printf, 2, 3)));
+// for steps: a JSON writer into the response that keeps its nesting across
+// steps
+JsonWriter &http_json(http_request_t *request);
+// for steps: a value kept from one step of the response to the next, 0 at
+// the first
+uint32_t *http_step_data(http_request_t *request);
+
+// take over the connection, for responses that stay open; nothing is sent
+WiFiClient http_detach(http_request_t *request);
+// called once the response has been sent and the connection closed
+void http_on_close(http_request_t *request, void (*callback)());
+
+uint8_t http_connection_count();
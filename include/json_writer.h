@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Streaming JSON writer for responses: output goes through a fixed buffer
+// supplied by the caller and is passed to the sink whenever it fills up, so
+// nothing is allocated and memory doesn't depend on the size of the
+// document. Output is compact. Nesting is limited to 32 levels.
+//
+//     char buffer[128];
+//     JsonWriter json(buffer, sizeof(buffer), send_chunk, nullptr);
+//     json.beginObject();
+//     json.field("uptime", 42);
+//     json.endObject();
+//     json.flush();
+
+class JsonWriter {
+public:
+    typedef void (*sink_t)(void *context, const char *data, size_t size);
+
+    JsonWriter(char *buffer, size_t size, sink_t sink, void *context);
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+
+    // object member name, followed by a value, object or array
+    void key(const char *name);
+
+    void value(const char *str);
+    void value(bool b);
+    void value(int n);
+    void value(unsigned int n);
+    void value(long n);
+    void value(unsigned long n);
+    // null when not finite
+    void value(double n, uint8_t decimals = 1);
+    void null();
+
+    template <typename T>
+    void field(const char *name, T v) {
+        key(name);
+        value(v);
+    }
+    void field(const char *name, double v, uint8_t decimals) {
+        key(name);
+        value(v, decimals);
+    }
+
+    // pass buffered output to the sink
+    void flush();
+
+    // bytes passed to the sink or still buffered
+    size_t written() const { return total; }
+
+private:
+    void separate();
+    void open(char c);
+    void close(char c);
+    void write(const char *data, size_t size);
+    void put(char c);
+    void string(const char *str);
+
+    char *buffer;
+    size_t size;
+    size_t used;
+    size_t total;
+    sink_t sink;
+    void *context;
+
+    // bit n set when the container at depth n already has an element
+    uint32_t nonEmpty;
+    uint8_t depth;
+    bool afterKey;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Registry of the metrics served at /metrics in the Prometheus text format.
+// Subsystems register a descriptor per metric at init with functions that
+// read the current values; the exposition is produced a line at a time with
+// metrics_line() while the response is sent, so a scrape never needs more
+// than a line of RAM however many series there are.
+//
+// Histograms count durations in log2 buckets of microseconds and are exposed
+// in seconds with a bucket every factor of 4.
+
+#define METRICS_MAX 32
+// bucket n counts durations of 2^(n-1) to 2^n - 1 microseconds
+#define METRICS_BUCKETS 25
+// longest line metrics_line() writes, longer ones are dropped
+#define METRICS_LINE_SIZE 128
+
+enum metric_type_t {
+    METRIC_GAUGE,
+    METRIC_COUNTER,
+    METRIC_HISTOGRAM,
+};
+
+struct metrics_histogram_t {
+    uint32_t count;
+    uint32_t max;
+    uint64_t sum;
+    // and a last one for 2^24 microseconds and up, only counted in +Inf
+    uint32_t buckets[METRICS_BUCKETS + 1];
+};
+
+// fields after help can be left out for a metric with a single series
+struct metric_t {
+    const char *name;
+    metric_type_t type;
+    const char *help;
+    // gauges and counters, NAN leaves the series out
+    double (*value)(uint8_t index);
+    const metrics_histogram_t *(*histogram)(uint8_t index);
+    // with a label, a series per index up to series
+    const char *label;
+    uint8_t series;
+    const char *(*label_value)(uint8_t index);
+};
+
+void metrics_observe(metrics_histogram_t *histogram, uint32_t us);
+
+// metric must stay valid, usually a static const
+void metrics_register(const metric_t *metric);
+
+// writes line index of the exposition, newline included, into line; false
+// past the last line. A line can come out empty: series without a value and
+// lines that don't fit are skipped.
+bool metrics_line(uint16_t index, char *line, size_t size);
@@ -7,4 +7,7 @@ extern PubSubClient mqtt;
 bool mqtt_is_configured();
 bool mqtt_init(const char* name);
 bool mqtt_connect();
+// after the broker settings changed: drop the connection, the next
+// mqtt_connect() uses the new broker
+void mqtt_reload();
 void mqtt_loop();
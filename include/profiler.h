@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "metrics.h"
+
+// Main loop profiler. loop() marks the end of each subsystem's share of the
+// iteration; the time is measured with the CPU cycle counter and counted in
+// log2 histograms per section, and the slowest iterations are kept together
+// with the section that took longest in them.
+//
+//     profiler_start();
+//     web_loop();
+//     profiler_mark(PROFILER_WEB);
+//     ...
+//     profiler_end();
+
+enum profiler_section_t {
+    // between loop() iterations: scheduled functions, WiFi and system tasks
+    PROFILER_SYSTEM,
+    PROFILER_WEB,
+    PROFILER_HOMEKIT,
+    PROFILER_SCHEDULER,
+    PROFILER_MQTT,
+    PROFILER_DEBUG,
+    // the whole loop() iteration
+    PROFILER_LOOP,
+    PROFILER_SECTIONS
+};
+
+#define PROFILER_BUCKETS METRICS_BUCKETS
+#define PROFILER_STALLS 4
+
+typedef metrics_histogram_t profiler_histogram_t;
+
+struct profiler_stall_t {
+    // millis() at the end of the iteration
+    uint32_t at;
+    uint32_t duration;
+    profiler_section_t cause;
+    uint32_t cause_duration;
+};
+
+void profiler_start();
+void profiler_mark(profiler_section_t section);
+void profiler_end();
+
+const char *profiler_section_name(profiler_section_t section);
+const profiler_histogram_t *profiler_histogram(profiler_section_t section);
+// upper bound of the bucket holding the given percentile, in microseconds
+uint32_t profiler_percentile(profiler_section_t section, uint8_t percentile);
+// slowest iterations, longest first; unused entries have a zero duration
+const profiler_stall_t *profiler_stalls();
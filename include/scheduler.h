@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <functional>
+
+// Cooperative scheduler for the periodic and deferred work that used to run
+// from scheduled Tickers. Tasks run from scheduler_loop() in loop(), highest
+// priority first, and a pass stops starting tasks once it has used
+// SCHEDULER_PASS_BUDGET so jobs falling due together are spread over several
+// loop() iterations instead of piling up in one.
+
+#define SCHEDULER_MAX_TASKS 10
+// time a single scheduler_loop() pass may spend before the remaining due
+// tasks wait for the next iteration
+#define SCHEDULER_PASS_BUDGET 10000
+// offset between the first runs of periodic tasks
+#define SCHEDULER_STAGGER_MS 250
+
+enum scheduler_priority_t {
+    // user initiated work, never deferred
+    SCHEDULER_PRIORITY_HIGH,
+    SCHEDULER_PRIORITY_NORMAL,
+    // housekeeping, deferred while HomeKit requests are being handled
+    SCHEDULER_PRIORITY_LOW,
+};
+
+struct scheduler_task_t {
+    const char *name;
+    std::function<void()> callback;
+    scheduler_priority_t priority;
+    // milliseconds between runs, 0 for a task run with scheduler_run_in()
+    uint32_t interval;
+    // expected run time in microseconds, longer runs count as overruns
+    uint32_t budget;
+
+    uint32_t next;
+    bool armed;
+    bool waiting;
+
+    uint32_t runs;
+    uint32_t overruns;
+    // runs delayed by the pass budget or deferral
+    uint32_t deferrals;
+    uint64_t total_us;
+    uint32_t max_us;
+    // longest time between becoming due and running, in milliseconds
+    uint32_t max_late;
+};
+
+// run callback every interval milliseconds
+scheduler_task_t *scheduler_every(const char *name, uint32_t interval, scheduler_priority_t priority,
+        uint32_t budget, std::function<void()> callback);
+// add a task that only runs after scheduler_run_in()
+scheduler_task_t *scheduler_once(const char *name, scheduler_priority_t priority,
+        uint32_t budget, std::function<void()> callback);
+// run a task once in delay milliseconds, replacing a pending run
+void scheduler_run_in(scheduler_task_t *task, uint32_t delay);
+
+// hold back low priority tasks for the next duration milliseconds
+void scheduler_defer(uint32_t duration);
+
+void scheduler_loop();
+
+uint8_t scheduler_task_count();
+const scheduler_task_t *scheduler_task(uint8_t index);
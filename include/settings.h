@@ -1,6 +1,8 @@
 #pragma once
 
+#include <ArduinoJson.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 struct Settings {
@@ -9,11 +11,81 @@ struct Settings {
     char mqtt_temp[80];
     char mqtt_humidity[80];
     char mqtt_dew_point[80];
+    char syslog_server[32];
+    uint16_t syslog_port;
     bool debug;
 };
 
 extern Settings settings;
 
+// Settings are stored as a binary image of Settings, read at boot without
+// parsing. There are two copies written in turn, each with a sequence
+// number and a CRC, so a torn or corrupted write falls back to the previous
+// one. /config.json is the JSON export: rewritten on every save for the web
+// UI, and imported when there is no valid image for this SETTINGS_VERSION.
+
+// bump when the layout of Settings changes
+#define SETTINGS_VERSION 2
+#define SETTINGS_SLOTS 2
+#define SETTINGS_FILE_0 "/settings.0"
+#define SETTINGS_FILE_1 "/settings.1"
+
 #define CONFIG_FILE "/config.json"
+#define JSON_CAPACITY 512
+
+// what has to happen for a changed setting to take effect; the MQTT topics
+// are read each time they are used and need nothing
+enum settings_change_t {
+    // reconnect with mqtt_reload()
+    SETTINGS_CHANGE_MQTT = 1 << 0,
+    // start or stop the stats and the syslog sink with debug_reload()
+    SETTINGS_CHANGE_DEBUG = 1 << 1,
+    SETTINGS_CHANGE_RESTART = 1 << 2,
+};
+
+enum setting_type_t {
+    SETTING_STRING,
+    SETTING_UINT16,
+    SETTING_BOOL,
+};
+
+// One entry of the settings schema: loading, exporting, validating and the
+// web form are all driven by the table in settings.cpp, a new setting is a
+// field in Settings and a line there.
+struct setting_t {
+    // in config.json, the web form and POST /_settings
+    const char *key;
+    setting_type_t type;
+    // of the value in Settings
+    uint16_t offset;
+    uint16_t size;
+    // numbers only, the value when missing or out of bounds
+    uint16_t min;
+    uint16_t max;
+    uint16_t fallback;
+    // settings_change_t flags when the value changes
+    uint8_t change;
+    // web form: the label starts a new group, settings without a
+    // placeholder are not shown; an entry goes out in one HTTP_STEP_SIZE
+    // step, so the texts stay short
+    const char *label;
+    const char *placeholder;
+    const char *caption;
+};
+
+extern const setting_t settings_schema[];
+extern const uint8_t settings_schema_count;
 
 extern void settings_init();
+
+// copy the values in a settings document into settings, returns the
+// settings_change_t flags for the values that changed
+extern uint8_t settings_load(const JsonDocument &doc);
+// settings as a document in the format settings_load() reads
+extern void settings_export(JsonDocument &doc);
+// write settings to the older image and the JSON export
+extern bool settings_save();
+// set or, when value is empty, remove a key in a settings document; false
+// without changing it if the key is not in the schema or the value is not
+// valid for it
+extern bool settings_update(JsonDocument &doc, char *key, char *value);
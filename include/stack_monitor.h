@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>
+
+// High-water marks for the 4KB cont stack that setup(), loop() and
+// everything called from them run on. The core paints the stack at boot
+// and ESP.getFreeContStack() counts the painted words that were never
+// overwritten. A StackProbe repaints on entry and reads the count on exit,
+// so each entry point records the deepest it got; probes can nest, the
+// outer ones see the depth reached by the inner ones.
+//
+// A repaint and a count take ~20us, so probes go on handlers and callbacks
+// rather than on every loop() iteration; stack_min_free() covers the rest.
+
+enum stack_entry_t {
+    STACK_SETUP,
+    STACK_WEB_INDEX,
+    STACK_WEB_GET_SETTINGS,
+    STACK_WEB_POST_SETTINGS,
+    STACK_WEB_STATUS,
+    STACK_WEB_TASKS,
+    STACK_WEB_HEAP,
+    STACK_WEB_STACK,
+    STACK_WEB_EVENTS,
+    STACK_WEB_EVENTS_PUSH,
+    STACK_WEB_METRICS,
+    STACK_HK_TARGET_STATE,
+    STACK_HK_TARGET_TEMPERATURE,
+    STACK_HK_DEHUMIDIFIER_ACTIVE,
+    STACK_HK_HORIZONTAL_SWING,
+    STACK_HK_FAN_ACTIVE,
+    STACK_HK_FAN_SPEED,
+    STACK_HK_FAN_AUTO,
+    STACK_HK_VERTICAL_SWING,
+    STACK_HP_SYNC,
+    STACK_HP_UPDATE,
+    STACK_HP_SETTINGS_CHANGED,
+    STACK_HP_STATUS_CHANGED,
+    STACK_ENTRIES
+};
+
+struct stack_entry_stats_t {
+    uint32_t calls;
+    // fewest bytes left untouched below the deepest frame, valid if calls > 0
+    uint32_t min_free;
+};
+
+class StackProbe {
+public:
+    explicit StackProbe(stack_entry_t entry);
+    ~StackProbe();
+
+    StackProbe(const StackProbe &) = delete;
+    StackProbe &operator=(const StackProbe &) = delete;
+
+private:
+    void observe(uint32_t free);
+
+    static StackProbe *active;
+
+    stack_entry_t entry;
+    uint32_t minFree;
+    StackProbe *outer;
+};
+
+const char *stack_entry_name(stack_entry_t entry);
+const stack_entry_stats_t *stack_entry_stats(stack_entry_t entry);
+// fewest free bytes seen since boot, across all entry points
+uint32_t stack_min_free();
@@ -0,0 +1,128 @@
+#include "logline.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "logrecord.h"
+
+void uptimeString(char* str, size_t size, long val) {
+    int days = val / 86400;
+    int hours = val % 86400 / 3600;
+    int minutes = val % 3600 / 60;
+    int seconds = val % 60;
+
+    if (days > 0) {
+        snprintf(str, size, "%dd %dh %dm %ds", days, hours, minutes, seconds);
+    } else if (hours > 0) {
+        snprintf(str, size, "%dh %dm %ds", hours, minutes, seconds);
+    } else if (minutes > 0) {
+        snprintf(str, size, "%dm %ds", minutes, seconds);
+    } else {
+        snprintf(str, size, "%ds", seconds);
+    }
+}
+
+void utcTimeToStr(char* str, size_t size, time_t time) {
+  struct tm tm;
+  gmtime_r(&time, &tm);
+  snprintf(str, size, "%04d-%02d-%02d %02d:%02d:%02d",
+      tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec);
+}
+
+size_t logLine(char *str, size_t size, const LogLineFormat &format, const LogHeader &header, const char *data, size_t length) {
+  if (size == 0)
+    return 0;
+
+  // time
+  size_t out = 0;
+  switch (format.timeFormat) {
+    case ltStrTime:
+      uptimeString(str, size, header.logTime / 1000);
+      break;
+    case ltMsTime:
+      snprintf(str, size, "%d", header.logTime);
+      break;
+    case ltMsBetween:
+      snprintf(str, size, "%d", header.logTime - format.lastTime);
+      break;
+    case ltUTCTime:
+      utcTimeToStr(str, size, format.bootTime + header.logTime / 1000);
+      break;
+    case ltNone:
+    case ltLast:
+      str[0] = 0x00;
+      break;
+  }
+  out = strlen(str);
+  if (out && out < size - 1)
+    str[out++] = ' ';
+
+  // level
+  if (format.showLevel) {
+    const char *level;
+    switch (header.logLevel) {
+      case llDebug:    level = "DEBUG: "; break;
+      case llInfo:     level = "INFO: "; break;
+      case llWarning:  level = "WARNING: "; break;
+      case llError:    level = "ERROR: "; break;
+      default:         level = "UNKNOWN: "; break;
+    }
+    size_t n = strlen(level);
+    if (n > size - 1 - out)
+      n = size - 1 - out;
+    memcpy(&str[out], level, n);
+    out += n;
+  }
+
+  // text
+  if (header.logFlags & LOG_FLAG_BINARY) {
+    out += logFormat(&str[out], size - out, (const uint8_t *)data, length);
+  } else {
+    if (length > size - 1 - out)
+      length = size - 1 - out;
+    memcpy(&str[out], data, length);
+    out += length;
+  }
+  str[out] = 0x00;
+  return out;
+}
+
+size_t logSyslog(char *str, size_t size, const LogLineFormat &format, const LogHeader &header,
+    const char *host, const char *app, const char *text, size_t length) {
+  if (size == 0)
+    return 0;
+
+  // facility user
+  uint8_t severity;
+  switch (header.logLevel) {
+    case llError:    severity = 3; break;
+    case llWarning:  severity = 4; break;
+    case llDebug:    severity = 7; break;
+    default:         severity = 6; break;
+  }
+
+  int out;
+  if (format.bootTime) {
+    struct tm tm;
+    time_t time = format.bootTime + header.logTime / 1000;
+    gmtime_r(&time, &tm);
+    out = snprintf(str, size, "<%d>1 %04d-%02d-%02dT%02d:%02d:%02d.%03dZ %s %s - - - ",
+        8 + severity, tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec,
+        header.logTime % 1000, host, app);
+  } else {
+    out = snprintf(str, size, "<%d>1 - %s %s - - - ", 8 + severity, host, app);
+  }
+  if (out < 0)
+    out = 0;
+  if ((size_t)out >= size)
+    return size - 1;
+
+  while (length && (text[length - 1] == '\n' || text[length - 1] == '\r'))
+    length--;
+  if (length > size - 1 - out)
+    length = size - 1 - out;
+  memcpy(&str[out], text, length);
+  out += length;
+  str[out] = 0x00;
+  return out;
+}
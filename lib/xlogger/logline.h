@@ -0,0 +1,57 @@
+/*
+ * xLogger library
+ *
+ * Shown form of a log line: time and level prefix followed by the text, a
+ * packed record being formatted on the way. Everything is written into the
+ * caller's buffer, nothing is allocated, so lines can go out to the sinks
+ * without touching the heap.
+ *
+ * No Arduino dependencies, so it can be built and checked on a host.
+ */
+
+#ifndef __LOGLINE_H__
+#define __LOGLINE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "logring.h"
+
+#define LOG_LINE_LENGTH      300                 // a shown line: time and level, then up to 256 bytes of text
+
+enum LogTimeFormat: uint8_t {
+  ltNone,
+  ltStrTime,
+  ltMsTime,
+  ltMsBetween,
+  ltUTCTime,
+
+  ltLast
+};
+
+struct LogLineFormat {
+  LogTimeFormat timeFormat = ltStrTime;
+  bool showLevel = true;
+  // seconds, for ltUTCTime
+  time_t bootTime = 0;
+  // time of the previous line, for ltMsBetween; the logger moves it on
+  // once the line went to every sink
+  int lastTime = 0;
+};
+
+// time conversion
+void uptimeString(char* str, size_t size, long val);
+void utcTimeToStr(char* str, size_t size, time_t time);
+
+// writes the line read from the log ring (length bytes of data) as shown,
+// null-terminated and cut to size; returns the length written
+size_t logLine(char *str, size_t size, const LogLineFormat &format, const LogHeader &header, const char *data, size_t length);
+
+// writes a text line as an RFC 5424 syslog message from host: the severity
+// follows the level, the time is left out while the clock isn't set
+// (bootTime 0) and so is the line ending; returns the length written
+size_t logSyslog(char *str, size_t size, const LogLineFormat &format, const LogHeader &header,
+    const char *host, const char *app, const char *text, size_t length);
+
+#endif // ifndef __LOGLINE_H__
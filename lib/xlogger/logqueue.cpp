@@ -0,0 +1,55 @@
+#include "logqueue.h"
+
+#include <string.h>
+
+// at most two copies, split where the buffer wraps
+void LogQueue::copyIn(uint16_t pos, const void *data, uint16_t length) {
+  uint16_t first = length < size - pos ? length : size - pos;
+  memcpy(&buffer[pos], data, first);
+  memcpy(&buffer[0], (const uint8_t *)data + first, length - first);
+}
+
+void LogQueue::copyOut(uint16_t pos, void *data, uint16_t length) const {
+  uint16_t first = length < size - pos ? length : size - pos;
+  memcpy(data, &buffer[pos], first);
+  memcpy((uint8_t *)data + first, &buffer[0], length - first);
+}
+
+bool LogQueue::push(const char *data, uint16_t length) {
+  if (length == 0 || !data || sizeof(length) + length > (size_t)(size - bytes))
+    return false;
+
+  uint16_t tail = (head + bytes) % size;
+  copyIn(tail, &length, sizeof(length));
+  copyIn((tail + sizeof(length)) % size, data, length);
+  bytes += sizeof(length) + length;
+  queued++;
+  return true;
+}
+
+uint16_t LogQueue::peek(char *data, uint16_t length) const {
+  if (queued == 0)
+    return 0;
+
+  uint16_t lineLength;
+  copyOut(head, &lineLength, sizeof(lineLength));
+  copyOut((head + sizeof(lineLength)) % size, data, lineLength < length ? lineLength : length);
+  return lineLength < length ? lineLength : length;
+}
+
+void LogQueue::pop() {
+  if (queued == 0)
+    return;
+
+  uint16_t lineLength;
+  copyOut(head, &lineLength, sizeof(lineLength));
+  head = (head + sizeof(lineLength) + lineLength) % size;
+  bytes -= sizeof(lineLength) + lineLength;
+  queued--;
+}
+
+void LogQueue::clear() {
+  head = 0;
+  bytes = 0;
+  queued = 0;
+}
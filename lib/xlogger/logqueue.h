@@ -0,0 +1,44 @@
+/*
+ * xLogger library
+ *
+ * Bounded queue of lines waiting for a sink, in a circular buffer the sink
+ * provides. A line goes in whole or not at all, so a full queue drops the
+ * newest line instead of blocking the caller; the sink counts those.
+ *
+ * No Arduino dependencies, so it can be built and checked on a host.
+ */
+
+#ifndef __LOGQUEUE_H__
+#define __LOGQUEUE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+class LogQueue {
+public:
+  LogQueue(uint8_t *_buffer, uint16_t _size): buffer(_buffer), size(_size) {}
+
+  // false if there is no room for the line, nothing is queued then
+  bool push(const char *data, uint16_t length);
+  // copies the oldest line (cut to size) and returns its length, 0 if the
+  // queue is empty
+  uint16_t peek(char *data, uint16_t length) const;
+  void pop();
+  void clear();
+
+  uint16_t count() const { return queued; }
+  uint16_t used() const { return bytes; }
+
+private:
+  uint8_t *buffer;
+  uint16_t size;
+  // offset of the oldest line's length
+  uint16_t head = 0;
+  uint16_t bytes = 0;
+  uint16_t queued = 0;
+
+  void copyIn(uint16_t pos, const void *data, uint16_t length);
+  void copyOut(uint16_t pos, void *data, uint16_t length) const;
+};
+
+#endif // ifndef __LOGQUEUE_H__
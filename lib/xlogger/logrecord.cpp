@@ -0,0 +1,163 @@
+#include "logrecord.h"
+
+#include <stdio.h>
+
+#ifdef ARDUINO
+#include <pgmspace.h>
+#else
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#endif
+
+namespace {
+
+// walks the arguments of a record
+class LogReader {
+public:
+  LogReader(const uint8_t *_record, uint16_t _length): record(_record), length(_length) {}
+
+  bool get(void *data, size_t size) {
+    if (pos + size > length)
+      return false;
+    memcpy(data, &record[pos], size);
+    pos += size;
+    return true;
+  }
+
+  // next argument, false if there is none
+  bool next(uint8_t &type, uint64_t &value, float &f, const char *&str) {
+    if (!get(&type, 1))
+      return false;
+    if (type == LOG_ARG_STRING) {
+      str = (const char *)&record[pos];
+      size_t size = strnlen(str, length - pos);
+      if (pos + size >= length)
+        return false;
+      pos += size + 1;
+      return true;
+    }
+    if (type == LOG_ARG_FLOAT)
+      return get(&f, sizeof(f));
+    uint8_t size = type & 0x0f;
+    if (size != 1 && size != 2 && size != 4 && size != 8)
+      return false;
+    value = 0;
+    if (!get(&value, size))
+      return false;
+    // sign extend
+    if (!(type & LOG_ARG_UNSIGNED) && size < 8 && (value >> (size * 8 - 1)) & 1)
+      value |= ~0ULL << (size * 8);
+    return true;
+  }
+
+private:
+  const uint8_t *record;
+  uint16_t length;
+  uint16_t pos = 0;
+};
+
+}
+
+size_t logFormat(char *str, size_t size, const uint8_t *record, uint16_t length) {
+  if (size == 0)
+    return 0;
+
+  size_t out = 0;
+  auto append = [&](int written) {
+    if (written > 0)
+      out += (size_t)written < size - out ? written : size - out - 1;
+  };
+
+  const char *fmtstr;
+  LogReader reader(record, length);
+  if (!reader.get(&fmtstr, sizeof(fmtstr))) {
+    str[0] = 0x00;
+    return 0;
+  }
+
+  uint8_t type;
+  uint64_t value;
+  float f;
+  const char *s;
+  for (const char *p = fmtstr; out < size - 1; p++) {
+    char c = pgm_read_byte(p);
+    if (c == 0x00)
+      break;
+    if (c != '%') {
+      str[out++] = c;
+      continue;
+    }
+
+    // one conversion: flags, width and precision are kept, the length
+    // modifier is replaced by the one matching the stored value
+    char spec[16] = "%";
+    size_t specLen = 1;
+    for (c = pgm_read_byte(++p); c && strchr("-+ #0123456789.*hlLqjzt", c); c = pgm_read_byte(++p)) {
+      if (c == '*') {
+        if (!reader.next(type, value, f, s) || type & (LOG_ARG_FLOAT | LOG_ARG_STRING))
+          value = 0;
+        // a width can't usefully be more than a line
+        int width = (int64_t)value < -LOG_RECORD_SIZE ? -LOG_RECORD_SIZE : (int64_t)value > LOG_RECORD_SIZE ? LOG_RECORD_SIZE : (int)value;
+        specLen += snprintf(&spec[specLen], sizeof(spec) - specLen, "%d", width);
+      } else if (!strchr("hlLqjzt", c)) {
+        spec[specLen++] = c;
+      }
+      if (specLen >= sizeof(spec) - 4)
+        break;
+    }
+    if (c == 0x00)
+      break;
+    if (c == '%') {
+      str[out++] = '%';
+      continue;
+    }
+
+    if (!reader.next(type, value, f, s)) {
+      append(snprintf(&str[out], size - out, "?"));
+      continue;
+    }
+    bool isString = type == LOG_ARG_STRING;
+    bool isFloat = type == LOG_ARG_FLOAT;
+    bool wide = (type & 0x0f) == 8;
+    if (c == 's') {
+      spec[specLen++] = 's';
+      spec[specLen] = 0x00;
+      append(snprintf(&str[out], size - out, spec, isString ? s : "?"));
+    } else if (strchr("fFeEgGaA", c)) {
+      spec[specLen++] = c;
+      spec[specLen] = 0x00;
+      double d = isFloat ? f : isString ? 0.0 : (type & LOG_ARG_UNSIGNED) ? (double)value : (double)(int64_t)value;
+      append(snprintf(&str[out], size - out, spec, d));
+    } else if (strchr("diouxXcp", c) && !isString && !isFloat) {
+      // 32-bit values go through %l so a printf without %ll support
+      // still handles them, only 64-bit ones need it
+      if (c == 'p') {
+        spec[specLen++] = 'p';
+        spec[specLen] = 0x00;
+        append(snprintf(&str[out], size - out, spec, (void *)(uintptr_t)value));
+      } else if (c == 'c') {
+        spec[specLen++] = 'c';
+        spec[specLen] = 0x00;
+        append(snprintf(&str[out], size - out, spec, (int)value));
+      } else {
+        if (wide)
+          spec[specLen++] = 'l';
+        spec[specLen++] = 'l';
+        spec[specLen++] = c;
+        spec[specLen] = 0x00;
+        bool isSigned = c == 'd' || c == 'i';
+        if (wide && isSigned)
+          append(snprintf(&str[out], size - out, spec, (long long)value));
+        else if (wide)
+          append(snprintf(&str[out], size - out, spec, (unsigned long long)value));
+        else if (isSigned)
+          append(snprintf(&str[out], size - out, spec, (long)(int32_t)value));
+        else
+          append(snprintf(&str[out], size - out, spec, (unsigned long)(uint32_t)value));
+      }
+    } else {
+      append(snprintf(&str[out], size - out, "?"));
+    }
+  }
+  str[out] = 0x00;
+  return out;
+}
@@ -0,0 +1,130 @@
+/*
+ * xLogger library
+ *
+ * Binary log records: the address of the format string (a PROGMEM literal
+ * that stays valid) and the arguments' raw bytes, each behind a type tag.
+ * Packing is a few stores per argument; the printf work is only done by
+ * logFormat() when someone reads the line. Integers take the fewest bytes
+ * that hold their value, floating point values are kept as float, strings
+ * are copied (they are often temporaries) and cut to LOG_ARG_STRING_MAX.
+ *
+ * No Arduino dependencies, so it can be built and benchmarked on a host.
+ */
+
+#ifndef __LOGRECORD_H__
+#define __LOGRECORD_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <type_traits>
+
+#define LOG_RECORD_SIZE      128                 // largest packed record
+#define LOG_ARG_STRING_MAX   48                  // longest string argument kept, terminator included
+
+// argument tag: the size in bytes of an integer in the low bits, or one of
+#define LOG_ARG_UNSIGNED     0x10
+#define LOG_ARG_FLOAT        0x20
+#define LOG_ARG_STRING       0x40
+
+class LogPacker {
+public:
+  LogPacker(uint8_t *_buffer, size_t _size): buffer(_buffer), size(_size) {}
+
+  void format(const char *fmtstr) {
+    put(&fmtstr, sizeof(fmtstr));
+  }
+
+  void arg(const char *str) {
+    if (!str)
+      str = "(null)";
+    size_t length = 0;
+    while (length < LOG_ARG_STRING_MAX - 1 && str[length])
+      length++;
+    if (used + 2 + length > size) {
+      overflow = true;
+      return;
+    }
+    buffer[used++] = LOG_ARG_STRING;
+    memcpy(&buffer[used], str, length);
+    used += length;
+    buffer[used++] = 0x00;
+  }
+  void arg(char *str) {
+    arg((const char *)str);
+  }
+
+  void arg(double value) {
+    float f = value;
+    tag(LOG_ARG_FLOAT, &f, sizeof(f));
+  }
+  void arg(float value) {
+    arg((double)value);
+  }
+
+  template<typename T>
+  typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type arg(T value) {
+    int64_t v = value;
+    uint8_t width = v == (int8_t)v ? 1 : v == (int16_t)v ? 2 : v == (int32_t)v ? 4 : 8;
+    integer(width, v);
+  }
+  template<typename T>
+  typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type arg(T value) {
+    uint64_t v = value;
+    uint8_t width = v <= 0xff ? 1 : v <= 0xffff ? 2 : v <= 0xffffffff ? 4 : 8;
+    integer(width | LOG_ARG_UNSIGNED, v);
+  }
+  template<typename T>
+  typename std::enable_if<std::is_enum<T>::value>::type arg(T value) {
+    arg((typename std::underlying_type<T>::type)value);
+  }
+  // %p
+  void arg(const void *ptr) {
+    arg((uintptr_t)ptr);
+  }
+
+  // bytes used, 0 if the format or an argument didn't fit
+  uint16_t length() const {
+    return overflow ? 0 : used;
+  }
+
+private:
+  uint8_t *buffer;
+  size_t size;
+  size_t used = 0;
+  bool overflow = false;
+
+  void put(const void *data, size_t length) {
+    if (used + length > size) {
+      overflow = true;
+      return;
+    }
+    memcpy(&buffer[used], data, length);
+    used += length;
+  }
+  void tag(uint8_t type, const void *data, size_t length) {
+    put(&type, 1);
+    put(data, length);
+  }
+  // little endian, the low bytes are the value
+  void integer(uint8_t type, uint64_t value) {
+    tag(type, &value, type & 0x0f);
+  }
+};
+
+// packs a log line into buffer, returns its length or 0 if it doesn't fit
+template<typename... Args>
+uint16_t logPack(uint8_t *buffer, size_t size, const char *fmtstr, Args... args) {
+  LogPacker packer(buffer, size);
+  packer.format(fmtstr);
+  int unused[] = {0, (packer.arg(args), 0)...};
+  (void)unused;
+  return packer.length();
+}
+
+// formats a packed record like snprintf() would have, returns the length
+// written to str (null-terminated, cut to size)
+size_t logFormat(char *str, size_t size, const uint8_t *record, uint16_t length);
+
+#endif // ifndef __LOGRECORD_H__
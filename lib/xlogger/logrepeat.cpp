@@ -0,0 +1,27 @@
+#include "logrepeat.h"
+
+bool LogRepeat::repeated(const LogHeader &header, const char *data, const LogRing &ring) {
+  if (!window || !kept || (uint32_t)(header.logTime - keptTime) >= window)
+    return false;
+  if (!ring.isNewest(header, data))
+    return false;
+
+  if (repeats < UINT16_MAX)
+    repeats++;
+  repeatTime = header.logTime;
+  return true;
+}
+
+void LogRepeat::keep(const LogHeader &header) {
+  kept = true;
+  keptTime = header.logTime;
+  keptLevel = header.logLevel;
+}
+
+uint16_t LogRepeat::take(LogHeader &header) {
+  uint16_t count = repeats;
+  repeats = 0;
+  header.logLevel = keptLevel;
+  header.logTime = repeatTime;
+  return count;
+}
@@ -0,0 +1,48 @@
+/*
+ * xLogger library
+ *
+ * Repeated lines: a line identical to the last one kept (same level, same
+ * text or packed record, compared byte for byte with the newest line in the
+ * ring) that comes within the window after it is only counted. The count
+ * is reported as a single line once a different line comes or the window is
+ * over, like syslogd's "last message repeated".
+ *
+ * No Arduino dependencies, so it can be built and checked on a host.
+ */
+
+#ifndef __LOGREPEAT_H__
+#define __LOGREPEAT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "logring.h"
+
+#define LOG_REPEAT_WINDOW    30000               // milliseconds a line's repeats are counted for
+
+class LogRepeat {
+public:
+  // 0 keeps every line
+  void setWindow(uint32_t _window) { window = _window; }
+
+  // true for a repeat of the last line kept, which must still be the newest
+  // line in ring; it is counted instead
+  bool repeated(const LogHeader &header, const char *data, const LogRing &ring);
+  // the line is kept, repeats are counted against it from now on
+  void keep(const LogHeader &header);
+  // whether there are repeats to report because the window is over
+  bool due(uint32_t now) const { return repeats && now - (uint32_t)keptTime >= window; }
+  // the repeats not reported yet, with the level and time of the last one
+  // in header; the count starts again from 0
+  uint16_t take(LogHeader &header);
+
+private:
+  uint32_t window = LOG_REPEAT_WINDOW;
+  int keptTime = 0;
+  LogLevel keptLevel = llNone;
+  bool kept = false;
+  uint16_t repeats = 0;
+  int repeatTime = 0;
+};
+
+#endif // ifndef __LOGREPEAT_H__
@@ -0,0 +1,96 @@
+#include "logring.h"
+
+#include <string.h>
+
+// at most two copies, split where the buffer wraps
+void LogRing::copyIn(uint16_t pos, const void *data, uint16_t size) {
+  uint16_t first = size < LOG_SIZE - pos ? size : LOG_SIZE - pos;
+  memcpy(&logMem[pos], data, first);
+  memcpy(&logMem[0], (const uint8_t *)data + first, size - first);
+}
+
+void LogRing::copyOut(uint16_t pos, void *data, uint16_t size) const {
+  uint16_t first = size < LOG_SIZE - pos ? size : LOG_SIZE - pos;
+  memcpy(data, &logMem[pos], first);
+  memcpy((uint8_t *)data + first, &logMem[0], size - first);
+}
+
+void LogRing::add(const LogHeader &header, const char *data) {
+  if (header.logSize == 0 || !data)
+    return;
+
+  LogHeader stored = header;
+  if (stored.logSize > LOG_SIZE - sizeof(LogHeader))
+    stored.logSize = LOG_SIZE - sizeof(LogHeader);
+  uint16_t size = sizeof(LogHeader) + stored.logSize;
+
+  // evict the oldest records until it fits
+  while (LOG_SIZE - logUsed < size) {
+    LogHeader oldest;
+    copyOut(logHead, &oldest, sizeof(LogHeader));
+    uint16_t oldestSize = sizeof(LogHeader) + oldest.logSize;
+    logHead = (logHead + oldestSize) % LOG_SIZE;
+    logUsed -= oldestSize;
+    logCount--;
+  }
+
+  uint16_t tail = (logHead + logUsed) % LOG_SIZE;
+  logNewest = tail;
+  copyIn(tail, &stored, sizeof(LogHeader));
+  copyIn((tail + sizeof(LogHeader)) % LOG_SIZE, data, stored.logSize);
+  logUsed += size;
+  logCount++;
+  logAdded++;
+}
+
+void LogRing::clear() {
+  logHead = 0;
+  logUsed = 0;
+  logCount = 0;
+}
+
+// compared in place, in at most two parts split where the buffer wraps
+bool LogRing::isNewest(const LogHeader &header, const char *data) const {
+  if (logCount == 0)
+    return false;
+
+  LogHeader newest;
+  copyOut(logNewest, &newest, sizeof(LogHeader));
+  if (newest.logSize != header.logSize || newest.logLevel != header.logLevel || newest.logFlags != header.logFlags)
+    return false;
+  uint16_t pos = (logNewest + sizeof(LogHeader)) % LOG_SIZE;
+  uint16_t first = newest.logSize < LOG_SIZE - pos ? newest.logSize : LOG_SIZE - pos;
+  return memcmp(&logMem[pos], data, first) == 0 &&
+      memcmp(&logMem[0], data + first, newest.logSize - first) == 0;
+}
+
+bool LogRing::read(uint16_t &offset, LogHeader &header, char *data, size_t size) const {
+  if (offset >= logUsed || size == 0)
+    return false;
+
+  uint16_t pos = (logHead + offset) % LOG_SIZE;
+  copyOut(pos, &header, sizeof(LogHeader));
+  uint16_t length = header.logSize < size - 1 ? header.logSize : size - 1;
+  copyOut((pos + sizeof(LogHeader)) % LOG_SIZE, data, length);
+  data[length] = 0x00;
+
+  offset += sizeof(LogHeader) + header.logSize;
+  return true;
+}
+
+bool LogRing::readNumber(uint32_t &seq, LogHeader &header, char *data, size_t size) const {
+  if (seq < first())
+    seq = first();
+  if (seq >= logAdded)
+    return false;
+
+  // walk the headers from the oldest
+  uint16_t offset = 0;
+  for (uint32_t n = first(); n < seq; n++) {
+    LogHeader skipped;
+    copyOut((logHead + offset) % LOG_SIZE, &skipped, sizeof(LogHeader));
+    offset += sizeof(LogHeader) + skipped.logSize;
+  }
+  seq++;
+  return read(offset, header, data, size);
+}
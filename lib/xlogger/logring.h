@@ -0,0 +1,76 @@
+/*
+ * xLogger library
+ *
+ * Memory buffer for the last log lines: a circular buffer of records (header
+ * followed by the line), where a record may wrap around the end. Adding a
+ * line evicts the oldest whole records until it fits, so both are constant
+ * time per record instead of a scan and a memmove of the whole buffer.
+ *
+ * No Arduino dependencies, so it can be built and benchmarked on a host.
+ */
+
+#ifndef __LOGRING_H__
+#define __LOGRING_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define LOG_SIZE             2048                // size of log memory buffer in bytes
+
+enum LogLevel: uint8_t{
+  llNone,
+  llDebug,
+  llInfo,
+  llWarning,
+  llError,
+
+  llLast
+};
+
+#define LOG_FLAG_BINARY      0x01                // the line is a packed record, see logrecord.h
+
+struct LogHeader {
+  int logTime = 0;
+  uint16_t logSize = 0;
+  LogLevel logLevel = llInfo;
+  uint8_t logFlags = 0;
+};
+
+class LogRing {
+public:
+  // adds a line of header.logSize bytes, evicting the oldest ones to make
+  // room; a line that can't fit in the buffer is cut
+  void add(const LogHeader &header, const char *data);
+  void clear();
+  // whether the newest line has the same level, flags and bytes
+  bool isNewest(const LogHeader &header, const char *data) const;
+
+  // reads the record at offset bytes from the oldest one into header and
+  // data (null-terminated, cut to size) and moves offset to the next one;
+  // false past the newest. Start from 0.
+  bool read(uint16_t &offset, LogHeader &header, char *data, size_t size) const;
+  // the same by the record's number, which stays valid while lines are
+  // added; a number that was evicted reads the oldest line. Moves seq past
+  // the record read.
+  bool readNumber(uint32_t &seq, LogHeader &header, char *data, size_t size) const;
+
+  uint16_t used() const { return logUsed; }
+  uint16_t count() const { return logCount; }
+  // number of the oldest record, numbers count lines since the start
+  uint32_t first() const { return logAdded - logCount; }
+
+private:
+  uint8_t logMem[LOG_SIZE];
+  // offset of the oldest record
+  uint16_t logHead = 0;
+  // offset of the newest record
+  uint16_t logNewest = 0;
+  uint16_t logUsed = 0;
+  uint16_t logCount = 0;
+  uint32_t logAdded = 0;
+
+  void copyIn(uint16_t pos, const void *data, uint16_t size);
+  void copyOut(uint16_t pos, void *data, uint16_t size) const;
+};
+
+#endif // ifndef __LOGRING_H__
@@ -0,0 +1,82 @@
+#include "logsink.h"
+
+// a line as a sink sends it
+static char sinkLine[LOG_LINE_LENGTH];
+
+void LogStreamSink::write(const LogLineFormat &format, const LogHeader &header, const char *text, size_t length) {
+  size_t size = logLine(sinkLine, sizeof(sinkLine), format, header, text, length);
+  stream->write((const uint8_t *)sinkLine, size);
+}
+
+void LogClientSink::clear() {
+  queue.clear();
+  sent = 0;
+}
+
+void LogClientSink::write(const LogLineFormat &format, const LogHeader &header, const char *text, size_t length) {
+  size_t size = logLine(sinkLine, sizeof(sinkLine), format, header, text, length);
+  if (!queue.push(sinkLine, size))
+    dropped++;
+  handle();
+}
+
+void LogClientSink::handle() {
+  if (!enabled)
+    return;
+
+  while (queue.count()) {
+    size_t room = client.availableForWrite();
+    if (!room)
+      break;
+    uint16_t size = queue.peek(sinkLine, sizeof(sinkLine));
+    sent += client.write((const uint8_t *)&sinkLine[sent], min(room, (size_t)(size - sent)));
+    if (sent < size)
+      break;
+    queue.pop();
+    sent = 0;
+  }
+}
+
+void LogSyslogSink::begin(const char *_server, uint16_t _port, const char *_host, const char *_app) {
+  server = _server;
+  port = _port;
+  host = _host;
+  app = _app;
+  resolved = false;
+  resolveTried = false;
+  queue.clear();
+}
+
+void LogSyslogSink::write(const LogLineFormat &format, const LogHeader &header, const char *text, size_t length) {
+  size_t size = logSyslog(sinkLine, sizeof(sinkLine), format, header, host, app, text, length);
+  if (!queue.push(sinkLine, size))
+    dropped++;
+}
+
+void LogSyslogSink::handle() {
+  if (!active() || !queue.count() || !WiFi.isConnected())
+    return;
+
+  // a name is looked up again a while after it failed, as that blocks
+  if (!resolved) {
+    if (resolveTried && millis() - lastResolve < SYSLOG_RESOLVE_INTERVAL)
+      return;
+    resolveTried = true;
+    lastResolve = millis();
+    resolved = address.fromString(server) || WiFi.hostByName(server, address);
+    if (!resolved)
+      return;
+  }
+
+  for (uint8_t i = 0; i < SYSLOG_SENDS && queue.count(); i++) {
+    uint16_t size = queue.peek(sinkLine, sizeof(sinkLine));
+    queue.pop();
+    if (!udp.beginPacket(address, port)) {
+      dropped++;
+      continue;
+    }
+    udp.write((const uint8_t *)sinkLine, size);
+    if (!udp.endPacket())
+      dropped++;
+  }
+}
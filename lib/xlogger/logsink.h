@@ -0,0 +1,112 @@
+/*
+ * xLogger library
+ *
+ * Destinations for log lines. The logger formats a line's text once and
+ * hands it to every active sink, which shows it its own way. Sinks on the
+ * network queue lines in a bounded LogQueue and send them from handle()
+ * only as far as the connection takes them without blocking; a line that
+ * doesn't fit in the queue is dropped and counted.
+ */
+
+#ifndef __LOGSINK_H__
+#define __LOGSINK_H__
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>     // https://github.com/esp8266/Arduino
+#include <WiFiUdp.h>
+
+#include "logline.h"
+#include "logqueue.h"
+
+#define TELNET_QUEUE_SIZE    768                 // lines waiting for the telnet client, in bytes
+#define SYSLOG_QUEUE_SIZE    512                 // lines waiting to be sent to syslog, in bytes
+#define SYSLOG_PORT          514
+#define SYSLOG_SENDS         4                   // datagrams sent per handle()
+#define SYSLOG_RESOLVE_INTERVAL 60000            // milliseconds between attempts to resolve the server
+
+class LogSink {
+public:
+  explicit LogSink(const char *_name): name(_name) {}
+  virtual ~LogSink() {}
+
+  // whether lines should be formatted and written to it now
+  virtual bool active() = 0;
+  // a line's text, already formatted, with its header; format is how the
+  // logger shows lines
+  virtual void write(const LogLineFormat &format, const LogHeader &header, const char *text, size_t length) = 0;
+  // sends queued lines without blocking
+  virtual void handle() {}
+
+  const char *name;
+  // lines lost because the sink had no room for them
+  uint32_t dropped = 0;
+};
+
+// serial port, written directly: the UART drains at a fixed rate and is
+// only used until the heat pump takes it
+class LogStreamSink: public LogSink {
+public:
+  LogStreamSink(): LogSink("serial") {}
+
+  void setStream(Stream *_stream) { stream = _stream; }
+  void enable(bool _enabled) { enabled = _enabled; }
+
+  bool active() override { return enabled && stream; }
+  void write(const LogLineFormat &format, const LogHeader &header, const char *text, size_t length) override;
+
+private:
+  Stream *stream = NULL;
+  bool enabled = false;
+};
+
+// a TCP client, written as far as its send buffer has room
+class LogClientSink: public LogSink {
+public:
+  explicit LogClientSink(WiFiClient &_client): LogSink("telnet"), client(_client) {}
+
+  void enable(bool _enabled) { enabled = _enabled; }
+  // a new connection: what was queued for the last one is dropped
+  void clear();
+
+  bool active() override { return enabled; }
+  void write(const LogLineFormat &format, const LogHeader &header, const char *text, size_t length) override;
+  void handle() override;
+
+private:
+  WiFiClient &client;
+  bool enabled = false;
+  uint8_t queueBuffer[TELNET_QUEUE_SIZE];
+  LogQueue queue = LogQueue(queueBuffer, sizeof(queueBuffer));
+  // bytes of the oldest queued line already sent
+  uint16_t sent = 0;
+};
+
+// fire and forget UDP syslog (RFC 5424), sent from handle() rather than
+// from wherever the line was logged
+class LogSyslogSink: public LogSink {
+public:
+  LogSyslogSink(): LogSink("syslog") {}
+
+  // server is a host name or an address, empty to stop sending; host and
+  // app name the device in the messages. All must stay valid.
+  void begin(const char *_server, uint16_t _port, const char *_host, const char *_app);
+
+  bool active() override { return server && server[0]; }
+  void write(const LogLineFormat &format, const LogHeader &header, const char *text, size_t length) override;
+  void handle() override;
+
+private:
+  const char *server = NULL;
+  uint16_t port = SYSLOG_PORT;
+  const char *host = "";
+  const char *app = "";
+  IPAddress address;
+  bool resolved = false;
+  bool resolveTried = false;
+  uint32_t lastResolve = 0;
+  WiFiUDP udp;
+  uint8_t queueBuffer[SYSLOG_QUEUE_SIZE];
+  LogQueue queue = LogQueue(queueBuffer, sizeof(queueBuffer));
+};
+
+#endif // ifndef __LOGSINK_H__
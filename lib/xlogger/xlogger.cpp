@@ -3,9 +3,11 @@
 char pf_buffer[PRINTF_BUFFER_LENGTH];
 char lineBuffer[LINE_BUFFER_LENGTH] = {0};
 int lineBufferLen = 0;
+char outBuffer[LOG_LINE_LENGTH];
 
 const char *strLogLevel[llLast] = {
   "n/a",
+  "Debug",
   "Info",
   "Warning",
   "Error",
@@ -29,7 +31,8 @@ time_t bootTime() {
 }
 
 xLogger::xLogger() {
-  
+  addSink(&serialSink);
+  addSink(&telnetSink);
 }
 
 void xLogger::begin(const char _hostName[], Stream *_serial, bool _serialEnabled, const char _passwd[]) {
@@ -47,7 +50,7 @@ void xLogger::cmdCallback(logCallback cb, const char* _commandDescription) {
 }
 
 void xLogger::enableSerial(bool _serialEnabled) {
-  serialEnabled = _serialEnabled && logSerial;
+  serialSink.enable(_serialEnabled);
 }
 
 void xLogger::setProgramVersion(char * _programVersion) {
@@ -66,6 +69,8 @@ void xLogger::handle() {
 
       // clear authenticate
       telnetAuthenticated = !strnlen(passwd, 1);
+      telnetSink.clear();
+      replaying = false;
 
       // Show the initial message
       showInitMessage();
@@ -81,6 +86,12 @@ void xLogger::handle() {
 
   // Is client connected ? (to reduce overhead in active)
   telnetConnected = (telnetClient && telnetClient.connected());
+  if (!telnetConnected)
+    replaying = false;
+  if (replaying)
+    replayLog();
+  // lines logged during a replay are in the cache, the replay shows them
+  telnetSink.enable(telnetConnected && telnetAuthenticated && !replaying);
 
   if (telnetConnected) {
     // get buffer from client
@@ -99,7 +110,13 @@ void xLogger::handle() {
           telnetCommand.concat(c);
     }
   }
-  
+
+  if (logRepeat.due(millis()))
+    reportRepeats();
+
+  // queued lines go out as far as each sink takes them
+  for (uint8_t i = 0; i < sinksCount; i++)
+    sinks[i]->handle();
 }
 
 bool xLogger::ExecCommand(const String &cmd) {
@@ -113,6 +130,12 @@ bool xLogger::ExecCommand(const String &cmd) {
     return true;
   }
 
+  if (cmd == "sinks") {
+    for (uint8_t i = 0; i < sinksCount; i++)
+      printf(PSTR("%s: %s, %u lines dropped\r\n"), sinks[i]->name, sinks[i]->active() ? "active" : "inactive", sinks[i]->dropped);
+    return true;
+  }
+
   if (cmd == "mem") {
     char heap[22];
     snprintf(heap, sizeof(heap), "Heap: %d.%03dB / %d%%", ESP.getFreeHeap() / 1000, ESP.getFreeHeap() % 1000, ESP.getHeapFragmentation());
@@ -128,27 +151,27 @@ bool xLogger::ExecCommand(const String &cmd) {
   }
 
   if (cmd == "time none") {
-    logTimeFormat = ltNone;
+    lineFormat.timeFormat = ltNone;
     return true;
   }
   if (cmd == "time str") {
-    logTimeFormat = ltStrTime;
+    lineFormat.timeFormat = ltStrTime;
     return true;
   }
   if (cmd == "time ms") {
-    logTimeFormat = ltMsTime;
+    lineFormat.timeFormat = ltMsTime;
     return true;
   }
   if (cmd == "time btw") {
-    logTimeFormat = ltMsBetween;
+    lineFormat.timeFormat = ltMsBetween;
     return true;
   }
   if (cmd == "time utc") {
-    logTimeFormat = ltUTCTime;
+    lineFormat.timeFormat = ltUTCTime;
     return true;
   }
   if (cmd == "time ?") {
-    println("Time format: " + String(strLogTimeFormat[logTimeFormat]));
+    printf(PSTR("Time format: %s\r\n"), strLogTimeFormat[lineFormat.timeFormat]);
     return true;
   }
 
@@ -159,7 +182,7 @@ bool xLogger::processCommand(String &cmd) {
   // process login
   if (!telnetAuthenticated) {
 
-    if (cmd == String(passwd)) {
+    if (cmd == passwd) {
       telnetClient.println("Password accepted.");
       println(llInfo, "Password accepted.");
 
@@ -170,13 +193,13 @@ bool xLogger::processCommand(String &cmd) {
     }
 
     telnetClient.println("Password rejected.");
-    println(llError, "Password (" + cmd + ") rejected.");
+    printf(llError, PSTR("Password (%s) rejected.\r\n"), cmd.c_str());
 
     return false;
   }
 
   // process command
-  println(llInfo, "Telnet received command: " + cmd);
+  printf(llInfo, PSTR("Telnet received command: %s\r\n"), cmd.c_str());
 
   if (ExecCommand(cmd)) {
     return true;
@@ -194,7 +217,7 @@ bool xLogger::processCommand(String &cmd) {
 
 
 void xLogger::setSerial(Stream *_serial) {
-  logSerial = _serial;
+  serialSink.setStream(_serial);
 }
 
 void xLogger::setPassword(const char *_passwd) {
@@ -203,200 +226,118 @@ void xLogger::setPassword(const char *_passwd) {
 }
 
 void xLogger::setTimeFormat(LogTimeFormat _timeFormat) {
-  logTimeFormat = _timeFormat;
+  lineFormat.timeFormat = _timeFormat;
 }
 
 void xLogger::setShowDebugLevel(bool _showDebugLevel) {
-  showDebugLevel = _showDebugLevel;
+  lineFormat.showLevel = _showDebugLevel;
 } 
 
 void xLogger::setFilterDebugLevel(LogLevel _logLevel) {
     filterLogLevel = _logLevel;
 }
 
+void xLogger::setBinaryLog(bool _binaryLog) {
+  binaryLog = _binaryLog;
+}
+
+void xLogger::setRepeatWindow(uint32_t window) {
+  logRepeat.setWindow(window);
+}
+
+bool xLogger::addSink(LogSink *sink) {
+  if (sinksCount >= XLOGGER_MAX_SINKS)
+    return false;
+  sinks[sinksCount++] = sink;
+  return true;
+}
+
 void xLogger::showInitMessage() {
-  String msg = SF("*** Telnet debug for ESP8266.\r\n");
+  telnetClient.print(F("*** Telnet debug for ESP8266.\r\n"));
 
   if (programVersion && strnlen(programVersion, 1))
-    msg += SF("Program version: ") + String(programVersion);
-  msg += SF("\r\nHost: ") + hostName;
-  msg += SF("\r\nIP  : ") + WiFi.localIP().toString();
-  msg += SF("\r\nMac : ") + WiFi.macAddress();
-  char heap[22];
-  snprintf(heap, sizeof(heap), "Heap: %d.%03dB / %d%%", ESP.getFreeHeap() / 1000, ESP.getFreeHeap() % 1000, ESP.getHeapFragmentation());
-  msg += SF("\r\n") + heap;
+    telnetPrintf(PSTR("Program version: %s\r\n"), programVersion);
+  telnetPrintf(PSTR("Host: %s\r\n"), hostName.c_str());
+  IPAddress ip = WiFi.localIP();
+  telnetPrintf(PSTR("IP  : %u.%u.%u.%u\r\n"), ip[0], ip[1], ip[2], ip[3]);
+  uint8_t mac[6];
+  WiFi.macAddress(mac);
+  telnetPrintf(PSTR("Mac : %02X:%02X:%02X:%02X:%02X:%02X\r\n"), mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+  telnetPrintf(PSTR("Heap: %d.%03dB / %d%%\r\n"), ESP.getFreeHeap() / 1000, ESP.getFreeHeap() % 1000, ESP.getHeapFragmentation());
 
   char str[20];
   if (timeStatus() != timeNotSet) {
     utcTimeToStr(str, 20, bootTime());
-    msg += SF("\r\nBoot  : ") + str;
+    telnetPrintf(PSTR("Boot  : %s\r\n"), str);
     utcTimeToStr(str, 20, now());
-    msg += SF("\r\nTime  : ") + str;
+    telnetPrintf(PSTR("Time  : %s\r\n"), str);
   }
   uptimeString(str, 20, millis() / 1000);
-  msg += SF("\r\nUptime: ") + str;
-
-  msg += SF("\r\n\r\nCommands:\r\n");
-  msg += SF("time [none|str|ms|btw|utc]: shows time in log lines. [");
-  msg += String(strLogTimeFormat[logTimeFormat]) + SF("]\r\n");
-  msg += SF("mem: print free heap.\r\n");
-  if (commandDescription && _cmdCallback)
-    msg += String(commandDescription) + STR_RN;
-  msg += STR_RN;
+  telnetPrintf(PSTR("Uptime: %s\r\n"), str);
+
+  telnetClient.print(F("\r\nCommands:\r\n"));
+  telnetPrintf(PSTR("time [none|str|ms|btw|utc]: shows time in log lines. [%s]\r\n"), strLogTimeFormat[lineFormat.timeFormat]);
+  telnetClient.print(F("mem: print free heap.\r\n"));
+  telnetClient.print(F("sinks: lines dropped per log destination.\r\n"));
+  if (commandDescription && _cmdCallback) {
+    telnetClient.print(commandDescription);
+    telnetClient.print(F("\r\n"));
+  }
+  telnetClient.print(F("\r\n"));
 
   if (!telnetAuthenticated && strnlen(passwd, 1))
-    msg += SF("Please, enter password before entering commands. Password length may be up to 10 symbols.") + STR_RN;
-
-  telnetClient.print(msg);
+    telnetClient.print(F("Please, enter password before entering commands. Password length may be up to 10 symbols.\r\n"));
 }
 
-int xLogger::getNextLogPtr(int fromPtr) {
-  int ptr = 0;
-  LogHeader header;
-
-  while (ptr <= LOG_SIZE - 1) {
-    memcpy(&header, &logMem[ptr], sizeof(LogHeader));
-    if (header.logTime == 0 && header.logLevel == llNone)
-      return ptr;
-
-    // check data length
-    if (header.logSize < 0 || header.logSize > LOG_SIZE - ptr + 1)
-      break;
-      
-    ptr += sizeof(LogHeader) + header.logSize + 1;
-    if (ptr > fromPtr)
-      return ptr;
-  }
-  
-  return -1;
+// only starts the replay, handle() sends it a bit at a time
+void xLogger::showLog() {
+  telnetClient.print(F("*** Cached log:\r\n"));
+  replaying = true;
+  replaySeq = logRing.first();
+  // what was queued is in the cache too
+  telnetSink.clear();
+  telnetSink.enable(false);
 }
 
-int xLogger::getEmptytLogPtr() {
-  int ptr = 0;
-  LogHeader header;
-
-  while (ptr <= LOG_SIZE - 1) {
-    memcpy(&header, &logMem[ptr], sizeof(LogHeader));
-    if (header.logTime == 0 && header.logLevel == llNone) {
-      return ptr;
-    }
-
-    // check data length
-    if (header.logSize < 0 || header.logSize > LOG_SIZE - ptr + 1)
-      break;
-
-    ptr += sizeof(LogHeader) + header.logSize + 1;
+// up to TELNET_REPLAY_BYTES of whole lines, as far as the client's send
+// buffer takes them, until it caught up with the newest line
+void xLogger::replayLog() {
+  if (replaySeq < logRing.first()) {
+    telnetPrintf(PSTR("*** %u lines dropped\r\n"), (unsigned)(logRing.first() - replaySeq));
+    replaySeq = logRing.first();
   }
 
-  return -1;
-}
-
-void xLogger::addLogToBuffer(LogHeader &header, const char *buffer) {
-  if (header.logSize <= 0 || !buffer)
-    return;
-
-  int ptr = getEmptytLogPtr();
-
-  // check buffer length
-  if ((ptr < 0) || (ptr + sizeof(LogHeader) + header.logSize + 1 > LOG_SIZE)) {
-    // get size that we need in buffer
-    int qptr = getNextLogPtr(max(LOG_SEGMENT, (int)sizeof(LogHeader) + header.logSize + 1));
-    if (qptr > 0) {
-      // move buffer with 0x00 tail
-      memmove(&logMem[0], &logMem[qptr], LOG_SIZE + sizeof(LogHeader) - qptr);
-      ptr = getEmptytLogPtr();
-    } else {
-      // if we cant get next pointer
-      return;   
+  size_t sent = 0;
+  while (sent < TELNET_REPLAY_BYTES) {
+    uint32_t seq = replaySeq;
+    if (!readLine(seq, outBuffer, sizeof(outBuffer))) {
+      telnetClient.print(F("***\r\n"));
+      replaying = false;
+      return;
     }
+    size_t size = strlen(outBuffer);
+    if ((size_t)telnetClient.availableForWrite() < size)
+      return;
+    telnetClient.write((const uint8_t *)outBuffer, size);
+    sent += size;
+    replaySeq = seq;
   }
-
-  // double check
-  if ((ptr < 0) || (ptr + sizeof(LogHeader) + header.logSize + 1 > LOG_SIZE)){ 
-    return;
-  }
-
-  // copy header
-  memcpy(&logMem[ptr], &header, sizeof(LogHeader));
-  ptr += sizeof(LogHeader);
-
-  // copy buffer
-  memcpy(&logMem[ptr], buffer, header.logSize);
-  ptr += header.logSize;
-  
-  // add 0x00 at the end
-  logMem[ptr] = 0x00;  
-  ptr++;
-  
-  // fill next log entry with 0x00
-  memset(&logMem[ptr], 0x00, sizeof(LogHeader));
 }
 
-void xLogger::showLog() {
-  telnetClient.println(SF("*** Cached log:"));
-
-  int ptr = 0;
-  String str;
-  LogHeader header;
-
-  while (ptr <= LOG_SIZE - 1) {
-    memcpy(&header, &logMem[ptr], sizeof(LogHeader));
-    if (header.logTime == 0 && header.logLevel == llNone) {
-      break;
-    }
-
-    formatLogMessage(str, (char*)(&logMem[ptr] + sizeof(LogHeader)), header.logSize, &header);
-    telnetClient.print(str);
-    
-    ptr += sizeof(LogHeader) + header.logSize + 1;
-  }
-  telnetClient.println(SF("***"));
+size_t xLogger::formatLine(char *str, size_t size, const LogHeader &header, const char *data, size_t length) {
+  lineFormat.bootTime = bootTime();
+  size_t written = logLine(str, size, lineFormat, header, data, length);
+  lineFormat.lastTime = header.logTime;
+  return written;
 }
 
-void xLogger::formatLogMessage(String &str, const char *buffer, size_t size, LogHeader *header) {
-  str = "";
-
-  if (header) {
-    // show time
-    switch (logTimeFormat) {
-      case ltStrTime:
-        char uptime[20];
-        uptimeString(uptime, 20, header->logTime / 1000);
-        str = String(uptime);
-        str += SF(" ");
-        break;
-      case ltMsTime:
-        str = String(header->logTime);
-        str += SF(" ");
-        break;
-      case ltMsBetween:
-        str = String(header->logTime - oldMillis);
-        str += SF(" ");
-        oldMillis = header->logTime;
-        break;
-      case ltUTCTime:
-        char time[20];
-        utcTimeToStr(time, 20, bootTime() + header->logTime / 1000);
-        str = String(time);
-        str += SF(" ");
-        break;
-      case ltNone:
-      case ltLast:
-        break;
-    };
-  
-    // show log level
-    if (showDebugLevel) {
-      switch (header->logLevel) {
-        case llInfo:     str += SF("INFO: "); break;
-        case llWarning:  str += SF("WARNING: "); break;
-        case llError:    str += SF("ERROR: "); break;
-        default:         str += SF("UNKNOWN: "); break;
-      }
-    }
-  }
-
-  str += String(buffer);  
+bool xLogger::readLine(uint32_t &seq, char *str, size_t size) {
+  LogHeader header;
+  char line[LINE_BUFFER_LENGTH];
+  if (!logRing.readNumber(seq, header, line, sizeof(line)))
+    return false;
+  formatLine(str, size, header, line, header.logSize);
+  return true;
 }
 
 void xLogger::processLineBuffer() {
@@ -412,25 +353,62 @@ void xLogger::processLineBuffer() {
   if (filterLogLevel <= curHeader.logLevel) { // filter here
     curHeader.logTime = millis();
 
-    // write to buffer
     curHeader.logSize = lineBufferLen;
-    addLogToBuffer(curHeader, &lineBuffer[0]);
+    addLine(curHeader, lineBuffer);
+  }
+  
+  lineBufferLen = 0;
+}
 
-    String msg = "";
-    formatLogMessage(msg, lineBuffer, lineBufferLen, &curHeader);
+void xLogger::outputLine(const LogHeader &header, const char *data, size_t length) {
+  bool active = false;
+  for (uint8_t i = 0; i < sinksCount; i++)
+    active = sinks[i]->active() || active;
+  if (!active)
+    return;
 
-    // write to serial
-    if (serialEnabled && logSerial) {
-      logSerial->print(msg);
-    }
+  // the text is formatted once for all sinks
+  LogHeader textHeader = header;
+  if (header.logFlags & LOG_FLAG_BINARY) {
+    length = logFormat(pf_buffer, sizeof(pf_buffer), (const uint8_t *)data, length);
+    data = pf_buffer;
+    textHeader.logFlags &= ~LOG_FLAG_BINARY;
+  }
 
-    // write to telnet
-    if (telnetConnected && (telnetAuthenticated || !strnlen(passwd, 1)) ) { 
-      telnetClient.print(msg);
-    }
+  lineFormat.bootTime = bootTime();
+  for (uint8_t i = 0; i < sinksCount; i++) {
+    if (sinks[i]->active())
+      sinks[i]->write(lineFormat, textHeader, data, length);
   }
-  
-  lineBufferLen = 0;
+  lineFormat.lastTime = header.logTime;
+}
+
+void xLogger::addRecord(LogHeader &header, const uint8_t *record) {
+  header.logTime = millis();
+  addLine(header, (const char *)record);
+}
+
+void xLogger::addLine(const LogHeader &header, const char *data) {
+  if (logRepeat.repeated(header, data, logRing))
+    return;
+  reportRepeats();
+  logRepeat.keep(header);
+  logRing.add(header, data);
+  outputLine(header, data, header.logSize);
+}
+
+// the count goes in like any line, but isn't itself counted as a repeat
+void xLogger::reportRepeats() {
+  LogHeader header;
+  uint16_t count = logRepeat.take(header);
+  if (!count)
+    return;
+  uint8_t record[LOG_RECORD_SIZE];
+  header.logFlags = LOG_FLAG_BINARY;
+  header.logSize = logPack(record, sizeof(record), PSTR("Last message repeated %u time%s\r\n"),
+      (unsigned)count, count == 1 ? "" : "s");
+  logRing.add(header, (const char *)record);
+  outputLine(header, (const char *)record, header.logSize);
 }
 
 size_t xLogger::write(uint8_t c) {
@@ -445,32 +423,11 @@ size_t xLogger::write(const uint8_t *buffer, size_t size) {
   if (!size)
     return size;
                               
-  memcpy(&lineBuffer[lineBufferLen], buffer, min((int)size, LINE_BUFFER_LENGTH - lineBufferLen - 1)); // copy with checking length
-  lineBufferLen += size;
+  int len = min((int)size, LINE_BUFFER_LENGTH - lineBufferLen - 1); // copy with checking length
+  memcpy(&lineBuffer[lineBufferLen], buffer, len);
+  lineBufferLen += len;
 
   processLineBuffer();
   
   return size;
 }
-
-void uptimeString(char* str, size_t size, long val) {
-    int days = elapsedDays(val);
-    int hours = numberOfHours(val);
-    int minutes = numberOfMinutes(val);
-    int seconds = numberOfSeconds(val);
-
-    if (days > 0) {
-        snprintf(str, size, "%dd %dh %dm %ds", days, hours, minutes, seconds);
-    } else if (hours > 0) {
-        snprintf(str, size, "%dh %dm %ds", hours, minutes, seconds);
-    } else if (minutes > 0) {
-        snprintf(str, size, "%dm %ds", minutes, seconds);
-    } else {
-        snprintf(str, size, "%ds", seconds);
-    }
-}
-
-void utcTimeToStr(char* str, size_t size, time_t time) {
-  snprintf(str, size, "%04d-%02d-%02d %02d:%02d:%02d",
-      year(time), month(time), day(time), hour(time), minute(time), second(time));
-}
@@ -14,54 +14,34 @@
 #include <ESP8266WiFi.h>     // https://github.com/esp8266/Arduino
 #include <TimeLib.h>         // https://github.com/PaulStoffregen/Time 
 
+#include "logline.h"
+#include "logrecord.h"
+#include "logrepeat.h"
+#include "logring.h"
+#include "logsink.h"
+
 #define XLOGGER_VERSION      "1.0"
 
 #define TELNET_PORT          23                  // telent port for remote connection
-#define LOG_SIZE             2048                // size of log memory buffer in bytes
-#define LOG_SEGMENT          256                 // minimal size of log rotating
 #define PRINTF_BUFFER_LENGTH 128                 // buffer length for printf execution
 #define LINE_BUFFER_LENGTH   256                 // buffer length for commands (concatinate print and println)
+#define XLOGGER_MAX_SINKS    4
+#define TELNET_REPLAY_BYTES  512                 // cached log sent to the telnet client per handle()
 extern char pf_buffer[PRINTF_BUFFER_LENGTH];
 
 // string to flash
 #define SF(x) String(F(x))
 #define STR_RN SF("\r\n")
-// time conversion
-void uptimeString(char* str, size_t size, long val);
-void utcTimeToStr(char* str, size_t size, time_t time);
 
 typedef bool (*logCallback)(String &cmd);
 
-enum LogLevel: uint8_t{
-  llNone,
-  llInfo, 
-  llWarning,
-  llError,
-
-  llLast
-};
 extern const char *strLogLevel[llLast];
 
-enum LogTimeFormat: uint8_t {
-  ltNone,
-  ltStrTime,
-  ltMsTime,
-  ltMsBetween,
-  ltUTCTime,
-
-  ltLast
-};
 extern const char *strLogTimeFormat[ltLast];
 
-struct LogHeader {
-  int logTime = 0;
-  uint16_t logSize = 0;
-  LogLevel logLevel = llInfo;
-};
-struct LogEntity {
-  LogHeader header;
-  char data[];
-};
+// seconds since the epoch at boot, 0 while the clock isn't set
+time_t bootTime();
+
 
 class xLogger: public Print{
 public:
@@ -80,6 +60,22 @@ public:
   void setTimeFormat(LogTimeFormat _timeFormat);
   void setShowDebugLevel(bool _showDebugLevel);
   void setFilterDebugLevel(LogLevel _logLevel);
+  void setBinaryLog(bool _binaryLog);
+  // identical lines within window milliseconds are counted instead of
+  // kept, 0 keeps them all
+  void setRepeatWindow(uint32_t window);
+
+  // lines also go to sink, which must stay valid; serial and telnet are
+  // there from the start
+  bool addSink(LogSink *sink);
+  uint8_t sinkCount() { return sinksCount; }
+  LogSink *sink(uint8_t index) { return sinks[index]; }
+
+  // the cached line numbered seq as shown, or the oldest one if it was
+  // evicted; moves seq past it, start from 0. False past the newest.
+  bool readLine(uint32_t &seq, char *str, size_t size);
+  // the cached lines as stored, to save them somewhere
+  const LogRing &ring() const { return logRing; }
 
   virtual size_t write(uint8_t c);
   virtual size_t write(const uint8_t *buffer, size_t size);
@@ -95,6 +91,31 @@ public:
     printf(llInfo, fmtstr, args...);
   }
     
+  // like printf, but in binary mode the line is kept packed and only
+  // formatted when shown, so fmtstr must stay valid (a PSTR literal)
+  template<typename... Args>
+  void log(LogLevel loglev, const char* fmtstr, Args... args) {
+    if (!binaryLog) {
+      printf(loglev, fmtstr, args...);
+      return;
+    }
+    if (filterLogLevel > loglev)
+      return;
+    uint8_t record[LOG_RECORD_SIZE];
+    LogHeader header;
+    header.logLevel = loglev;
+    header.logFlags = LOG_FLAG_BINARY;
+    header.logSize = logPack(record, sizeof(record), fmtstr, args...);
+    if (header.logSize)
+      addRecord(header, record);
+    else
+      printf(loglev, fmtstr, args...);
+  }
+  template<typename... Args>
+  void log(const char* fmtstr, Args... args) {
+    log(llInfo, fmtstr, args...);
+  }
+
   template<typename... Args>
   void print(LogLevel loglev, Args... args) {
     curHeader.logLevel = loglev;
@@ -116,19 +137,20 @@ public:
   }
 private:
   String hostName = "n/a";
-  bool serialEnabled = false;
-  Stream *logSerial = NULL;
-  uint8_t logMem[LOG_SIZE + sizeof(LogHeader) + 8] = {0}; // 8 - guard interval
+  LogRing logRing;
+  LogRepeat logRepeat;
   char passwd[11] = {0};
   bool telnetConnected = false;
   char * programVersion = NULL;
   const char * commandDescription = NULL;
-  bool showDebugLevel = true;
   LogLevel filterLogLevel = llInfo;
-  int oldMillis = 0;
-  LogTimeFormat logTimeFormat = ltStrTime;
+  LogLineFormat lineFormat;
   String telnetCommand = "";
   bool telnetAuthenticated = false;
+  bool binaryLog = false;
+  // the cached log is being sent to the telnet client, from line replaySeq
+  bool replaying = false;
+  uint32_t replaySeq = 0;
 
   // command callback
   logCallback _cmdCallback;
@@ -136,16 +158,31 @@ private:
   WiFiServer telnetServer = WiFiServer(TELNET_PORT);
   WiFiClient telnetClient;
 
+  LogStreamSink serialSink;
+  LogClientSink telnetSink = LogClientSink(telnetClient);
+  LogSink *sinks[XLOGGER_MAX_SINKS];
+  uint8_t sinksCount = 0;
+
   LogHeader curHeader;
 
+  // formats into pf_buffer, so no String is built for the client
+  template<typename... Args>
+  void telnetPrintf(const char* fmtstr, Args... args) {
+    int size = snprintf_P(pf_buffer, sizeof(pf_buffer), fmtstr, args...);
+    if (size > 0)
+      telnetClient.write((const uint8_t *)pf_buffer, min((size_t)size, sizeof(pf_buffer) - 1));
+  }
+
   void showInitMessage();
     
-  int getNextLogPtr(int fromPtr);
-  int getEmptytLogPtr();
-  void addLogToBuffer(LogHeader &header, const char *buffer);
   void showLog();
-  void formatLogMessage(String &str, const char *buffer, size_t size, LogHeader *header);
+  void replayLog();
+  size_t formatLine(char *str, size_t size, const LogHeader &header, const char *data, size_t length);
 
+  void outputLine(const LogHeader &header, const char *data, size_t length);
+  void addRecord(LogHeader &header, const uint8_t *record);
+  void addLine(const LogHeader &header, const char *data);
+  void reportRepeats();
   void processLineBuffer();
   bool processCommand(String &cmd);
 };
@@ -0,0 +1,334 @@
+// Log line buffer: the xLogger ring buffer against the linear buffer it
+// replaced, which is kept here as the baseline. The linear one scans every
+// header to find the end on each line and, when full, scans again and
+// memmoves the whole buffer to drop the oldest LOG_SEGMENT bytes.
+//
+// Then a whole MIE_LOG call, formatted with snprintf as before or packed as
+// a binary record, and how many lines the buffer holds either way. The path
+// from logging a line to its shown form must not allocate, which is checked
+// with the heap tracker's counters (env:native wraps malloc). Repeats of a
+// line are checked to be counted rather than kept.
+
+#include "log_buffer.h"
+
+#include <logline.h>
+#include <logrecord.h>
+#include <logrepeat.h>
+#include <logring.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "heap_tracker.h"
+
+#define LOG_SEGMENT 256
+// matches PRINTF_BUFFER_LENGTH in lib/xlogger/xlogger.h
+#define PRINTF_LENGTH 128
+
+// lib/xlogger/xlogger.cpp before the ring buffer
+class LinearLog {
+public:
+    LinearLog() { memset(logMem, 0, sizeof(logMem)); }
+
+    void add(LogHeader &header, const char *buffer) {
+        if (header.logSize <= 0 || !buffer)
+            return;
+
+        int ptr = getEmptytLogPtr();
+        if ((ptr < 0) || (ptr + sizeof(LogHeader) + header.logSize + 1 > LOG_SIZE)) {
+            int qptr = getNextLogPtr(std::max(LOG_SEGMENT, (int)sizeof(LogHeader) + header.logSize + 1));
+            if (qptr > 0) {
+                memmove(&logMem[0], &logMem[qptr], LOG_SIZE + sizeof(LogHeader) - qptr);
+                ptr = getEmptytLogPtr();
+            } else {
+                return;
+            }
+        }
+        if ((ptr < 0) || (ptr + sizeof(LogHeader) + header.logSize + 1 > LOG_SIZE)) {
+            return;
+        }
+
+        memcpy(&logMem[ptr], &header, sizeof(LogHeader));
+        ptr += sizeof(LogHeader);
+        memcpy(&logMem[ptr], buffer, header.logSize);
+        ptr += header.logSize;
+        logMem[ptr] = 0x00;
+        ptr++;
+        memset(&logMem[ptr], 0x00, sizeof(LogHeader));
+    }
+
+    std::vector<std::string> lines() const {
+        std::vector<std::string> result;
+        int ptr = 0;
+        LogHeader header;
+        while (ptr <= LOG_SIZE - 1) {
+            memcpy(&header, &logMem[ptr], sizeof(LogHeader));
+            if (header.logTime == 0 && header.logLevel == llNone) {
+                break;
+            }
+            result.emplace_back((const char *)&logMem[ptr + sizeof(LogHeader)], header.logSize);
+            ptr += sizeof(LogHeader) + header.logSize + 1;
+        }
+        return result;
+    }
+
+private:
+    uint8_t logMem[LOG_SIZE + sizeof(LogHeader) + 8];
+
+    int getNextLogPtr(int fromPtr) {
+        int ptr = 0;
+        LogHeader header;
+        while (ptr <= LOG_SIZE - 1) {
+            memcpy(&header, &logMem[ptr], sizeof(LogHeader));
+            if (header.logTime == 0 && header.logLevel == llNone)
+                return ptr;
+            if (header.logSize > LOG_SIZE - ptr + 1)
+                break;
+            ptr += sizeof(LogHeader) + header.logSize + 1;
+            if (ptr > fromPtr)
+                return ptr;
+        }
+        return -1;
+    }
+
+    int getEmptytLogPtr() {
+        int ptr = 0;
+        LogHeader header;
+        while (ptr <= LOG_SIZE - 1) {
+            memcpy(&header, &logMem[ptr], sizeof(LogHeader));
+            if (header.logTime == 0 && header.logLevel == llNone)
+                return ptr;
+            if (header.logSize > LOG_SIZE - ptr + 1)
+                break;
+            ptr += sizeof(LogHeader) + header.logSize + 1;
+        }
+        return -1;
+    }
+};
+
+static std::vector<std::string> ring_lines(const LogRing &ring) {
+    std::vector<std::string> result;
+    uint16_t offset = 0;
+    LogHeader header;
+    char line[LOG_SIZE];
+    while (ring.read(offset, header, line, sizeof(line))) {
+        result.emplace_back(line, header.logSize);
+    }
+    return result;
+}
+
+// MIE_LOG-like lines of varying length
+static void log_line(unsigned long i, char *line, LogHeader *header) {
+    header->logTime = 1 + i;
+    header->logLevel = llInfo;
+    header->logSize = snprintf(line, 128, "⬅ HP room temp %lu.5 op %lu cmp %lu%s\n",
+            i % 30, i & 1, i % 90, i % 7 ? "" : " with a longer tail to vary the record size");
+}
+
+#define BENCH_LINES 64
+
+// only the buffer is timed, the lines are formatted beforehand
+template <typename Log>
+static double bench_log(const char *name, Log &log, unsigned long iterations) {
+    static char lines[BENCH_LINES][128];
+    static LogHeader headers[BENCH_LINES];
+    for (unsigned long i = 0; i < BENCH_LINES; i++) {
+        log_line(i, lines[i], &headers[i]);
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long i = 0; i < iterations; i++) {
+        log.add(headers[i % BENCH_LINES], lines[i % BENCH_LINES]);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+    printf("%-28s %10lu %10.1f ns/op\n", name, iterations, ns);
+    return ns;
+}
+
+static const char log_format[] = "⬅ HP power %s mode %s target %.1f fan %s v vane %s h vane %s\r\n";
+static const char *log_modes[] = {"HEAT", "COOL", "DRY", "FAN", "AUTO"};
+
+// the busiest MIE_LOG call, as text
+static void log_text(LogRing &ring, unsigned long i) {
+    char line[PRINTF_LENGTH];
+    LogHeader header;
+    header.logTime = 1 + i;
+    header.logSize = snprintf(line, sizeof(line), log_format,
+            "ON", log_modes[i % 5], 16.0f + i % 15, "AUTO", "SWING", "|");
+    ring.add(header, line);
+}
+
+// and packed
+static void log_packed(LogRing &ring, unsigned long i) {
+    uint8_t record[LOG_RECORD_SIZE];
+    LogHeader header;
+    header.logTime = 1 + i;
+    header.logFlags = LOG_FLAG_BINARY;
+    header.logSize = logPack(record, sizeof(record), log_format,
+            "ON", log_modes[i % 5], 16.0f + i % 15, "AUTO", "SWING", "|");
+    ring.add(header, (const char *)record);
+}
+
+// allocations made under the current tag, including those the tracker's
+// table had no room for
+static uint32_t log_allocations() {
+    return heap_tag_stats(HEAP_TAG_LOGGER)->allocs + heap_untracked();
+}
+
+// logs both ways and shows every line in each time format, as the sinks do
+static int check_log_allocations() {
+    HeapTag tag(HEAP_TAG_LOGGER);
+
+    uint32_t before = log_allocations();
+    void *volatile probe = malloc(16);
+    free(probe);
+    if (log_allocations() == before) {
+        fprintf(stderr, "log allocations: malloc is not counted\n");
+        return 1;
+    }
+
+    before = log_allocations();
+    static LogRing ring;
+    LogLineFormat format;
+    format.bootTime = 1600000000;
+    char record[LOG_SIZE];
+    char line[LOG_SIZE];
+    LogHeader header;
+    for (unsigned long i = 0; i < 100; i++) {
+        log_text(ring, i);
+        log_packed(ring, i);
+        for (uint8_t time = ltNone; time < ltLast; time++) {
+            format.timeFormat = (LogTimeFormat)time;
+            format.showLevel = time & 1;
+            uint16_t offset = 0;
+            while (ring.read(offset, header, record, sizeof(record))) {
+                logLine(line, sizeof(line), format, header, record, header.logSize);
+            }
+        }
+    }
+    if (log_allocations() != before) {
+        fprintf(stderr, "log allocations: %u while logging\n", log_allocations() - before);
+        return 1;
+    }
+    return 0;
+}
+
+// the same packed line every second is kept once, and its repeats are
+// reported when the window is over; another value is another line
+static int check_log_repeats() {
+    static LogRing ring;
+    LogRepeat repeat;
+    uint8_t record[LOG_RECORD_SIZE];
+    LogHeader header;
+    header.logFlags = LOG_FLAG_BINARY;
+    header.logSize = logPack(record, sizeof(record), log_format, "ON", "HEAT", 21.0f, "AUTO", "SWING", "|");
+    unsigned kept = 0;
+    for (int i = 0; i < 10; i++) {
+        header.logTime = i * 1000;
+        if (!repeat.repeated(header, (const char *)record, ring)) {
+            repeat.keep(header);
+            ring.add(header, (const char *)record);
+            kept++;
+        }
+    }
+    if (kept != 1 || repeat.due(9000) || !repeat.due(LOG_REPEAT_WINDOW)) {
+        fprintf(stderr, "log repeats: %u lines kept\n", kept);
+        return 1;
+    }
+    LogHeader report;
+    uint16_t count = repeat.take(report);
+    if (count != 9 || report.logTime != 9000 || repeat.due(LOG_REPEAT_WINDOW)) {
+        fprintf(stderr, "log repeats: %u reported at %d\n", count, report.logTime);
+        return 1;
+    }
+
+    header.logTime = 10000;
+    header.logSize = logPack(record, sizeof(record), log_format, "ON", "HEAT", 21.5f, "AUTO", "SWING", "|");
+    if (repeat.repeated(header, (const char *)record, ring)) {
+        fprintf(stderr, "log repeats: a different line counted as a repeat\n");
+        return 1;
+    }
+    return 0;
+}
+
+template <typename Log>
+static double bench_call(const char *name, Log log, unsigned long iterations) {
+    static LogRing ring;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long i = 0; i < iterations; i++) {
+        log(ring, i);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+    printf("%-28s %10lu %10.1f ns/op\n", name, iterations, ns);
+    return ns;
+}
+
+int bench_log_buffer() {
+    int failures = 0;
+
+    // both keep the newest lines in order; the ring keeps more of them as
+    // it only evicts what it needs
+    static LinearLog linear;
+    static LogRing ring;
+    char line[128];
+    LogHeader header;
+    for (unsigned long i = 0; i < 1000; i++) {
+        log_line(i, line, &header);
+        linear.add(header, line);
+        ring.add(header, line);
+    }
+    std::vector<std::string> expected = linear.lines();
+    std::vector<std::string> actual = ring_lines(ring);
+    if (expected.empty() || actual.size() < expected.size() ||
+            !std::equal(expected.begin(), expected.end(), actual.end() - expected.size())) {
+        fprintf(stderr, "log ring: lines differ from the linear buffer\n");
+        failures++;
+    }
+    if (ring.used() > LOG_SIZE || ring.count() != actual.size()) {
+        fprintf(stderr, "log ring: %u bytes in %u records\n", ring.used(), ring.count());
+        failures++;
+    }
+    if (failures) {
+        return failures;
+    }
+
+    // packed records read back as the text lines
+    static LogRing text;
+    static LogRing packed;
+    for (unsigned long i = 0; i < 1000; i++) {
+        log_text(text, i);
+        log_packed(packed, i);
+    }
+    std::vector<std::string> lines = ring_lines(text);
+    std::vector<std::string> records;
+    uint16_t offset = 0;
+    char record[LOG_SIZE];
+    while (packed.read(offset, header, record, sizeof(record))) {
+        logFormat(line, sizeof(line), (const uint8_t *)record, header.logSize);
+        records.push_back(line);
+    }
+    if (lines.empty() || records.size() < lines.size() ||
+            !std::equal(lines.begin(), lines.end(), records.end() - lines.size())) {
+        fprintf(stderr, "log record: formatted records differ from the text lines\n");
+        return 1;
+    }
+    if (check_log_allocations() || check_log_repeats()) {
+        return 1;
+    }
+
+    double before = bench_log("log line, linear buffer", linear, 200000);
+    double after = bench_log("log line, ring buffer", ring, 200000);
+    printf("%-28s %10s %10.1fx\n", "log line speedup", "", before / after);
+
+    before = bench_call("MIE_LOG, text", log_text, 200000);
+    after = bench_call("MIE_LOG, packed", log_packed, 200000);
+    printf("%-28s %10s %10.1fx\n", "MIE_LOG speedup", "", before / after);
+    printf("%-28s %10u %10u packed\n", "MIE_LOG lines in buffer", text.count(), packed.count());
+    return 0;
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+// checks and times the log line buffer, returns the number of failed checks
+int bench_log_buffer();
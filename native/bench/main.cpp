@@ -0,0 +1,74 @@
+// Microbenchmarks for the heat pump <-> HomeKit translation paths and the
+// log line buffer.
+//
+// Runs the real src/heatpump_client.cpp, src/homekit.cpp and src/accessory.c
+// against the host shims. The translation results are checked by the suite
+// in test/test_translation, which pio test builds with these sources, so
+// main() is left out of that build.
+
+#include <Arduino.h>
+#include <HeatPump.h>
+#include <homekit/characteristics.h>
+
+#include <chrono>
+
+#include "accessory.h"
+#include "heatpump_client.h"
+#include "homekit.h"
+#include "log_buffer.h"
+#include "scheduler.h"
+
+// matches UPDATE_INTERVAL in src/homekit.cpp
+#define UPDATE_INTERVAL 5000
+
+template <typename Body>
+static void bench(const char *name, unsigned long iterations, Body body) {
+    unsigned long notifications = homekit_notify_count();
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long i = 0; i < iterations; i++) {
+        body(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+    notifications = homekit_notify_count() - notifications;
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    printf("%-28s %10lu %10.1f ns/op %6.2f notify/op\n",
+            name, iterations, ns / iterations, (double)notifications / iterations);
+}
+
+static const heatpumpSettings cool = {"ON", "COOL", 22, "2", "SWING", "|", false, true};
+static const heatpumpSettings heat = {"ON", "HEAT", 24, "AUTO", "AUTO", "SWING", false, true};
+
+static const heatpumpStatus running = {23.5, true, {"NONE", 0, 0, 0, 0}, 42};
+static const heatpumpStatus idle = {22.0, false, {"NONE", 0, 0, 0, 0}, 0};
+
+#ifndef PIO_UNIT_TESTING
+int main() {
+    homekit_init("Heat Pump bench", [] {});
+    heatpump_init();
+
+    bench("hp settings -> hk", 200000, [](unsigned long i) {
+        heatpump.receiveSettings(i & 1 ? cool : heat);
+    });
+
+    heatpump.receiveSettings(heat);
+    bench("hp status -> hk", 200000, [](unsigned long i) {
+        heatpump.receiveStatus(i & 1 ? running : idle);
+    });
+
+    bench("hk setter -> hp update", 50000, [](unsigned long i) {
+        ch_thermostat_target_temperature.setter(HOMEKIT_FLOAT_CPP(i & 1 ? 20 : 21));
+        native_advance(UPDATE_INTERVAL);
+        scheduler_loop();
+    });
+
+    bench("accessory_set_float", 1000000, [](unsigned long i) {
+        accessory_set_float(&ch_dehumidifier_relative_humidity, i & 1 ? 40 : 41, true);
+    });
+
+    if (bench_log_buffer()) {
+        return 1;
+    }
+    return 0;
+}
+#endif
@@ -0,0 +1,28 @@
+// The SwiCago/HeatPump packet decoder reading from the CN105 UART. The link
+// is a plain serial line: noise, a disconnected cable or a different indoor
+// unit model all produce arbitrary bytes.
+//
+// Builds the library from lib_deps against the host Arduino shims and feeds
+// the input as the bytes received from the unit, running the connection and
+// sync sequence until they are consumed.
+
+#include <HeatPump.h>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    HeatPump heatpump;
+    heatpump.enableExternalUpdate();
+    heatpump.disableAutoUpdate();
+
+    Serial.feed(data, size);
+    heatpump.connect(&Serial);
+
+    // every sync either reads a reply or sends a request, bound the loop in
+    // case the decoder stops consuming input
+    for (size_t i = 0; Serial.available() > 0 && i < 2 * size + 4; i++) {
+        native_advance(1100);
+        heatpump.sync();
+    }
+
+    Serial.feed(nullptr, 0);
+    return 0;
+}
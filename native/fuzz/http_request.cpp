@@ -0,0 +1,143 @@
+// http_server_loop() parsing requests from the network: anything on the LAN
+// can connect, send partial or malformed requests and stop reading the
+// response half way.
+//
+// Input: the first byte sets the size of the pieces the request arrives in
+// (1 to 64 bytes), the second the send window; the rest is the request. The
+// routes cover form arguments, raw bodies, uploads and streamed responses.
+// Aborts if the server keeps the connection past its timeout or calls the
+// upload callback out of order.
+
+#include <ESP8266WiFi.h>
+#include <LittleFS.h>
+
+#include "http_server.h"
+
+static int upload_stage = -1;
+
+static void check(bool condition) {
+    if (!condition) {
+        abort();
+    }
+}
+
+static void get_text(http_request_t *request) {
+    http_add_header(request, "Cache-Control", "no-cache");
+    http_send(request, 200, "text/plain", http_path(request));
+}
+
+static void post_form(http_request_t *request) {
+    size_t size = 0;
+    for (uint8_t i = 0; i < http_arg_count(request); i++) {
+        size += strlen(http_arg_name(request, i)) + strlen(http_arg_value(request, i));
+    }
+    char body[12];
+    snprintf(body, sizeof(body), "%u", (unsigned)size);
+    const char *etag = http_header(request, HTTP_HEADER_IF_MATCH);
+    http_send(request, etag ? 412 : 200, "text/plain", etag ? etag : body);
+}
+
+static void put_body(http_request_t *request) {
+    size_t size;
+    const char *body = http_body(request, &size);
+    check(body[size] == '\0');
+    http_send(request, 200, "application/octet-stream", body, size);
+}
+
+static void upload(http_request_t *request, http_upload_stage_t stage, const uint8_t *data, size_t size) {
+    switch (stage) {
+        case HTTP_UPLOAD_START:
+            check(upload_stage == -1);
+            break;
+        case HTTP_UPLOAD_DATA:
+            check(upload_stage == HTTP_UPLOAD_START || upload_stage == HTTP_UPLOAD_DATA);
+            check(size > 0);
+            break;
+        case HTTP_UPLOAD_END:
+        case HTTP_UPLOAD_ABORT:
+            check(upload_stage == HTTP_UPLOAD_START || upload_stage == HTTP_UPLOAD_DATA);
+            break;
+    }
+    upload_stage = stage;
+}
+
+static void post_upload(http_request_t *request) {
+    check(upload_stage == -1 || upload_stage == HTTP_UPLOAD_END);
+    http_send(request, 200, "text/plain", "done");
+}
+
+static bool steps(http_request_t *request, uint16_t step) {
+    JsonWriter &json = http_json(request);
+    if (step == 0) {
+        json.beginArray();
+    }
+    json.beginObject();
+    json.field("step", step);
+    json.field("path", http_path(request));
+    json.endObject();
+    if (step == 20) {
+        json.endArray();
+        return false;
+    }
+    return true;
+}
+
+static void get_steps(http_request_t *request) {
+    http_send_steps(request, 200, "application/json", steps);
+}
+
+static void get_file(http_request_t *request) {
+    File file = LittleFS.open("/file", "r");
+    http_send_file(request, 200, "text/plain", file);
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    static bool initialized = false;
+    if (!initialized) {
+        http_server_init(80);
+        http_on("/", HTTP_METHOD_GET, get_text);
+        http_on("/form", HTTP_METHOD_POST, post_form);
+        http_on("/body", HTTP_METHOD_PUT, put_body);
+        http_on("/upload", HTTP_METHOD_POST, post_upload, upload);
+        http_on("/steps", HTTP_METHOD_GET, get_steps);
+        http_on("/file", HTTP_METHOD_GET, get_file);
+
+        File file = LittleFS.open("/file", "w");
+        for (int i = 0; i < 200; i++) {
+            file.write("0123456789");
+        }
+        file.close();
+        initialized = true;
+    }
+    if (size < 2) {
+        return 0;
+    }
+
+    size_t piece = data[0] % 64 + 1;
+    auto socket = WiFiServer::connect();
+    socket->window = data[1] * 8 + 1;
+    data += 2;
+    size -= 2;
+    upload_stage = -1;
+
+    size_t fed = 0;
+    unsigned long started = millis();
+    while (!socket->closed) {
+        if (fed < size) {
+            size_t n = min(piece, size - fed);
+            socket->input.append((const char *)data + fed, n);
+            fed += n;
+        } else {
+            // the whole request is in, the client goes away after a while
+            socket->hung_up = millis() - started > 20000;
+        }
+        http_server_loop();
+        socket->output.clear();
+        native_advance(100);
+        check(millis() - started < 60000 + size * 100);
+    }
+
+    check(http_connection_count() == 0);
+    check(upload_stage == -1 || upload_stage == HTTP_UPLOAD_END || upload_stage == HTTP_UPLOAD_ABORT);
+    return 0;
+}
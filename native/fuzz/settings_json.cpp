@@ -0,0 +1,18 @@
+// settings_init() importing /config.json, as it does when there is no
+// binary image: the file survives firmware updates and may have been edited
+// or truncated.
+
+#include <LittleFS.h>
+
+#include "settings.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    LittleFS.remove(SETTINGS_FILE_0);
+    LittleFS.remove(SETTINGS_FILE_1);
+    File f = LittleFS.open(CONFIG_FILE, "w");
+    f.write(data, size);
+    f.close();
+
+    settings_init();
+    return 0;
+}
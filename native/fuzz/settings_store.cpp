@@ -0,0 +1,61 @@
+// settings_init() reading the binary settings images: flash can hold torn
+// writes, images from other firmware versions or garbage. Aborts if a
+// string setting comes out unterminated or a save doesn't read back.
+//
+// Input: the size of the first image as two bytes, little endian, then the
+// first image followed by the second one. An empty image leaves its file
+// out.
+
+#include <LittleFS.h>
+
+#include "settings.h"
+
+static void write(const char *path, const uint8_t *data, size_t size) {
+    File f = LittleFS.open(path, "w");
+    f.write(data, size);
+    f.close();
+}
+
+static void check_terminated(const char *str, size_t size) {
+    if (strnlen(str, size) == size) {
+        abort();
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (size < 2) {
+        return 0;
+    }
+    size_t first = min((size_t)(data[0] | data[1] << 8), size - 2);
+    data += 2;
+    size -= 2;
+
+    LittleFS.remove(CONFIG_FILE);
+    LittleFS.remove(SETTINGS_FILE_0);
+    LittleFS.remove(SETTINGS_FILE_1);
+    if (first) {
+        write(SETTINGS_FILE_0, data, first);
+    }
+    if (size > first) {
+        write(SETTINGS_FILE_1, data + first, size - first);
+    }
+
+    settings_init();
+    check_terminated(settings.mqtt_server, sizeof(settings.mqtt_server));
+    check_terminated(settings.mqtt_temp, sizeof(settings.mqtt_temp));
+    check_terminated(settings.mqtt_humidity, sizeof(settings.mqtt_humidity));
+    check_terminated(settings.mqtt_dew_point, sizeof(settings.mqtt_dew_point));
+
+    Settings loaded = settings;
+    settings_save();
+    settings_init();
+    if (strcmp(settings.mqtt_server, loaded.mqtt_server) != 0 ||
+            settings.mqtt_port != loaded.mqtt_port ||
+            strcmp(settings.mqtt_temp, loaded.mqtt_temp) != 0 ||
+            strcmp(settings.mqtt_humidity, loaded.mqtt_humidity) != 0 ||
+            strcmp(settings.mqtt_dew_point, loaded.mqtt_dew_point) != 0 ||
+            settings.debug != loaded.debug) {
+        abort();
+    }
+    return 0;
+}
@@ -0,0 +1,64 @@
+// web_post_settings(): form arguments merged into the current settings,
+// applied and saved. Aborts if the saved settings don't read back the same
+// on the next boot, or if a rejected form changed them.
+//
+// Input: the current settings as JSON, a newline, then "key=value" pairs
+// separated by '&'. Keys and values are used verbatim, as the web server
+// has already decoded them.
+
+#include <LittleFS.h>
+
+#include <string>
+
+#include "settings.h"
+
+static std::string exported() {
+    StaticJsonDocument<JSON_CAPACITY> doc;
+    settings_export(doc);
+    std::string json;
+    json.resize(measureJson(doc) + 1);
+    json.resize(serializeJson(doc, &json[0], json.size()));
+    return json;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    std::string input((const char *)data, size);
+    size_t newline = input.find('\n');
+    std::string config = input.substr(0, newline);
+    std::string args = newline == std::string::npos ? "" : input.substr(newline + 1);
+
+    StaticJsonDocument<JSON_CAPACITY> doc;
+    deserializeJson(doc, config.c_str(), config.size());
+    settings_load(doc);
+
+    std::string before = exported();
+    settings_export(doc);
+    size_t start = 0;
+    while (start < args.size()) {
+        size_t end = args.find('&', start);
+        if (end == std::string::npos) {
+            end = args.size();
+        }
+        std::string pair = args.substr(start, end - start);
+        size_t equals = pair.find('=');
+        std::string key = pair.substr(0, equals);
+        std::string value = equals == std::string::npos ? "" : pair.substr(equals + 1);
+        if (!settings_update(doc, &key[0], &value[0])) {
+            // the web server answers 400 and leaves the settings alone
+            if (exported() != before) {
+                abort();
+            }
+            return 0;
+        }
+        start = end + 1;
+    }
+    settings_load(doc);
+    settings_save();
+    std::string saved = exported();
+
+    settings_init();
+    if (exported() != saved) {
+        abort();
+    }
+    return 0;
+}
@@ -0,0 +1,164 @@
+#include <HeatPump.h>
+
+// CN105 link timing, as in the library
+#define PACKET_SENT_INTERVAL_MS 1000
+#define PACKET_INFO_INTERVAL_MS 2000
+// update() waits this long before reading the acknowledgement
+#define PACKET_ACK_WAIT_MS 1000
+// draining and decoding a buffered reply
+#define PACKET_READ_MS 5
+
+enum {
+    INFO_SETTINGS,
+    INFO_ROOM_TEMP,
+    INFO_STATUS,
+    INFO_LAST
+};
+
+static bool same(const char *lhs, const char *rhs) {
+    return lhs == rhs || (lhs && rhs && strcmp(lhs, rhs) == 0);
+}
+
+bool operator==(const heatpumpSettings &lhs, const heatpumpSettings &rhs) {
+    return same(lhs.power, rhs.power) &&
+            same(lhs.mode, rhs.mode) &&
+            lhs.temperature == rhs.temperature &&
+            same(lhs.fan, rhs.fan) &&
+            same(lhs.vane, rhs.vane) &&
+            same(lhs.wideVane, rhs.wideVane) &&
+            lhs.iSee == rhs.iSee;
+}
+
+bool operator!=(const heatpumpSettings &lhs, const heatpumpSettings &rhs) {
+    return !(lhs == rhs);
+}
+
+HeatPump::HeatPump()
+    : currentSettings{"OFF", "AUTO", 16, "AUTO", "AUTO", "|", false, false},
+      wanted(currentSettings),
+      currentStatus{0, false, {"NONE", 0, 0, 0, 0}, 0},
+      connected(false),
+      externalUpdate(false),
+      autoUpdate(true),
+      updateCount(0),
+      unit(nullptr),
+      infoMode(INFO_SETTINGS),
+      waitForRead(false),
+      lastSend(0) {
+}
+
+bool HeatPump::connect(HardwareSerial *serial) {
+    (void)serial;
+    connected = true;
+    return true;
+}
+
+void HeatPump::setSettings(heatpumpSettings settings) {
+    // the library ignores fields left unset
+    if (settings.power) wanted.power = settings.power;
+    if (settings.mode) wanted.mode = settings.mode;
+    wanted.temperature = settings.temperature;
+    if (settings.fan) wanted.fan = settings.fan;
+    if (settings.vane) wanted.vane = settings.vane;
+    if (settings.wideVane) wanted.wideVane = settings.wideVane;
+}
+
+bool HeatPump::canSend(bool isInfo) {
+    return millis() - lastSend > (isInfo ? PACKET_INFO_INTERVAL_MS : PACKET_SENT_INTERVAL_MS);
+}
+
+bool HeatPump::canRead() {
+    return waitForRead && millis() - lastSend > PACKET_SENT_INTERVAL_MS;
+}
+
+bool HeatPump::update() {
+    if (!connected) {
+        return false;
+    }
+    updateCount++;
+
+    if (!unit) {
+        receiveSettings(wanted);
+        return true;
+    }
+
+    while (!canSend(false)) {
+        delay(10);
+    }
+    // frames are small enough to go straight into the UART FIFO
+    lastSend = millis();
+    // an update frame supersedes any pending info reply
+    waitForRead = false;
+    bool ack = unit->set(wanted);
+    delay(PACKET_ACK_WAIT_MS);
+    delay(PACKET_READ_MS);
+    return ack;
+}
+
+void HeatPump::readInfo() {
+    waitForRead = false;
+    delay(PACKET_READ_MS);
+
+    heatpumpSettings settings = currentSettings;
+    heatpumpStatus status = currentStatus;
+    switch (infoMode) {
+        case INFO_SETTINGS:
+            if (unit->settings(&settings)) {
+                receiveSettings(settings);
+            }
+            break;
+        case INFO_ROOM_TEMP:
+            if (unit->roomTemperature(&status.roomTemperature)) {
+                receiveStatus(status);
+            }
+            break;
+        case INFO_STATUS:
+            if (unit->status(&status.operating, &status.compressorFrequency)) {
+                receiveStatus(status);
+            }
+            break;
+    }
+    infoMode = (infoMode + 1) % INFO_LAST;
+}
+
+void HeatPump::sync() {
+    if (!unit || !connected) {
+        return;
+    }
+
+    if (canRead()) {
+        readInfo();
+    } else if (canSend(true)) {
+        lastSend = millis();
+        waitForRead = true;
+    }
+}
+
+void HeatPump::setSettingsChangedCallback(SETTINGS_CHANGED_CALLBACK_SIGNATURE) {
+    this->settingsChangedCallback = settingsChangedCallback;
+}
+
+void HeatPump::setStatusChangedCallback(STATUS_CHANGED_CALLBACK_SIGNATURE) {
+    this->statusChangedCallback = statusChangedCallback;
+}
+
+void HeatPump::receiveSettings(heatpumpSettings settings) {
+    settings.connected = true;
+    if (settings != currentSettings) {
+        currentSettings = settings;
+        if (settingsChangedCallback) {
+            settingsChangedCallback();
+        }
+    }
+}
+
+void HeatPump::receiveStatus(heatpumpStatus status) {
+    if (status.roomTemperature != currentStatus.roomTemperature ||
+            status.operating != currentStatus.operating ||
+            status.compressorFrequency != currentStatus.compressorFrequency) {
+        currentStatus = status;
+        if (statusChangedCallback) {
+            statusChangedCallback(status);
+        }
+    }
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+// Host replacement for SwiCago/HeatPump with the same public types and the
+// subset of the API used by the firmware.
+//
+// Without an attached unit there is no CN105 link: settings passed to
+// update() are applied immediately and the harness injects what the indoor
+// unit reports with receiveSettings() and receiveStatus().
+//
+// With a HeatPumpUnit attached the library's link timing is reproduced on
+// the virtual clock: update() waits for the send interval, writes the frame
+// and blocks for the acknowledgement; sync() alternates between sending an
+// info request and reading the reply, cycling through settings, room
+// temperature and operating status.
+
+#include <Arduino.h>
+
+#include <functional>
+
+struct heatpumpSettings {
+    const char *power;
+    const char *mode;
+    float temperature;
+    const char *fan;
+    const char *vane;
+    const char *wideVane;
+    bool iSee;
+    bool connected;
+};
+
+bool operator==(const heatpumpSettings &lhs, const heatpumpSettings &rhs);
+bool operator!=(const heatpumpSettings &lhs, const heatpumpSettings &rhs);
+
+struct heatpumpTimers {
+    const char *mode;
+    int onMinutesSet;
+    int onMinutesRemaining;
+    int offMinutesSet;
+    int offMinutesRemaining;
+};
+
+struct heatpumpStatus {
+    float roomTemperature;
+    bool operating;
+    heatpumpTimers timers;
+    int compressorFrequency;
+};
+
+// host harness: the indoor unit on the other end of the CN105 link
+class HeatPumpUnit {
+public:
+    virtual ~HeatPumpUnit() {}
+
+    // a settings frame was received, false if it is not acknowledged
+    virtual bool set(const heatpumpSettings &settings) = 0;
+    // answer info requests, false if the unit doesn't reply
+    virtual bool settings(heatpumpSettings *settings) = 0;
+    virtual bool roomTemperature(float *temperature) = 0;
+    virtual bool status(bool *operating, int *compressorFrequency) = 0;
+};
+
+#define SETTINGS_CHANGED_CALLBACK_SIGNATURE std::function<void()> settingsChangedCallback
+#define STATUS_CHANGED_CALLBACK_SIGNATURE std::function<void(heatpumpStatus newStatus)> statusChangedCallback
+
+class HeatPump {
+public:
+    HeatPump();
+
+    bool connect(HardwareSerial *serial);
+    bool update();
+    void sync();
+    bool isConnected() { return connected; }
+
+    void enableExternalUpdate() { externalUpdate = true; }
+    void disableExternalUpdate() { externalUpdate = false; }
+    void enableAutoUpdate() { autoUpdate = true; }
+    void disableAutoUpdate() { autoUpdate = false; }
+
+    heatpumpSettings getSettings() { return currentSettings; }
+    void setSettings(heatpumpSettings settings);
+    bool getPowerSettingBool() { return strcmp(currentSettings.power, "ON") == 0; }
+    const char *getPowerSetting() { return currentSettings.power; }
+    const char *getModeSetting() { return currentSettings.mode; }
+    float getTemperature() { return currentSettings.temperature; }
+    const char *getFanSpeed() { return currentSettings.fan; }
+
+    heatpumpStatus getStatus() { return currentStatus; }
+    float getRoomTemperature() { return currentStatus.roomTemperature; }
+    bool getOperating() { return currentStatus.operating; }
+
+    void setSettingsChangedCallback(SETTINGS_CHANGED_CALLBACK_SIGNATURE);
+    void setStatusChangedCallback(STATUS_CHANGED_CALLBACK_SIGNATURE);
+
+    // host harness: the indoor unit reported new settings or status
+    void receiveSettings(heatpumpSettings settings);
+    void receiveStatus(heatpumpStatus status);
+    void setConnected(bool value) { connected = value; }
+    void attach(HeatPumpUnit *unit) { this->unit = unit; }
+
+    // host harness: number of update() calls that sent a settings frame
+    unsigned long updates() const { return updateCount; }
+    heatpumpSettings wantedSettings() const { return wanted; }
+
+private:
+    heatpumpSettings currentSettings;
+    heatpumpSettings wanted;
+    heatpumpStatus currentStatus;
+    bool connected;
+    bool externalUpdate;
+    bool autoUpdate;
+    unsigned long updateCount;
+
+    HeatPumpUnit *unit;
+    int infoMode;
+    bool waitForRead;
+    unsigned long lastSend;
+
+    bool canSend(bool isInfo);
+    bool canRead();
+    void readInfo();
+
+    std::function<void()> settingsChangedCallback;
+    std::function<void(heatpumpStatus)> statusChangedCallback;
+};
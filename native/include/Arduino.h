@@ -0,0 +1,91 @@
+#pragma once
+
+// Minimal Arduino core replacement for host builds. Only what the firmware
+// sources compiled in the native environments actually use is provided.
+// Time is virtual: millis() returns the clock advanced by native_advance()
+// and delay().
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+#define F(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define strncpy_P strncpy
+#define strlen_P strlen
+#define memcpy_P memcpy
+#define snprintf_P snprintf
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define LED_BUILTIN 2
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+size_t strlcpy(char *dst, const char *src, size_t size);
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void yield(void);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+
+// host harness: advance the virtual clock, firing due tickers including the
+// scheduled ones; delay() only fires plain tickers
+void native_advance(unsigned long ms);
+
+#ifdef __cplusplus
+}
+
+#include <algorithm>
+
+void setup(void);
+void loop(void);
+
+using std::max;
+using std::min;
+
+class Stream {
+public:
+    virtual ~Stream() {}
+    virtual size_t write(const uint8_t *buffer, size_t size) = 0;
+};
+
+#include <HardwareSerial.h>
+#include <user_interface.h>
+
+class EspClass {
+public:
+    uint32_t getChipId() { return 0x00c0ffee & 0xffffff; }
+    uint32_t getFreeHeap() { return 40000; }
+    uint32_t getMaxFreeBlockSize() { return 30000; }
+    uint8_t getHeapFragmentation() { return 5; }
+    uint32_t getFreeContStack() { return 2048; }
+    void resetFreeContStack() {}
+    uint32_t getCycleCount();
+    uint8_t getCpuFreqMHz() { return 160; }
+    // 512 bytes, kept for the lifetime of the process; offset in 4 byte blocks
+    bool rtcUserMemoryRead(uint32_t offset, uint32_t *data, size_t size);
+    bool rtcUserMemoryWrite(uint32_t offset, uint32_t *data, size_t size);
+    rst_info *getResetInfoPtr();
+    void restart() { exit(0); }
+};
+
+extern EspClass ESP;
+#endif
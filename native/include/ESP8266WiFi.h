@@ -0,0 +1,127 @@
+#pragma once
+
+// Host replacement for the ESP8266 WiFi client and server. Connections are
+// in-memory pipes: the harness opens one with WiFiServer::connect(), writes
+// the request into its input and reads what the firmware sent from its
+// output. The send window limits how much the firmware can write before the
+// harness drains the output, like the TCP send buffer. Addresses are real
+// ones, so WiFiUDP can send to a socket the harness listens on.
+
+#include <Arduino.h>
+
+#include <deque>
+#include <memory>
+#include <string>
+
+class IPAddress {
+public:
+    IPAddress() {}
+    explicit IPAddress(uint32_t address) : address(address) {}
+
+    // dotted quad only, like the core
+    bool fromString(const char *str);
+    operator uint32_t() const { return address; }
+
+private:
+    // network byte order
+    uint32_t address = 0;
+};
+
+class ESP8266WiFiClass {
+public:
+    bool isConnected() { return connected; }
+    int hostByName(const char *name, IPAddress &result);
+
+    // host harness
+    bool connected = true;
+};
+
+extern ESP8266WiFiClass WiFi;
+
+struct native_socket_t {
+    std::string input;
+    size_t read = 0;
+    std::string output;
+    size_t window = 2920;
+    // the peer hung up
+    bool hung_up = false;
+    // the firmware closed the connection
+    bool closed = false;
+};
+
+class WiFiClient {
+public:
+    WiFiClient() {}
+    explicit WiFiClient(std::shared_ptr<native_socket_t> socket) : socket(socket) {}
+
+    explicit operator bool() const { return socket != nullptr; }
+
+    uint8_t connected() { return socket && !socket->closed && (!socket->hung_up || available()); }
+    int available() { return socket && !socket->closed ? (int)(socket->input.size() - socket->read) : 0; }
+    int read(uint8_t *buffer, size_t size) {
+        size_t n = min(size, (size_t)available());
+        if (n) {
+            memcpy(buffer, socket->input.data() + socket->read, n);
+            socket->read += n;
+        }
+        return n;
+    }
+    int read() {
+        uint8_t c;
+        return read(&c, 1) ? c : -1;
+    }
+
+    size_t availableForWrite() {
+        if (!socket || socket->closed || socket->hung_up) {
+            return 0;
+        }
+        return socket->window > socket->output.size() ? socket->window - socket->output.size() : 0;
+    }
+    size_t write(const uint8_t *buffer, size_t size) {
+        size_t n = min(size, availableForWrite());
+        if (n) {
+            socket->output.append((const char *)buffer, n);
+        }
+        return n;
+    }
+    size_t write(const char *buffer, size_t size) { return write((const uint8_t *)buffer, size); }
+    size_t write_P(PGM_P buffer, size_t size) { return write(buffer, size); }
+
+    void setNoDelay(bool nodelay) { (void)nodelay; }
+    void stop() {
+        if (socket) {
+            socket->closed = true;
+        }
+    }
+
+private:
+    std::shared_ptr<native_socket_t> socket;
+};
+
+class WiFiServer {
+public:
+    explicit WiFiServer(uint16_t port) { (void)port; }
+    void begin() {}
+
+    WiFiClient available() {
+        if (pending().empty()) {
+            return WiFiClient();
+        }
+        WiFiClient client(pending().front());
+        pending().pop_front();
+        return client;
+    }
+
+    // harness: a new connection to whichever server accepts next
+    static std::shared_ptr<native_socket_t> connect() {
+        auto socket = std::make_shared<native_socket_t>();
+        pending().push_back(socket);
+        return socket;
+    }
+
+private:
+    static std::deque<std::shared_ptr<native_socket_t>> &pending() {
+        static std::deque<std::shared_ptr<native_socket_t>> sockets;
+        return sockets;
+    }
+};
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <stdint.h>
+
+class MDNSResponder {
+public:
+    bool begin(const char *) { return true; }
+    bool addService(const char *, const char *, uint16_t) { return true; }
+    bool announce() { return true; }
+};
+
+extern MDNSResponder MDNS;
@@ -0,0 +1,50 @@
+#pragma once
+
+// Host replacement for the ESP8266 UART. Output is discarded; input comes
+// from a buffer supplied by the harness with feed().
+
+#include <Arduino.h>
+
+enum SerialConfig {
+    SERIAL_8N1,
+    SERIAL_8E1
+};
+
+class HardwareSerial {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void begin(unsigned long baud, SerialConfig config) {
+        (void)baud;
+        (void)config;
+    }
+    void end() {}
+    void flush() {}
+
+    int available() { return (int)(rxSize - rxPos); }
+    int read() { return rxPos < rxSize ? rxData[rxPos++] : -1; }
+    int peek() { return rxPos < rxSize ? rxData[rxPos] : -1; }
+
+    size_t write(uint8_t c) {
+        (void)c;
+        return 1;
+    }
+    size_t write(const uint8_t *buffer, size_t size) {
+        (void)buffer;
+        return size;
+    }
+    size_t println(const char *s = "") { return s ? strlen(s) : 0; }
+
+    // host harness: bytes to return from read(), not copied
+    void feed(const uint8_t *data, size_t size) {
+        rxData = data;
+        rxSize = size;
+        rxPos = 0;
+    }
+
+private:
+    const uint8_t *rxData = nullptr;
+    size_t rxSize = 0;
+    size_t rxPos = 0;
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,96 @@
+#pragma once
+
+// Host replacement for LittleFS: files live in memory for the lifetime of
+// the process. Only the calls made by the firmware are provided.
+
+#include <Arduino.h>
+
+#include <map>
+#include <memory>
+#include <string>
+
+class File {
+public:
+    File() {}
+    File(std::shared_ptr<std::string> data, bool append) : data(data), pos(append ? data->size() : 0) {}
+
+    operator bool() const { return data != nullptr; }
+
+    size_t size() const { return data ? data->size() : 0; }
+    size_t position() const { return pos; }
+    bool seek(uint32_t position) {
+        if (!data || position > data->size()) {
+            return false;
+        }
+        pos = position;
+        return true;
+    }
+
+    int available() { return data ? (int)(data->size() - pos) : 0; }
+    int read() { return available() > 0 ? (uint8_t)(*data)[pos++] : -1; }
+    int peek() { return available() > 0 ? (uint8_t)(*data)[pos] : -1; }
+    size_t read(uint8_t *buffer, size_t size) { return readBytes((char *)buffer, size); }
+    size_t readBytes(char *buffer, size_t size) {
+        size_t n = min(size, (size_t)available());
+        if (n) {
+            memcpy(buffer, data->data() + pos, n);
+            pos += n;
+        }
+        return n;
+    }
+
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+    size_t write(const uint8_t *buffer, size_t size) {
+        if (!data) {
+            return 0;
+        }
+        data->replace(pos, min(size, data->size() - pos), (const char *)buffer, size);
+        pos += size;
+        return size;
+    }
+
+    void flush() {}
+    void close() { data = nullptr; }
+
+private:
+    std::shared_ptr<std::string> data;
+    size_t pos = 0;
+};
+
+class FS {
+public:
+    bool begin() { return true; }
+    void end() {}
+    bool format() {
+        files.clear();
+        return true;
+    }
+
+    File open(const char *path, const char *mode) {
+        auto it = files.find(path);
+        if (mode[0] == 'r') {
+            return it == files.end() ? File() : File(it->second, false);
+        }
+        if (it == files.end() || mode[0] == 'w') {
+            files[path] = std::make_shared<std::string>();
+        }
+        return File(files[path], mode[0] == 'a');
+    }
+    bool exists(const char *path) { return files.count(path) > 0; }
+    bool remove(const char *path) { return files.erase(path) > 0; }
+    bool rename(const char *from, const char *to) {
+        auto it = files.find(from);
+        if (it == files.end()) {
+            return false;
+        }
+        files[to] = it->second;
+        files.erase(from);
+        return true;
+    }
+
+private:
+    std::map<std::string, std::shared_ptr<std::string>> files;
+};
+
+extern FS LittleFS;
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <functional>
+
+// Host replacement for the ESP8266 Ticker. Callbacks never run
+// asynchronously, they fire when the virtual clock reaches their deadline:
+// plain tickers at any point, including inside delay(), like the timer
+// interrupt on the device; *_scheduled tickers only from native_advance(),
+// which the harness calls between loop() iterations, like the scheduled
+// function queue on the device.
+
+class Ticker {
+public:
+    typedef std::function<void(void)> callback_function_t;
+
+    Ticker();
+    ~Ticker();
+
+    void attach_scheduled(float seconds, callback_function_t callback) {
+        _arm(seconds * 1000, true, true, callback);
+    }
+    void attach(float seconds, callback_function_t callback) {
+        _arm(seconds * 1000, true, false, callback);
+    }
+    void attach_ms_scheduled(uint32_t milliseconds, callback_function_t callback) {
+        _arm(milliseconds, true, true, callback);
+    }
+    void attach_ms(uint32_t milliseconds, callback_function_t callback) {
+        _arm(milliseconds, true, false, callback);
+    }
+    void once_scheduled(float seconds, callback_function_t callback) {
+        _arm(seconds * 1000, false, true, callback);
+    }
+    void once(float seconds, callback_function_t callback) {
+        _arm(seconds * 1000, false, false, callback);
+    }
+    void once_ms_scheduled(uint32_t milliseconds, callback_function_t callback) {
+        _arm(milliseconds, false, true, callback);
+    }
+    void once_ms(uint32_t milliseconds, callback_function_t callback) {
+        _arm(milliseconds, false, false, callback);
+    }
+
+    void detach();
+    bool active() const { return _active; }
+
+    // fire every ticker whose deadline is at or before now, scheduled ones
+    // only when requested
+    static void run_due(unsigned long now, bool scheduled);
+    // earliest deadline among active tickers, false if none is armed
+    static bool next_deadline(unsigned long *deadline, bool scheduled);
+
+private:
+    void _arm(uint32_t milliseconds, bool repeat, bool scheduled, callback_function_t callback);
+
+    Ticker *_next;
+    callback_function_t _callback;
+    unsigned long _deadline;
+    uint32_t _interval;
+    bool _repeat;
+    bool _scheduled;
+    bool _active;
+};
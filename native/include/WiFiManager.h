@@ -0,0 +1,6 @@
+#pragma once
+
+class WiFiManager {
+public:
+    void resetSettings() {}
+};
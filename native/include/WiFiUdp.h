@@ -0,0 +1,24 @@
+#pragma once
+
+// Host replacement for the ESP8266 UDP client: a packet is built in memory
+// and sent with a real socket, so a harness can receive it on the loopback.
+
+#include <ESP8266WiFi.h>
+
+#include <string>
+
+class WiFiUDP {
+public:
+    ~WiFiUDP();
+
+    int beginPacket(IPAddress ip, uint16_t port);
+    size_t write(const uint8_t *buffer, size_t size);
+    int endPacket();
+
+private:
+    int fd = -1;
+    IPAddress ip;
+    uint16_t port = 0;
+    std::string packet;
+    bool started = false;
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+// Host replacement for the Arduino-HomeKit-ESP8266 server entry points. The
+// accessory is always paired and no HAP traffic is generated.
+
+#include <homekit/homekit.h>
+#include <homekit/types.h>
+
+typedef struct {
+    homekit_server_config_t *config;
+    bool paired;
+} homekit_server_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void arduino_homekit_setup(homekit_server_config_t *config);
+void arduino_homekit_loop();
+homekit_server_t *arduino_homekit_get_running_server();
+int arduino_homekit_connected_clients_count();
+
+// host harness: called from arduino_homekit_loop(), where the server would
+// process requests and run characteristic setters
+void arduino_homekit_set_controller(void (*controller)());
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,138 @@
+#pragma once
+
+// Subset of the esp-homekit characteristic and service catalogue used by
+// src/accessory.c, with the same declaration macros.
+
+#include <homekit/types.h>
+
+#define HOMEKIT_SERVICE_ACCESSORY_INFORMATION "3E"
+#define HOMEKIT_SERVICE_FAN2 "B7"
+#define HOMEKIT_SERVICE_HUMIDIFIER_DEHUMIDIFIER "BD"
+#define HOMEKIT_SERVICE_LIGHTBULB "43"
+#define HOMEKIT_SERVICE_THERMOSTAT "4A"
+
+#define HOMEKIT_CHARACTERISTIC_ACTIVE "B0"
+#define HOMEKIT_CHARACTERISTIC_CURRENT_FAN_STATE "AF"
+#define HOMEKIT_CHARACTERISTIC_CURRENT_HEATING_COOLING_STATE "F"
+#define HOMEKIT_CHARACTERISTIC_CURRENT_HUMIDIFIER_DEHUMIDIFIER_STATE "B3"
+#define HOMEKIT_CHARACTERISTIC_CURRENT_RELATIVE_HUMIDITY "10"
+#define HOMEKIT_CHARACTERISTIC_CURRENT_TEMPERATURE "11"
+#define HOMEKIT_CHARACTERISTIC_FIRMWARE_REVISION "52"
+#define HOMEKIT_CHARACTERISTIC_IDENTIFY "14"
+#define HOMEKIT_CHARACTERISTIC_MANUFACTURER "20"
+#define HOMEKIT_CHARACTERISTIC_MODEL "21"
+#define HOMEKIT_CHARACTERISTIC_NAME "23"
+#define HOMEKIT_CHARACTERISTIC_ON "25"
+#define HOMEKIT_CHARACTERISTIC_ROTATION_SPEED "29"
+#define HOMEKIT_CHARACTERISTIC_SERIAL_NUMBER "30"
+#define HOMEKIT_CHARACTERISTIC_SWING_MODE "B6"
+#define HOMEKIT_CHARACTERISTIC_TARGET_FAN_STATE "BF"
+#define HOMEKIT_CHARACTERISTIC_TARGET_HEATING_COOLING_STATE "33"
+#define HOMEKIT_CHARACTERISTIC_TARGET_HUMIDIFIER_DEHUMIDIFIER_STATE "B4"
+#define HOMEKIT_CHARACTERISTIC_TARGET_TEMPERATURE "35"
+#define HOMEKIT_CHARACTERISTIC_TEMPERATURE_DISPLAY_UNITS "36"
+
+#define HOMEKIT_CURRENT_HEATING_COOLING_STATE_OFF 0
+#define HOMEKIT_CURRENT_HEATING_COOLING_STATE_HEAT 1
+#define HOMEKIT_CURRENT_HEATING_COOLING_STATE_COOL 2
+
+#define HOMEKIT_TARGET_HEATING_COOLING_STATE_OFF 0
+#define HOMEKIT_TARGET_HEATING_COOLING_STATE_HEAT 1
+#define HOMEKIT_TARGET_HEATING_COOLING_STATE_COOL 2
+#define HOMEKIT_TARGET_HEATING_COOLING_STATE_AUTO 3
+
+#define HOMEKIT_DECLARE_CHARACTERISTIC_STRING_(_type, _description, _value, ...) \
+    .type = _type, \
+    .description = _description, \
+    .format = homekit_format_string, \
+    .permissions = homekit_permissions_paired_read, \
+    .value = HOMEKIT_STRING_(_value), \
+    ##__VA_ARGS__
+
+#define HOMEKIT_DECLARE_CHARACTERISTIC_UINT8_(_type, _description, _value, ...) \
+    .type = _type, \
+    .description = _description, \
+    .format = homekit_format_uint8, \
+    .permissions = homekit_permissions_paired_read \
+                | homekit_permissions_paired_write \
+                | homekit_permissions_notify, \
+    .value = HOMEKIT_UINT8_(_value), \
+    ##__VA_ARGS__
+
+#define HOMEKIT_DECLARE_CHARACTERISTIC_FLOAT_(_type, _description, _unit, _value, ...) \
+    .type = _type, \
+    .description = _description, \
+    .format = homekit_format_float, \
+    .unit = _unit, \
+    .permissions = homekit_permissions_paired_read \
+                | homekit_permissions_paired_write \
+                | homekit_permissions_notify, \
+    .value = HOMEKIT_FLOAT_(_value), \
+    ##__VA_ARGS__
+
+#define HOMEKIT_DECLARE_CHARACTERISTIC_NAME(_value, ...) \
+    HOMEKIT_DECLARE_CHARACTERISTIC_STRING_(HOMEKIT_CHARACTERISTIC_NAME, "Name", _value, ##__VA_ARGS__)
+#define HOMEKIT_DECLARE_CHARACTERISTIC_SERIAL_NUMBER(_value, ...) \
+    HOMEKIT_DECLARE_CHARACTERISTIC_STRING_(HOMEKIT_CHARACTERISTIC_SERIAL_NUMBER, "Serial Number", _value, ##__VA_ARGS__)
+#define HOMEKIT_DECLARE_CHARACTERISTIC_MANUFACTURER(_value, ...) \
+    HOMEKIT_DECLARE_CHARACTERISTIC_STRING_(HOMEKIT_CHARACTERISTIC_MANUFACTURER, "Manufacturer", _value, ##__VA_ARGS__)
+#define HOMEKIT_DECLARE_CHARACTERISTIC_MODEL(_value, ...) \
+    HOMEKIT_DECLARE_CHARACTERISTIC_STRING_(HOMEKIT_CHARACTERISTIC_MODEL, "Model", _value, ##__VA_ARGS__)
+#define HOMEKIT_DECLARE_CHARACTERISTIC_FIRMWARE_REVISION(_value, ...) \
+    HOMEKIT_DECLARE_CHARACTERISTIC_STRING_(HOMEKIT_CHARACTERISTIC_FIRMWARE_REVISION, "Firmware Revision", _value, ##__VA_ARGS__)
+
+#define HOMEKIT_DECLARE_CHARACTERISTIC_IDENTIFY(_callback) \
+    .type = HOMEKIT_CHARACTERISTIC_IDENTIFY, \
+    .description = "Identify", \
+    .format = homekit_format_bool, \
+    .permissions = homekit_permissions_paired_write, \
+    .setter = _callback
+
+#define HOMEKIT_DECLARE_CHARACTERISTIC_ON(_value, ...) \
+    .type = HOMEKIT_CHARACTERISTIC_ON, \
+    .description = "On", \
+    .format = homekit_format_bool, \
+    .permissions = homekit_permissions_paired_read \
+                | homekit_permissions_paired_write \
+                | homekit_permissions_notify, \
+    .value = HOMEKIT_BOOL_(_value), \
+    ##__VA_ARGS__
+
+#define HOMEKIT_DECLARE_CHARACTERISTIC_ACTIVE(_value, ...) \
+    HOMEKIT_DECLARE_CHARACTERISTIC_UINT8_(HOMEKIT_CHARACTERISTIC_ACTIVE, "Active", _value, ##__VA_ARGS__)
+#define HOMEKIT_DECLARE_CHARACTERISTIC_SWING_MODE(_value, ...) \
+    HOMEKIT_DECLARE_CHARACTERISTIC_UINT8_(HOMEKIT_CHARACTERISTIC_SWING_MODE, "Swing Mode", _value, ##__VA_ARGS__)
+#define HOMEKIT_DECLARE_CHARACTERISTIC_CURRENT_HEATING_COOLING_STATE(_value, ...) \
+    HOMEKIT_DECLARE_CHARACTERISTIC_UINT8_(HOMEKIT_CHARACTERISTIC_CURRENT_HEATING_COOLING_STATE, \
+            "Current Heating Cooling State", _value, ##__VA_ARGS__)
+#define HOMEKIT_DECLARE_CHARACTERISTIC_TARGET_HEATING_COOLING_STATE(_value, ...) \
+    HOMEKIT_DECLARE_CHARACTERISTIC_UINT8_(HOMEKIT_CHARACTERISTIC_TARGET_HEATING_COOLING_STATE, \
+            "Target Heating Cooling State", _value, ##__VA_ARGS__)
+#define HOMEKIT_DECLARE_CHARACTERISTIC_TEMPERATURE_DISPLAY_UNITS(_value, ...) \
+    HOMEKIT_DECLARE_CHARACTERISTIC_UINT8_(HOMEKIT_CHARACTERISTIC_TEMPERATURE_DISPLAY_UNITS, \
+            "Temperature Display Units", _value, ##__VA_ARGS__)
+#define HOMEKIT_DECLARE_CHARACTERISTIC_CURRENT_HUMIDIFIER_DEHUMIDIFIER_STATE(_value, ...) \
+    HOMEKIT_DECLARE_CHARACTERISTIC_UINT8_(HOMEKIT_CHARACTERISTIC_CURRENT_HUMIDIFIER_DEHUMIDIFIER_STATE, \
+            "Current Humidifier-Dehumidifier State", _value, ##__VA_ARGS__)
+#define HOMEKIT_DECLARE_CHARACTERISTIC_TARGET_HUMIDIFIER_DEHUMIDIFIER_STATE(_value, ...) \
+    HOMEKIT_DECLARE_CHARACTERISTIC_UINT8_(HOMEKIT_CHARACTERISTIC_TARGET_HUMIDIFIER_DEHUMIDIFIER_STATE, \
+            "Target Humidifier-Dehumidifier State", _value, ##__VA_ARGS__)
+#define HOMEKIT_DECLARE_CHARACTERISTIC_CURRENT_FAN_STATE(_value, ...) \
+    HOMEKIT_DECLARE_CHARACTERISTIC_UINT8_(HOMEKIT_CHARACTERISTIC_CURRENT_FAN_STATE, \
+            "Current Fan State", _value, ##__VA_ARGS__)
+#define HOMEKIT_DECLARE_CHARACTERISTIC_TARGET_FAN_STATE(_value, ...) \
+    HOMEKIT_DECLARE_CHARACTERISTIC_UINT8_(HOMEKIT_CHARACTERISTIC_TARGET_FAN_STATE, \
+            "Target Fan State", _value, ##__VA_ARGS__)
+
+#define HOMEKIT_DECLARE_CHARACTERISTIC_CURRENT_TEMPERATURE(_value, ...) \
+    HOMEKIT_DECLARE_CHARACTERISTIC_FLOAT_(HOMEKIT_CHARACTERISTIC_CURRENT_TEMPERATURE, \
+            "Current Temperature", homekit_unit_celsius, _value, ##__VA_ARGS__)
+#define HOMEKIT_DECLARE_CHARACTERISTIC_TARGET_TEMPERATURE(_value, ...) \
+    HOMEKIT_DECLARE_CHARACTERISTIC_FLOAT_(HOMEKIT_CHARACTERISTIC_TARGET_TEMPERATURE, \
+            "Target Temperature", homekit_unit_celsius, _value, ##__VA_ARGS__)
+#define HOMEKIT_DECLARE_CHARACTERISTIC_CURRENT_RELATIVE_HUMIDITY(_value, ...) \
+    HOMEKIT_DECLARE_CHARACTERISTIC_FLOAT_(HOMEKIT_CHARACTERISTIC_CURRENT_RELATIVE_HUMIDITY, \
+            "Current Relative Humidity", homekit_unit_percentage, _value, ##__VA_ARGS__)
+#define HOMEKIT_DECLARE_CHARACTERISTIC_ROTATION_SPEED(_value, ...) \
+    HOMEKIT_DECLARE_CHARACTERISTIC_FLOAT_(HOMEKIT_CHARACTERISTIC_ROTATION_SPEED, \
+            "Rotation Speed", homekit_unit_percentage, _value, ##__VA_ARGS__)
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <homekit/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void homekit_characteristic_notify(homekit_characteristic_t *ch, const homekit_value_t value);
+bool homekit_is_paired();
+int homekit_storage_reset();
+void homekit_update_config_number();
+
+// host harness: notifications sent since start, in total or for one
+// characteristic
+unsigned long homekit_notify_count();
+unsigned long homekit_characteristic_notify_count(const homekit_characteristic_t *ch);
+
+#ifdef __cplusplus
+}
+#endif
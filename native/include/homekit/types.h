@@ -0,0 +1,171 @@
+#pragma once
+
+// Host replacement for the esp-homekit types used by the accessory
+// definition. Field names and initializer macros match the library so
+// src/accessory.c compiles unchanged; server-side fields are omitted.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    homekit_format_bool,
+    homekit_format_uint8,
+    homekit_format_uint16,
+    homekit_format_uint32,
+    homekit_format_uint64,
+    homekit_format_int,
+    homekit_format_float,
+    homekit_format_string,
+    homekit_format_tlv,
+    homekit_format_data
+} homekit_format_t;
+
+typedef enum {
+    homekit_unit_none,
+    homekit_unit_celsius,
+    homekit_unit_percentage,
+    homekit_unit_arcdegrees,
+    homekit_unit_lux,
+    homekit_unit_seconds
+} homekit_unit_t;
+
+typedef enum {
+    homekit_permissions_paired_read = 1,
+    homekit_permissions_paired_write = 2,
+    homekit_permissions_notify = 4,
+    homekit_permissions_additional_authorization = 8,
+    homekit_permissions_timed_write = 16,
+    homekit_permissions_hidden = 32
+} homekit_permissions_t;
+
+typedef enum {
+    homekit_accessory_category_other = 1,
+    homekit_accessory_category_thermostat = 9,
+    homekit_accessory_category_fan = 3,
+    homekit_accessory_category_air_conditioner = 21,
+    homekit_accessory_category_dehumidifier = 23
+} homekit_accessory_category_t;
+
+typedef struct {
+    bool is_null;
+    bool is_static;
+    homekit_format_t format;
+    union {
+        bool bool_value;
+        int int_value;
+        uint8_t uint8_value;
+        uint16_t uint16_value;
+        uint32_t uint32_value;
+        uint64_t uint64_value;
+        float float_value;
+        char *string_value;
+    };
+} homekit_value_t;
+
+typedef struct {
+    int count;
+    uint8_t *values;
+} homekit_valid_values_t;
+
+typedef struct _homekit_characteristic homekit_characteristic_t;
+typedef struct _homekit_service homekit_service_t;
+typedef struct _homekit_accessory homekit_accessory_t;
+
+struct _homekit_characteristic {
+    homekit_service_t *service;
+
+    unsigned int id;
+    const char *type;
+    const char *description;
+    homekit_format_t format;
+    homekit_unit_t unit;
+    homekit_permissions_t permissions;
+    homekit_value_t value;
+
+    float *min_value;
+    float *max_value;
+    float *min_step;
+    int *max_len;
+    int *max_data_len;
+
+    homekit_valid_values_t valid_values;
+
+    homekit_value_t (*getter)();
+    void (*setter)(const homekit_value_t);
+};
+
+struct _homekit_service {
+    homekit_accessory_t *accessory;
+
+    unsigned int id;
+    const char *type;
+    bool hidden;
+    bool primary;
+
+    homekit_service_t **linked;
+    homekit_characteristic_t **characteristics;
+};
+
+struct _homekit_accessory {
+    unsigned int id;
+
+    homekit_accessory_category_t category;
+    int config_number;
+
+    homekit_service_t **services;
+};
+
+typedef struct {
+    homekit_accessory_t **accessories;
+    homekit_accessory_category_t category;
+    char *password;
+    char *setupId;
+} homekit_server_config_t;
+
+#define HOMEKIT_BOOL_(x, ...) {.format = homekit_format_bool, .bool_value = (x), ##__VA_ARGS__}
+#define HOMEKIT_UINT8_(x, ...) {.format = homekit_format_uint8, .uint8_value = (x), ##__VA_ARGS__}
+#define HOMEKIT_INT_(x, ...) {.format = homekit_format_int, .int_value = (x), ##__VA_ARGS__}
+#define HOMEKIT_FLOAT_(x, ...) {.format = homekit_format_float, .float_value = (x), ##__VA_ARGS__}
+#define HOMEKIT_STRING_(x, ...) {.format = homekit_format_string, .string_value = (char *)(x), ##__VA_ARGS__}
+
+#ifdef __cplusplus
+static inline homekit_value_t homekit_value_cpp(homekit_format_t format) {
+    homekit_value_t v = {};
+    v.format = format;
+    return v;
+}
+
+static inline homekit_value_t HOMEKIT_BOOL_CPP(bool x) {
+    homekit_value_t v = homekit_value_cpp(homekit_format_bool);
+    v.bool_value = x;
+    return v;
+}
+
+static inline homekit_value_t HOMEKIT_UINT8_CPP(uint8_t x) {
+    homekit_value_t v = homekit_value_cpp(homekit_format_uint8);
+    v.uint8_value = x;
+    return v;
+}
+
+static inline homekit_value_t HOMEKIT_FLOAT_CPP(float x) {
+    homekit_value_t v = homekit_value_cpp(homekit_format_float);
+    v.float_value = x;
+    return v;
+}
+
+static inline homekit_value_t HOMEKIT_STRING_CPP(char *x) {
+    homekit_value_t v = homekit_value_cpp(homekit_format_string);
+    v.string_value = x;
+    return v;
+}
+#endif
+
+#define HOMEKIT_SERVICE_(_type, ...) {.type = HOMEKIT_SERVICE_##_type, ##__VA_ARGS__}
+#define HOMEKIT_SERVICE(_type, ...) &(homekit_service_t) HOMEKIT_SERVICE_(_type, ##__VA_ARGS__)
+
+#define HOMEKIT_ACCESSORY_(...) {.config_number = 1, ##__VA_ARGS__}
+#define HOMEKIT_ACCESSORY(...) &(homekit_accessory_t) HOMEKIT_ACCESSORY_(__VA_ARGS__)
+
+#define HOMEKIT_CHARACTERISTIC_(name, ...) {HOMEKIT_DECLARE_CHARACTERISTIC_##name(__VA_ARGS__)}
+#define HOMEKIT_CHARACTERISTIC(name, ...) &(homekit_characteristic_t) HOMEKIT_CHARACTERISTIC_(name, ##__VA_ARGS__)
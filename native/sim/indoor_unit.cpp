@@ -0,0 +1,91 @@
+#include "indoor_unit.h"
+
+#define SETTINGS_APPLY_MS 2000
+
+// degrees per minute
+#define DRIFT_RATE 0.1
+#define CONDITIONING_RATE 0.5
+
+#define HYSTERESIS 0.5
+
+IndoorUnit::IndoorUnit(float ambient)
+    : current{"OFF", "AUTO", 22, "AUTO", "AUTO", "|", false, true},
+      pending(current),
+      hasPending(false),
+      applyAt(0),
+      ambient(ambient),
+      room(ambient),
+      operating(false),
+      compressor(0),
+      lastAdvance(0),
+      setFrames(0) {
+}
+
+void IndoorUnit::advance() {
+    unsigned long now = millis();
+    if (hasPending && (long)(now - applyAt) >= 0) {
+        current = pending;
+        hasPending = false;
+    }
+
+    float minutes = (now - lastAdvance) / 60000.0;
+    lastAdvance = now;
+
+    bool on = strcmp(current.power, "ON") == 0;
+    bool heat = on && (strcmp(current.mode, "HEAT") == 0 || strcmp(current.mode, "AUTO") == 0);
+    bool cool = on && (strcmp(current.mode, "COOL") == 0 || strcmp(current.mode, "AUTO") == 0 ||
+            strcmp(current.mode, "DRY") == 0);
+
+    float error = current.temperature - room;
+    if (operating) {
+        operating = (heat && error > 0) || (cool && error < 0);
+    } else {
+        operating = (heat && error > HYSTERESIS) || (cool && error < -HYSTERESIS);
+    }
+
+    if (operating) {
+        float step = CONDITIONING_RATE * minutes;
+        room += error > 0 ? fminf(step, error) : fmaxf(-step, error);
+        compressor = (int)fminf(20 + 20 * fabsf(error), 80);
+    } else {
+        float drift = ambient - room;
+        float step = DRIFT_RATE * minutes;
+        room += drift > 0 ? fminf(step, drift) : fmaxf(-step, drift);
+        compressor = 0;
+    }
+}
+
+bool IndoorUnit::set(const heatpumpSettings &settings) {
+    advance();
+    setFrames++;
+    pending = hasPending ? pending : current;
+    if (settings.power) pending.power = settings.power;
+    if (settings.mode) pending.mode = settings.mode;
+    pending.temperature = settings.temperature;
+    if (settings.fan) pending.fan = settings.fan;
+    if (settings.vane) pending.vane = settings.vane;
+    if (settings.wideVane) pending.wideVane = settings.wideVane;
+    hasPending = true;
+    applyAt = millis() + SETTINGS_APPLY_MS;
+    return true;
+}
+
+bool IndoorUnit::settings(heatpumpSettings *settings) {
+    advance();
+    *settings = current;
+    return true;
+}
+
+bool IndoorUnit::roomTemperature(float *temperature) {
+    advance();
+    // the unit reports half degrees
+    *temperature = roundf(room * 2) / 2;
+    return true;
+}
+
+bool IndoorUnit::status(bool *operating, int *compressorFrequency) {
+    advance();
+    *operating = this->operating;
+    *compressorFrequency = compressor;
+    return true;
+}
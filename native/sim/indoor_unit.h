@@ -0,0 +1,36 @@
+#pragma once
+
+#include <HeatPump.h>
+
+// Simulated indoor unit answering the CN105 link on the virtual clock.
+//
+// Settings frames take effect after SETTINGS_APPLY_MS, like a real unit
+// which only reports new settings once it has processed them. The room is
+// a single thermal mass drifting toward the ambient temperature and pushed
+// toward the target while the compressor runs.
+class IndoorUnit : public HeatPumpUnit {
+public:
+    IndoorUnit(float ambient);
+
+    bool set(const heatpumpSettings &settings) override;
+    bool settings(heatpumpSettings *settings) override;
+    bool roomTemperature(float *temperature) override;
+    bool status(bool *operating, int *compressorFrequency) override;
+
+    unsigned long frames() const { return setFrames; }
+
+private:
+    void advance();
+
+    heatpumpSettings current;
+    heatpumpSettings pending;
+    bool hasPending;
+    unsigned long applyAt;
+
+    float ambient;
+    float room;
+    bool operating;
+    int compressor;
+    unsigned long lastAdvance;
+    unsigned long setFrames;
+};
@@ -0,0 +1,348 @@
+// Whole-firmware simulator.
+//
+// Runs setup() and loop() from src/main.cpp on the virtual clock, with the
+// simulated indoor unit on the CN105 link and a scripted HomeKit controller
+// writing characteristics. Reports command-to-confirmation latency, the
+// distribution of time spent in each loop() iteration, the HomeKit
+// notifications sent, the scheduler task statistics, heap use per
+// subsystem and the persistent counters.
+//
+// Usage: sim [script]
+//
+// A script has one write per line: "<seconds> <characteristic> <value>".
+// Blank lines and lines starting with # are ignored. Without a script the
+// built-in scenario below is used. The exit status is non-zero when a
+// command is not confirmed by the unit within CONFIRM_TIMEOUT_MS.
+
+#include <Arduino.h>
+#include <arduino_homekit_server.h>
+
+#include <map>
+#include <vector>
+
+#include "accessory.h"
+#include "counters.h"
+#include "heap_tracker.h"
+#include "heatpump_client.h"
+#include "indoor_unit.h"
+#include "profiler.h"
+#include "scheduler.h"
+
+// how long the simulation runs after the last command
+#define SETTLE_MS 120000
+#define CONFIRM_TIMEOUT_MS 60000
+// time the HAP server spends decrypting and dispatching a write
+#define HAP_WRITE_MS 30
+// idle time between loop() iterations (WiFi and system tasks)
+#define LOOP_IDLE_MS 1
+
+#define AMBIENT_TEMPERATURE 26
+
+static const char *default_script = R"(
+# cool down
+10 thermostat_target_state 2
+12 thermostat_target_temperature 22
+# change fan speed shortly after
+90 fan_auto 0
+91 fan_speed 60
+# a burst of writes like a scene activation
+200 thermostat_target_state 1
+200 thermostat_target_temperature 24
+200 fan_auto 1
+200 fan_swing 1
+# switch off
+400 fan_active 0
+)";
+
+struct Characteristic {
+    const char *name;
+    homekit_characteristic_t *ch;
+};
+
+static const Characteristic characteristics[] = {
+    {"thermostat_target_state", &ch_thermostat_target_heating_cooling_state},
+    {"thermostat_target_temperature", &ch_thermostat_target_temperature},
+    {"thermostat_current_state", &ch_thermostat_current_heating_cooling_state},
+    {"thermostat_current_temperature", &ch_thermostat_current_temperature},
+    {"dehumidifier_active", &ch_dehumidifier_active},
+    {"dehumidifier_swing", &ch_dehumidifier_swing_mode},
+    {"dehumidifier_current_state", &ch_dehumidifier_current_state},
+    {"fan_active", &ch_fan_active},
+    {"fan_speed", &ch_fan_rotation_speed},
+    {"fan_swing", &ch_fan_swing_mode},
+    {"fan_auto", &ch_fan_target_state},
+    {"fan_current_state", &ch_fan_current_state},
+};
+
+struct Command {
+    unsigned long at;
+    const Characteristic *characteristic;
+    float value;
+
+    unsigned long sent;
+    unsigned long confirmed;
+    unsigned long updatesAtSend;
+};
+
+static std::vector<Command> commands;
+static IndoorUnit unit(AMBIENT_TEMPERATURE);
+
+static const Characteristic *find_characteristic(const char *name) {
+    for (const Characteristic &c : characteristics) {
+        if (strcmp(c.name, name) == 0) {
+            return &c;
+        }
+    }
+    return nullptr;
+}
+
+static bool parse_script(const char *script) {
+    int lineno = 0;
+    const char *line = script;
+    while (line && *line) {
+        const char *end = strchr(line, '\n');
+        size_t len = end ? (size_t)(end - line) : strlen(line);
+        char buf[128];
+        strlcpy(buf, line, min(len + 1, sizeof(buf)));
+        line = end ? end + 1 : nullptr;
+        lineno++;
+
+        if (buf[0] == '\0' || buf[0] == '#') {
+            continue;
+        }
+
+        float seconds;
+        char name[64];
+        float value;
+        if (sscanf(buf, "%f %63s %f", &seconds, name, &value) != 3) {
+            fprintf(stderr, "line %d: expected \"<seconds> <characteristic> <value>\"\n", lineno);
+            return false;
+        }
+        const Characteristic *c = find_characteristic(name);
+        if (!c || !c->ch->setter) {
+            fprintf(stderr, "line %d: unknown or read-only characteristic %s\n", lineno, name);
+            return false;
+        }
+        commands.push_back({(unsigned long)(seconds * 1000), c, value, 0, 0, 0});
+    }
+    return true;
+}
+
+static char *read_file(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        return nullptr;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *data = (char *)malloc(size + 1);
+    size_t n = fread(data, 1, size, f);
+    data[n] = '\0';
+    fclose(f);
+    return data;
+}
+
+// runs inside arduino_homekit_loop(), where the HAP server calls setters
+static void controller() {
+    for (Command &c : commands) {
+        if (c.sent || millis() < c.at) {
+            continue;
+        }
+        homekit_characteristic_t *ch = c.characteristic->ch;
+        delay(HAP_WRITE_MS);
+        c.sent = millis();
+        c.updatesAtSend = heatpump.updates();
+        if (ch->format == homekit_format_float) {
+            ch->setter(HOMEKIT_FLOAT_CPP(c.value));
+        } else {
+            ch->setter(HOMEKIT_UINT8_CPP((uint8_t)c.value));
+        }
+    }
+}
+
+// a command is confirmed once an update was sent after it and the unit
+// reports the settings that were requested
+static void check_confirmations() {
+    bool settled = heatpump.getSettings() == heatpump.wantedSettings();
+    for (Command &c : commands) {
+        if (c.sent && !c.confirmed && settled && heatpump.updates() > c.updatesAtSend) {
+            c.confirmed = millis();
+        }
+    }
+}
+
+static unsigned long percentile(const std::map<unsigned long, unsigned long> &histogram,
+        unsigned long total, double p) {
+    unsigned long rank = (unsigned long)(p * (total - 1));
+    unsigned long seen = 0;
+    for (const auto &bucket : histogram) {
+        seen += bucket.second;
+        if (seen > rank) {
+            return bucket.first;
+        }
+    }
+    return 0;
+}
+
+static void report_stalls(const std::map<unsigned long, unsigned long> &histogram, unsigned long iterations) {
+    printf("loop time (ms): p50 %lu p99 %lu p99.9 %lu max %lu\n",
+            percentile(histogram, iterations, 0.5),
+            percentile(histogram, iterations, 0.99),
+            percentile(histogram, iterations, 0.999),
+            histogram.rbegin()->first);
+
+    // log2 buckets: 0, 1, 2-3, 4-7, ...
+    unsigned long low = 0;
+    unsigned long high = 0;
+    while (low <= histogram.rbegin()->first) {
+        unsigned long count = 0;
+        for (auto it = histogram.lower_bound(low); it != histogram.end() && it->first <= high; ++it) {
+            count += it->second;
+        }
+        if (count) {
+            char range[24];
+            snprintf(range, sizeof(range), low == high ? "%lu" : "%lu-%lu", low, high);
+            printf("  %-12s %10lu\n", range, count);
+        }
+        low = high + 1;
+        high = high * 2 + 1;
+    }
+}
+
+static bool report_commands() {
+    bool ok = true;
+    unsigned long confirmed = 0;
+    unsigned long sum = 0;
+    unsigned long worst = 0;
+
+    printf("commands:\n");
+    for (const Command &c : commands) {
+        if (c.confirmed) {
+            unsigned long latency = c.confirmed - c.sent;
+            printf("  %7.1fs %-30s %6.1f confirmed after %.1fs\n",
+                    c.sent / 1000.0, c.characteristic->name, c.value, latency / 1000.0);
+            if (latency > CONFIRM_TIMEOUT_MS) {
+                ok = false;
+            }
+            confirmed++;
+            sum += latency;
+            worst = max(worst, latency);
+        } else {
+            printf("  %7.1fs %-30s %6.1f NOT CONFIRMED\n",
+                    c.sent / 1000.0, c.characteristic->name, c.value);
+            ok = false;
+        }
+    }
+    if (confirmed) {
+        printf("latency: avg %.1fs max %.1fs\n", sum / 1000.0 / confirmed, worst / 1000.0);
+    }
+    return ok;
+}
+
+static void report_notifications() {
+    printf("notifications: %lu\n", homekit_notify_count());
+    for (const Characteristic &c : characteristics) {
+        unsigned long count = homekit_characteristic_notify_count(c.ch);
+        if (count) {
+            printf("  %-30s %10lu\n", c.name, count);
+        }
+    }
+}
+
+static void report_profile() {
+    printf("%-16s %8s %8s %8s\n", "profile (ms):", "p50", "p99", "max");
+    for (uint8_t i = 0; i < PROFILER_SECTIONS; i++) {
+        profiler_section_t section = (profiler_section_t)i;
+        printf("  %-14s %8.1f %8.1f %8.1f\n", profiler_section_name(section),
+                profiler_percentile(section, 50) / 1000.0,
+                profiler_percentile(section, 99) / 1000.0,
+                profiler_histogram(section)->max / 1000.0);
+    }
+    printf("stalls:\n");
+    const profiler_stall_t *stalls = profiler_stalls();
+    for (uint8_t i = 0; i < PROFILER_STALLS && stalls[i].duration; i++) {
+        printf("  %7.1fs %7.1fms %s %.1fms\n", stalls[i].at / 1000.0, stalls[i].duration / 1000.0,
+                profiler_section_name(stalls[i].cause), stalls[i].cause_duration / 1000.0);
+    }
+}
+
+static void report_heap() {
+    printf("%-16s %8s %8s %8s %8s\n", "heap:", "live", "peak", "allocs", "frees");
+    for (uint8_t i = 0; i < HEAP_TAG_COUNT; i++) {
+        const heap_tag_stats_t *stats = heap_tag_stats((heap_tag_t)i);
+        printf("  %-14s %8u %8u %8u %8u\n", heap_tag_name((heap_tag_t)i),
+                stats->live, stats->peak, stats->allocs, stats->frees);
+    }
+}
+
+static void report_tasks() {
+    printf("%-16s %7s %7s %7s %8s %8s %7s\n",
+            "tasks:", "runs", "avg ms", "max ms", "overruns", "deferred", "late ms");
+    for (uint8_t i = 0; i < scheduler_task_count(); i++) {
+        const scheduler_task_t *task = scheduler_task(i);
+        printf("  %-14s %7u %7.1f %7.1f %8u %8u %7u\n",
+                task->name, task->runs,
+                task->runs ? task->total_us / 1000.0 / task->runs : 0.0,
+                task->max_us / 1000.0, task->overruns, task->deferrals, task->max_late);
+    }
+}
+
+static void report_counters() {
+    printf("counters:");
+    for (uint8_t i = 0; i < COUNTER_COUNT; i++) {
+        printf(" %s %u", counters_name((counter_t)i), counters_get((counter_t)i));
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv) {
+    const char *script = default_script;
+    if (argc > 1) {
+        script = read_file(argv[1]);
+        if (!script) {
+            perror(argv[1]);
+            return 2;
+        }
+    }
+    if (!parse_script(script)) {
+        return 2;
+    }
+
+    unsigned long end = SETTLE_MS;
+    for (const Command &c : commands) {
+        end = max(end, c.at + SETTLE_MS);
+    }
+
+    heatpump.attach(&unit);
+    arduino_homekit_set_controller(controller);
+
+    setup();
+    unsigned long booted = millis();
+
+    std::map<unsigned long, unsigned long> histogram;
+    unsigned long iterations = 0;
+    while (millis() < end) {
+        unsigned long start = millis();
+        loop();
+        // scheduled functions run right after loop() returns
+        native_advance(0);
+        histogram[millis() - start]++;
+        iterations++;
+
+        check_confirmations();
+        delay(LOOP_IDLE_MS);
+    }
+
+    printf("simulated %.1fs, setup %.1fs, %lu loop iterations, %lu update frames\n",
+            millis() / 1000.0, booted / 1000.0, iterations, unit.frames());
+    report_stalls(histogram, iterations);
+    bool ok = report_commands();
+    report_notifications();
+    report_profile();
+    report_tasks();
+    report_heap();
+    report_counters();
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,51 @@
+// Subsystems that need a network or sensors are not simulated: they
+// initialize to their "not configured" state and their loops are idle.
+
+#include "env_sensor.h"
+#include "mqtt.h"
+#include "ntp_clock.h"
+#include "settings.h"
+#include "web.h"
+#include "wifi_manager.h"
+
+Settings settings;
+PubSubClient mqtt;
+WiFiManager wifiManager;
+char env_sensor_status[30] = {0};
+
+void settings_init() {
+    settings.mqtt_port = 1883;
+}
+
+void wifi_init(const char *ssid) {
+    (void)ssid;
+}
+
+void ntp_clock_init() {
+}
+
+void web_init(const char *hostname) {
+    (void)hostname;
+}
+
+void web_loop() {
+}
+
+bool mqtt_is_configured() {
+    return false;
+}
+
+bool mqtt_init(const char *name) {
+    (void)name;
+    return false;
+}
+
+bool mqtt_connect() {
+    return false;
+}
+
+void mqtt_loop() {
+}
+
+void env_sensor_init() {
+}
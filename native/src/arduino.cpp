@@ -0,0 +1,94 @@
+#include <Arduino.h>
+#include <ESP8266mDNS.h>
+#include <LittleFS.h>
+#include <Ticker.h>
+
+HardwareSerial Serial;
+EspClass ESP;
+MDNSResponder MDNS;
+FS LittleFS;
+
+static unsigned long clock_ms = 0;
+
+size_t strlcpy(char *dst, const char *src, size_t size) {
+    size_t len = strlen(src);
+    if (size) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+
+unsigned long millis() {
+    return clock_ms;
+}
+
+unsigned long micros() {
+    return clock_ms * 1000;
+}
+
+static void advance(unsigned long ms, bool scheduled) {
+    // jump from deadline to deadline so tickers fire in order
+    unsigned long target = clock_ms + ms;
+    unsigned long deadline;
+    while (Ticker::next_deadline(&deadline, scheduled) && (long)(deadline - target) <= 0) {
+        if ((long)(deadline - clock_ms) > 0) {
+            clock_ms = deadline;
+        }
+        Ticker::run_due(clock_ms, scheduled);
+    }
+    // a callback that called delay() may already have moved past the target
+    if ((long)(target - clock_ms) > 0) {
+        clock_ms = target;
+    }
+}
+
+void native_advance(unsigned long ms) {
+    advance(ms, true);
+}
+
+void delay(unsigned long ms) {
+    advance(ms, false);
+}
+
+void yield() {
+}
+
+uint32_t EspClass::getCycleCount() {
+    // 160MHz core clock
+    return (uint32_t)(clock_ms * 160000);
+}
+
+static uint32_t rtc_memory[128];
+
+bool EspClass::rtcUserMemoryRead(uint32_t offset, uint32_t *data, size_t size) {
+    if (offset * 4 + size > sizeof(rtc_memory) || size % 4) {
+        return false;
+    }
+    memcpy(data, &rtc_memory[offset], size);
+    return true;
+}
+
+bool EspClass::rtcUserMemoryWrite(uint32_t offset, uint32_t *data, size_t size) {
+    if (offset * 4 + size > sizeof(rtc_memory) || size % 4) {
+        return false;
+    }
+    memcpy(&rtc_memory[offset], data, size);
+    return true;
+}
+
+rst_info *EspClass::getResetInfoPtr() {
+    static rst_info info = {REASON_DEFAULT_RST, 0, 0, 0, 0, 0, 0};
+    return &info;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    (void)pin;
+    (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    (void)pin;
+    (void)value;
+}
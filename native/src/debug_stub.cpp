@@ -0,0 +1,21 @@
+// Host builds have no remote logger, MIE_LOG compiles to nothing.
+
+#include "debug.h"
+
+void debug_init(const char ssid[]) {
+    (void)ssid;
+}
+
+void debug_loop() {
+}
+
+void logger_set_serial_enabled(bool enabled) {
+    (void)enabled;
+}
+
+bool debug_log_line(uint32_t *position, char *str, size_t size) {
+    (void)position;
+    (void)str;
+    (void)size;
+    return false;
+}
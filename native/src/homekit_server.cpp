@@ -0,0 +1,70 @@
+#include <arduino_homekit_server.h>
+
+static homekit_server_t server = {nullptr, true};
+static void (*controller)() = nullptr;
+
+#define MAX_COUNTED 32
+static unsigned long notifications = 0;
+static struct {
+    const homekit_characteristic_t *ch;
+    unsigned long count;
+} counted[MAX_COUNTED];
+
+void homekit_characteristic_notify(homekit_characteristic_t *ch, const homekit_value_t value) {
+    (void)value;
+    notifications++;
+    for (int i = 0; i < MAX_COUNTED; i++) {
+        if (counted[i].ch == ch || !counted[i].ch) {
+            counted[i].ch = ch;
+            counted[i].count++;
+            break;
+        }
+    }
+}
+
+unsigned long homekit_notify_count() {
+    return notifications;
+}
+
+unsigned long homekit_characteristic_notify_count(const homekit_characteristic_t *ch) {
+    for (int i = 0; i < MAX_COUNTED && counted[i].ch; i++) {
+        if (counted[i].ch == ch) {
+            return counted[i].count;
+        }
+    }
+    return 0;
+}
+
+bool homekit_is_paired() {
+    return server.paired;
+}
+
+int homekit_storage_reset() {
+    server.paired = false;
+    return 0;
+}
+
+void homekit_update_config_number() {
+}
+
+void arduino_homekit_setup(homekit_server_config_t *config) {
+    server.config = config;
+}
+
+void arduino_homekit_loop() {
+    if (controller) {
+        controller();
+    }
+}
+
+void arduino_homekit_set_controller(void (*callback)()) {
+    controller = callback;
+}
+
+homekit_server_t *arduino_homekit_get_running_server() {
+    return &server;
+}
+
+int arduino_homekit_connected_clients_count() {
+    return 1;
+}
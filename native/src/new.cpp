@@ -0,0 +1,42 @@
+// As in the ESP8266 core, C++ allocations go through malloc() so the heap
+// tracker sees them.
+
+#include <stdlib.h>
+
+#include <new>
+
+void *operator new(size_t size) {
+    void *ptr = malloc(size);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    return malloc(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+    return malloc(size);
+}
+
+void operator delete(void *ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+    free(ptr);
+}
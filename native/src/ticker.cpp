@@ -0,0 +1,65 @@
+#include <Arduino.h>
+#include <Ticker.h>
+
+static Ticker *tickers = nullptr;
+
+Ticker::Ticker()
+    : _next(tickers), _deadline(0), _interval(0), _repeat(false), _scheduled(false), _active(false) {
+    tickers = this;
+}
+
+Ticker::~Ticker() {
+    for (Ticker **t = &tickers; *t; t = &(*t)->_next) {
+        if (*t == this) {
+            *t = _next;
+            break;
+        }
+    }
+}
+
+void Ticker::_arm(uint32_t milliseconds, bool repeat, bool scheduled, callback_function_t callback) {
+    _callback = callback;
+    _interval = milliseconds;
+    _deadline = millis() + milliseconds;
+    _repeat = repeat;
+    _scheduled = scheduled;
+    _active = true;
+}
+
+void Ticker::detach() {
+    _active = false;
+    _callback = nullptr;
+}
+
+void Ticker::run_due(unsigned long now, bool scheduled) {
+    for (Ticker *t = tickers; t; t = t->_next) {
+        if (!t->_active || (t->_scheduled && !scheduled) || (long)(now - t->_deadline) < 0) {
+            continue;
+        }
+
+        // copy first: the callback may re-arm or detach its own ticker
+        callback_function_t callback = t->_callback;
+        if (t->_repeat) {
+            t->_deadline += t->_interval;
+        } else {
+            t->_active = false;
+        }
+        if (callback) {
+            callback();
+        }
+    }
+}
+
+bool Ticker::next_deadline(unsigned long *deadline, bool scheduled) {
+    bool found = false;
+    for (Ticker *t = tickers; t; t = t->_next) {
+        if (!t->_active || (t->_scheduled && !scheduled)) {
+            continue;
+        }
+        if (!found || (long)(t->_deadline - *deadline) < 0) {
+            *deadline = t->_deadline;
+            found = true;
+        }
+    }
+    return found;
+}
@@ -0,0 +1,71 @@
+#include <ESP8266WiFi.h>
+#include <WiFiUdp.h>
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+ESP8266WiFiClass WiFi;
+
+bool IPAddress::fromString(const char *str) {
+    struct in_addr in;
+    if (inet_pton(AF_INET, str, &in) != 1) {
+        return false;
+    }
+    address = in.s_addr;
+    return true;
+}
+
+int ESP8266WiFiClass::hostByName(const char *name, IPAddress &result) {
+    struct addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    struct addrinfo *info;
+    if (getaddrinfo(name, nullptr, &hints, &info) != 0) {
+        return 0;
+    }
+    result = IPAddress(((struct sockaddr_in *)info->ai_addr)->sin_addr.s_addr);
+    freeaddrinfo(info);
+    return 1;
+}
+
+WiFiUDP::~WiFiUDP() {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port) {
+    if (fd < 0) {
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd < 0) {
+            return 0;
+        }
+    }
+    this->ip = ip;
+    this->port = port;
+    packet.clear();
+    started = true;
+    return 1;
+}
+
+size_t WiFiUDP::write(const uint8_t *buffer, size_t size) {
+    if (!started) {
+        return 0;
+    }
+    packet.append((const char *)buffer, size);
+    return size;
+}
+
+int WiFiUDP::endPacket() {
+    if (!started) {
+        return 0;
+    }
+    started = false;
+    struct sockaddr_in to = {};
+    to.sin_family = AF_INET;
+    to.sin_port = htons(port);
+    to.sin_addr.s_addr = (uint32_t)ip;
+    return sendto(fd, packet.data(), packet.size(), 0, (struct sockaddr *)&to, sizeof(to)) == (ssize_t)packet.size();
+}
@@ -0,0 +1,10 @@
+Import("env")
+
+# libFuzzer and the sanitizers come with clang
+env.Replace(CC="clang", CXX="clang++", LINK="clang++")
+
+flags = ["-g", "-fno-omit-frame-pointer", "-fsanitize=fuzzer,address,undefined"]
+if env["ENV"].get("FUZZ_COVERAGE"):
+    flags += ["-fprofile-instr-generate", "-fcoverage-mapping"]
+
+env.Append(CCFLAGS=flags, LINKFLAGS=flags)
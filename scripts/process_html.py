@@ -1,21 +1,51 @@
+import gzip
+import hashlib
 import os.path
+import re
 
 Import("env")
 
 src_file = os.path.join(env["PROJECT_DIR"], "web/index.html")
 dest_file = os.path.join(env["PROJECT_DIR"], "src/html.cpp")
 
-template = """#include <sys/pgmspace.h>
+template = """#include <Arduino.h>
 
 // generated file, edit web/index.html
-const char* index_html PROGMEM = R"====(
-__HTML__
-)====";
+extern const uint8_t index_html_gz[] PROGMEM = {
+__BYTES__
+};
+extern const size_t index_html_gz_size = sizeof(index_html_gz);
+const char *index_html_etag = "\\"__ETAG__\\"";
 """
 
+
+# conservative: the script relies on automatic semicolon insertion, so
+# line breaks are kept and only indentation, blank lines and comments go
+def minify(html):
+    html = re.sub(r"<!--.*?-->", "", html, flags=re.DOTALL)
+    html = re.sub(r"/\*.*?\*/", "", html, flags=re.DOTALL)
+    lines = (line.strip() for line in html.splitlines())
+    return "\n".join(line for line in lines if line) + "\n"
+
+
 with open(src_file) as src:
-    with open(dest_file, 'w') as dest:
-        html = src.read()
-        result = template.replace('__HTML__', html);
-        dest.write(result)
+    html = minify(src.read()).encode("utf-8")
 
+# mtime=0 so the output only changes with the page
+compressed = gzip.compress(html, compresslevel=9, mtime=0)
+etag = hashlib.sha1(compressed).hexdigest()[:16]
+
+rows = []
+for i in range(0, len(compressed), 16):
+    rows.append("    " + ", ".join("0x%02x" % b for b in compressed[i:i + 16]) + ",")
+
+result = template.replace("__BYTES__", "\n".join(rows)).replace("__ETAG__", etag)
+
+# leave the file alone when nothing changed to avoid a rebuild
+current = None
+if os.path.exists(dest_file):
+    with open(dest_file) as dest:
+        current = dest.read()
+if current != result:
+    with open(dest_file, "w") as dest:
+        dest.write(result)
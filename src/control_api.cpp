@@ -0,0 +1,247 @@
+#include "control_api.h"
+
+#include <ArduinoJson.h>
+
+#include "accessory.h"
+#include "debug.h"
+#include "heatpump_client.h"
+#include "homekit.h"
+#include "http_server.h"
+
+#define MIME_JSON "application/json"
+
+// a PATCH body has at most every field
+#define CONTROL_JSON_CAPACITY 256
+
+enum control_type_t {
+    CONTROL_BOOL,
+    CONTROL_NUMBER,
+    // target heating cooling state by name
+    CONTROL_MODE,
+};
+
+struct control_field_t {
+    const char *name;
+    homekit_characteristic_t *characteristic;
+    control_type_t type;
+};
+
+// a PATCH applies the fields in this order, the mode and the active switches
+// first as they reset other fields, like they do in the Home app
+static const control_field_t control_fields[] = {
+    {"mode", &ch_thermostat_target_heating_cooling_state, CONTROL_MODE},
+    {"dehumidifier", &ch_dehumidifier_active, CONTROL_BOOL},
+    {"fan", &ch_fan_active, CONTROL_BOOL},
+    {"target_temperature", &ch_thermostat_target_temperature, CONTROL_NUMBER},
+    {"fan_auto", &ch_fan_target_state, CONTROL_BOOL},
+    // percent, 20 per speed step
+    {"fan_speed", &ch_fan_rotation_speed, CONTROL_NUMBER},
+    {"vertical_swing", &ch_fan_swing_mode, CONTROL_BOOL},
+    {"horizontal_swing", &ch_dehumidifier_swing_mode, CONTROL_BOOL},
+};
+
+#define CONTROL_FIELDS (sizeof(control_fields) / sizeof(control_fields[0]))
+
+// indexed by HomeKit target heating cooling state
+static const char *const control_modes[] = {"off", "heat", "cool", "auto"};
+
+#define CONTROL_MODES (sizeof(control_modes) / sizeof(control_modes[0]))
+
+// quoted hash of the desired fields
+static void control_etag(char *str, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (uint8_t i = 0; i < CONTROL_FIELDS; i++) {
+        const homekit_value_t *value = &control_fields[i].characteristic->value;
+        uint32_t bits;
+        if (control_fields[i].type == CONTROL_NUMBER) {
+            memcpy(&bits, &value->float_value, sizeof(bits));
+        } else {
+            bits = value->uint8_value;
+        }
+        for (uint8_t shift = 0; shift < 32; shift += 8) {
+            hash = (hash ^ ((bits >> shift) & 0xff)) * 16777619u;
+        }
+    }
+    snprintf(str, size, "\"%08x\"", hash);
+}
+
+static void control_write_field(JsonWriter &json, const control_field_t *field) {
+    const homekit_value_t *value = &field->characteristic->value;
+    switch (field->type) {
+        case CONTROL_BOOL:
+            json.field(field->name, value->uint8_value != 0);
+            break;
+        case CONTROL_NUMBER:
+            json.field(field->name, value->float_value, 1);
+            break;
+        case CONTROL_MODE:
+            json.field(field->name, value->uint8_value < CONTROL_MODES ? control_modes[value->uint8_value] : nullptr);
+            break;
+    }
+}
+
+static void control_write_settings(JsonWriter &json, const heatpumpSettings &settings) {
+    json.field("power", settings.power);
+    json.field("mode", settings.mode);
+    json.field("temperature", settings.temperature, 1);
+    json.field("fan", settings.fan);
+    json.field("vane", settings.vane);
+    json.field("wide_vane", settings.wideVane);
+}
+
+// desired fields, the heat pump settings they map to, then the heat pump's
+static bool control_state_step(http_request_t *request, uint16_t step) {
+    JsonWriter &json = http_json(request);
+    switch (step) {
+        case 0:
+            json.beginObject();
+            json.key("desired");
+            json.beginObject();
+            for (uint8_t i = 0; i < CONTROL_FIELDS; i++) {
+                control_write_field(json, &control_fields[i]);
+            }
+            json.endObject();
+            return true;
+
+        case 1:
+            json.key("settings");
+            json.beginObject();
+            control_write_settings(json, homekit_desired_settings());
+            json.endObject();
+            json.field("pending", homekit_update_pending());
+            return true;
+
+        default:
+            json.key("current");
+            json.beginObject();
+            json.field("connected", heatpump.isConnected());
+            if (heatpump.isConnected()) {
+                control_write_settings(json, heatpump.getSettings());
+                json.field("room_temperature", heatpump.getRoomTemperature(), 1);
+                json.field("operating", heatpump.getOperating());
+                json.field("compressor_frequency", heatpump.getStatus().compressorFrequency);
+            }
+            json.endObject();
+            json.endObject();
+            return false;
+    }
+}
+
+static void control_send_state(http_request_t *request, int status) {
+    char etag[12];
+    control_etag(etag, sizeof(etag));
+    http_add_header(request, "ETag", etag);
+    http_add_header(request, "Cache-Control", "no-cache");
+    http_send_steps(request, status, MIME_JSON, control_state_step);
+}
+
+static void control_get_state(http_request_t *request) {
+    control_send_state(request, 200);
+}
+
+static void control_error(http_request_t *request, int status, const char *message, const char *field = nullptr) {
+    char body[80];
+    if (field) {
+        snprintf(body, sizeof(body), "{\"error\":\"%s\",\"field\":\"%s\"}", message, field);
+    } else {
+        snprintf(body, sizeof(body), "{\"error\":\"%s\"}", message);
+    }
+    http_send(request, status, MIME_JSON, body);
+}
+
+// the value a JSON member sets the field's characteristic to, false if it
+// has the wrong type or isn't accepted
+static bool control_value(const control_field_t *field, JsonVariantConst member, homekit_value_t *value) {
+    switch (field->type) {
+        case CONTROL_BOOL:
+            if (!member.is<bool>()) {
+                return false;
+            }
+            *value = HOMEKIT_UINT8_CPP(member.as<bool>() ? 1 : 0);
+            break;
+        case CONTROL_NUMBER:
+            if (!member.is<float>()) {
+                return false;
+            }
+            *value = HOMEKIT_FLOAT_CPP(member.as<float>());
+            break;
+        case CONTROL_MODE: {
+            const char *name = member.as<const char *>();
+            uint8_t mode = 0;
+            while (mode < CONTROL_MODES && !(name && strcmp(name, control_modes[mode]) == 0)) {
+                mode++;
+            }
+            if (mode == CONTROL_MODES) {
+                return false;
+            }
+            *value = HOMEKIT_UINT8_CPP(mode);
+            break;
+        }
+    }
+    return homekit_control_accepts(field->characteristic, *value);
+}
+
+static void control_patch_state(http_request_t *request) {
+    if (!homekit_is_paired()) {
+        control_error(request, 503, "not paired");
+        return;
+    }
+
+    char etag[12];
+    control_etag(etag, sizeof(etag));
+    const char *match = http_header(request, HTTP_HEADER_IF_MATCH);
+    if (!match) {
+        control_error(request, 428, "If-Match required");
+        return;
+    }
+    if (strcmp(match, "*") != 0 && strcmp(match, etag) != 0) {
+        http_add_header(request, "ETag", etag);
+        control_error(request, 412, "state changed");
+        return;
+    }
+
+    const char *type = http_header(request, HTTP_HEADER_CONTENT_TYPE);
+    if (!type || strncmp(type, MIME_JSON, strlen(MIME_JSON)) != 0) {
+        control_error(request, 415, "JSON body expected");
+        return;
+    }
+    size_t size;
+    const char *body = http_body(request, &size);
+    StaticJsonDocument<CONTROL_JSON_CAPACITY> doc;
+    if (deserializeJson(doc, body, size) || !doc.is<JsonObject>()) {
+        control_error(request, 400, "invalid JSON");
+        return;
+    }
+
+    // check everything before changing anything
+    homekit_value_t values[CONTROL_FIELDS];
+    bool present[CONTROL_FIELDS] = {};
+    for (JsonPairConst member : doc.as<JsonObjectConst>()) {
+        uint8_t i = 0;
+        while (i < CONTROL_FIELDS && strcmp(member.key().c_str(), control_fields[i].name) != 0) {
+            i++;
+        }
+        if (i == CONTROL_FIELDS) {
+            control_error(request, 400, "unknown field");
+            return;
+        }
+        if (!control_value(&control_fields[i], member.value(), &values[i])) {
+            control_error(request, 400, "invalid value", control_fields[i].name);
+            return;
+        }
+        present[i] = true;
+    }
+
+    for (uint8_t i = 0; i < CONTROL_FIELDS; i++) {
+        if (present[i]) {
+            MIE_LOG("⬅ API %s", control_fields[i].name);
+            homekit_control(control_fields[i].characteristic, values[i]);
+        }
+    }
+    control_send_state(request, 202);
+}
+
+void control_api_init() {
+    http_on("/api/state", HTTP_METHOD_GET, control_get_state);
+    http_on("/api/state", HTTP_METHOD_PATCH, control_patch_state);
+}
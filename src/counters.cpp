@@ -0,0 +1,215 @@
+#include "counters.h"
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <user_interface.h>
+
+#include "debug.h"
+#include "metrics.h"
+#include "scheduler.h"
+
+#define COUNTERS_MAGIC 0x544e4f43 // "CONT"
+#define COUNTERS_TICK 60000
+#define COUNTERS_BUDGET 50000
+#define COUNTERS_TEMP_FILE "/counters.tmp"
+
+struct counters_rtc_t {
+    uint32_t magic;
+    uint32_t check;
+    uint32_t values[COUNTER_COUNT];
+};
+
+static_assert(sizeof(counters_rtc_t) <= COUNTERS_RTC_BLOCKS * 4, "counters don't fit in their RTC blocks");
+
+// a journal entry; replaying keeps the highest value seen for a counter, as
+// they only grow
+struct counter_record_t {
+    uint16_t counter;
+    uint16_t check;
+    uint32_t value;
+};
+
+static const char *const counter_names[COUNTER_COUNT] = {
+    "boots",
+    "crashes",
+    "uptime",
+    "runtime",
+    "compressor_starts",
+};
+
+static counters_rtc_t rtc;
+// values as of the last flush
+static uint32_t flushed[COUNTER_COUNT];
+static uint16_t journal_records = 0;
+static uint32_t last_tick = 0;
+static uint32_t last_flush = 0;
+static uint32_t uptime_ms = 0;
+
+static uint32_t fnv1a(const void *data, size_t size) {
+    const uint8_t *bytes = (const uint8_t *)data;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static uint16_t record_check(const counter_record_t *record) {
+    uint32_t hash = fnv1a(&record->value, sizeof(record->value)) ^ record->counter;
+    return hash ^ (hash >> 16);
+}
+
+static void rtc_write() {
+    rtc.magic = COUNTERS_MAGIC;
+    rtc.check = fnv1a(rtc.values, sizeof(rtc.values));
+    ESP.rtcUserMemoryWrite(COUNTERS_RTC_OFFSET, (uint32_t *)&rtc, sizeof(rtc));
+}
+
+// the copy from before a reset, if there was one and it's intact
+static bool rtc_read(counters_rtc_t *copy) {
+    return ESP.rtcUserMemoryRead(COUNTERS_RTC_OFFSET, (uint32_t *)copy, sizeof(*copy)) &&
+            copy->magic == COUNTERS_MAGIC &&
+            copy->check == fnv1a(copy->values, sizeof(copy->values));
+}
+
+static void journal_replay() {
+    File f = LittleFS.open(COUNTERS_FILE, "r");
+    if (!f) {
+        return;
+    }
+    counter_record_t records[8];
+    size_t n;
+    while ((n = f.read((uint8_t *)records, sizeof(records)) / sizeof(counter_record_t)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            const counter_record_t *record = &records[i];
+            journal_records++;
+            if (record->counter >= COUNTER_COUNT || record->check != record_check(record)) {
+                continue;
+            }
+            rtc.values[record->counter] = max(rtc.values[record->counter], record->value);
+        }
+    }
+    f.close();
+}
+
+static bool journal_append(File &f, uint8_t counter) {
+    counter_record_t record = {counter, 0, rtc.values[counter]};
+    record.check = record_check(&record);
+    return f.write((const uint8_t *)&record, sizeof(record)) == sizeof(record);
+}
+
+// every counter into a new journal that replaces the old one
+static void journal_compact() {
+    File f = LittleFS.open(COUNTERS_TEMP_FILE, "w");
+    bool ok = f;
+    for (uint8_t i = 0; ok && i < COUNTER_COUNT; i++) {
+        ok = journal_append(f, i);
+    }
+    f.close();
+    if (!ok || !LittleFS.rename(COUNTERS_TEMP_FILE, COUNTERS_FILE)) {
+        MIE_LOG_ERROR("Error compacting counters");
+        return;
+    }
+    journal_records = COUNTER_COUNT;
+    memcpy(flushed, rtc.values, sizeof(flushed));
+}
+
+void counters_flush() {
+    last_flush = millis();
+    uint8_t changed = 0;
+    for (uint8_t i = 0; i < COUNTER_COUNT; i++) {
+        changed += rtc.values[i] != flushed[i];
+    }
+    if (!changed) {
+        return;
+    }
+    if (journal_records + changed > COUNTERS_JOURNAL_MAX) {
+        journal_compact();
+        return;
+    }
+
+    File f = LittleFS.open(COUNTERS_FILE, "a");
+    if (!f) {
+        MIE_LOG_ERROR("Error saving counters");
+        return;
+    }
+    for (uint8_t i = 0; i < COUNTER_COUNT; i++) {
+        if (rtc.values[i] != flushed[i] && journal_append(f, i)) {
+            flushed[i] = rtc.values[i];
+            journal_records++;
+        }
+    }
+    f.close();
+}
+
+static void counters_tick() {
+    uint32_t now = millis();
+    uptime_ms += now - last_tick;
+    last_tick = now;
+    counters_add(COUNTER_UPTIME, uptime_ms / 1000);
+    uptime_ms %= 1000;
+
+    if (now - last_flush >= COUNTERS_FLUSH_INTERVAL) {
+        counters_flush();
+    }
+}
+
+template <counter_t counter>
+static double metric_counter(uint8_t index) {
+    return counters_get(counter);
+}
+
+static const metric_t metrics[] = {
+    {"mel_boots_total", METRIC_COUNTER, "Boots since the counters were created", metric_counter<COUNTER_BOOTS>},
+    {"mel_crashes_total", METRIC_COUNTER, "Resets by an exception or a watchdog", metric_counter<COUNTER_CRASHES>},
+    {"mel_powered_seconds_total", METRIC_COUNTER, "Time powered on", metric_counter<COUNTER_UPTIME>},
+    {"mel_heatpump_operating_seconds_total", METRIC_COUNTER, "Time the heat pump was heating or cooling",
+            metric_counter<COUNTER_RUNTIME>},
+    {"mel_heatpump_compressor_starts_total", METRIC_COUNTER, "Times the compressor started",
+            metric_counter<COUNTER_COMPRESSOR_STARTS>},
+};
+
+void counters_init() {
+    memset(&rtc, 0, sizeof(rtc));
+    journal_replay();
+    memcpy(flushed, rtc.values, sizeof(flushed));
+
+    // newer than the journal unless the power was off
+    counters_rtc_t copy;
+    if (rtc_read(&copy)) {
+        for (uint8_t i = 0; i < COUNTER_COUNT; i++) {
+            rtc.values[i] = max(rtc.values[i], copy.values[i]);
+        }
+    }
+
+    rtc.values[COUNTER_BOOTS]++;
+    uint32_t reason = ESP.getResetInfoPtr()->reason;
+    if (reason == REASON_EXCEPTION_RST || reason == REASON_WDT_RST || reason == REASON_SOFT_WDT_RST) {
+        rtc.values[COUNTER_CRASHES]++;
+    }
+    rtc_write();
+    counters_flush();
+    MIE_LOG("Boot %u, %u crashes", rtc.values[COUNTER_BOOTS], rtc.values[COUNTER_CRASHES]);
+
+    last_tick = millis();
+    scheduler_every("counters", COUNTERS_TICK, SCHEDULER_PRIORITY_LOW, COUNTERS_BUDGET, counters_tick);
+    for (const metric_t &metric : metrics) {
+        metrics_register(&metric);
+    }
+}
+
+void counters_add(counter_t counter, uint32_t n) {
+    if (n == 0) {
+        return;
+    }
+    rtc.values[counter] += n;
+    rtc_write();
+}
+
+uint32_t counters_get(counter_t counter) {
+    return rtc.values[counter];
+}
+
+const char *counters_name(counter_t counter) {
+    return counter_names[counter];
+}
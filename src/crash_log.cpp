@@ -0,0 +1,278 @@
+#include "crash_log.h"
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <new>
+#include <spi_flash.h>
+#include <user_interface.h>
+#include <xlogger.h>
+
+#include "counters.h"
+#include "debug.h"
+
+#define CRASH_LOG_MAGIC 0x48535243 // "CRSH"
+// in 4 byte blocks, after the counters
+#define CRASH_LOG_RTC_OFFSET (COUNTERS_RTC_OFFSET + COUNTERS_RTC_BLOCKS)
+#define CRASH_LOG_TAIL_SIZE 256
+#define CRASH_LOG_STACK_WORDS 48
+#define CRASH_LOG_REASON_SIZE 60
+
+// a sector of its own between the file system and the EEPROM area, where
+// HomeKit keeps its pairings, see ld/eagle.flash.4m2m.crash.ld
+extern "C" uint32_t _CRASH_LOG_start;
+#define CRASH_LOG_SECTOR (((uint32_t)&_CRASH_LOG_start - 0x40200000) / SPI_FLASH_SEC_SIZE)
+
+// written by the crash callback at the start of the sector, followed by the
+// log ring as it was
+struct crash_slot_t {
+    uint32_t magic;
+    // of what follows it and of the ring
+    uint32_t check;
+    // the ring's packed lines point into the firmware that logged them
+    uint32_t firmware;
+    uint32_t reason;
+    uint32_t exccause;
+    uint32_t epc1;
+    uint32_t epc2;
+    uint32_t epc3;
+    uint32_t excvaddr;
+    uint32_t depc;
+    // milliseconds
+    uint32_t uptime;
+    uint32_t boot_time;
+    uint32_t sp;
+    uint32_t stack_words;
+    uint32_t stack[CRASH_LOG_STACK_WORDS];
+};
+
+// written to RTC memory by crash_log_restart()
+struct crash_rtc_t {
+    uint32_t magic;
+    uint32_t check;
+    uint32_t uptime;
+    char why[24];
+    // the newest lines that fit, as shown
+    char tail[CRASH_LOG_TAIL_SIZE];
+};
+
+static_assert(sizeof(crash_slot_t) + sizeof(LogRing) <= SPI_FLASH_SEC_SIZE, "crash log doesn't fit in a sector");
+static_assert(sizeof(LogRing) % 4 == 0, "flash is written in words");
+static_assert(CRASH_LOG_RTC_OFFSET * 4 + sizeof(crash_rtc_t) <= 512, "crash log doesn't fit in RTC memory");
+
+// static rather than on the stack, which may be what overflowed
+static crash_slot_t slot;
+static uint32_t firmware_id;
+static char reset_reason[CRASH_LOG_REASON_SIZE] = "";
+
+static uint32_t fnv1a(uint32_t hash, const void *data, size_t size) {
+    const uint8_t *bytes = (const uint8_t *)data;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+#define FNV1A_BASIS 2166136261u
+
+static uint32_t slot_check(const crash_slot_t *slot, const LogRing *ring) {
+    uint32_t hash = fnv1a(FNV1A_BASIS, &slot->firmware, sizeof(crash_slot_t) - offsetof(crash_slot_t, firmware));
+    return fnv1a(hash, ring, sizeof(LogRing));
+}
+
+static uint32_t rtc_check(const crash_rtc_t *rtc) {
+    return fnv1a(FNV1A_BASIS, &rtc->uptime, sizeof(crash_rtc_t) - offsetof(crash_rtc_t, uptime));
+}
+
+// called by the core before it prints the exception and resets, with
+// interrupts off: nothing here may allocate
+extern "C" void custom_crash_callback(struct rst_info *info, uint32_t stack, uint32_t stack_end) {
+    const LogRing &ring = Debug.ring();
+
+    slot.magic = CRASH_LOG_MAGIC;
+    slot.firmware = firmware_id;
+    slot.reason = info->reason;
+    slot.exccause = info->exccause;
+    slot.epc1 = info->epc1;
+    slot.epc2 = info->epc2;
+    slot.epc3 = info->epc3;
+    slot.excvaddr = info->excvaddr;
+    slot.depc = info->depc;
+    slot.uptime = millis();
+    slot.boot_time = bootTime();
+    slot.sp = stack;
+    slot.stack_words = min((stack_end - stack) / 4, (uint32_t)CRASH_LOG_STACK_WORDS);
+    memset(slot.stack, 0, sizeof(slot.stack));
+    memcpy(slot.stack, (const void *)stack, slot.stack_words * 4);
+    slot.check = slot_check(&slot, &ring);
+
+    uint32_t address = CRASH_LOG_SECTOR * SPI_FLASH_SEC_SIZE;
+    if (ESP.flashEraseSector(CRASH_LOG_SECTOR)) {
+        ESP.flashWrite(address, (uint32_t *)&slot, sizeof(slot));
+        ESP.flashWrite(address + sizeof(slot), (uint32_t *)&ring, sizeof(ring));
+    }
+}
+
+// registers and stack as the core prints them, then the log
+static bool crash_log_write(const LogRing *ring, bool same_firmware) {
+    File f = LittleFS.open(CRASH_LOG_FILE, "w");
+    if (!f) {
+        return false;
+    }
+
+    if (slot.reason == REASON_SOFT_WDT_RST) {
+        f.printf("Soft WDT reset\n");
+    } else {
+        f.printf("Exception (%u):\n", slot.exccause);
+    }
+    f.printf("epc1=0x%08x epc2=0x%08x epc3=0x%08x excvaddr=0x%08x depc=0x%08x\n\n",
+            slot.epc1, slot.epc2, slot.epc3, slot.excvaddr, slot.depc);
+    f.printf(">>>stack>>>\n");
+    for (uint32_t i = 0; i < slot.stack_words; i += 4) {
+        f.printf("%08x: ", slot.sp + i * 4);
+        for (uint32_t j = i; j < i + 4 && j < slot.stack_words; j++) {
+            f.printf(" %08x", slot.stack[j]);
+        }
+        f.printf("\n");
+    }
+    f.printf("<<<stack<<<\n\n");
+
+    char uptime[20];
+    uptimeString(uptime, sizeof(uptime), slot.uptime / 1000);
+    f.printf("Up %s, firmware %s\n\n", uptime, same_firmware ? GIT_DESCRIBE : "since updated");
+    if (!same_firmware) {
+        // the packed lines point to strings in the old firmware
+        f.printf("Log left out\n");
+        f.close();
+        return true;
+    }
+
+    LogLineFormat format;
+    format.timeFormat = slot.boot_time ? ltUTCTime : ltStrTime;
+    format.bootTime = slot.boot_time;
+    uint16_t offset = 0;
+    LogHeader header;
+    char data[LINE_BUFFER_LENGTH];
+    char line[LOG_LINE_LENGTH];
+    for (uint16_t n = 0; n < ring->count() && ring->read(offset, header, data, sizeof(data)); n++) {
+        size_t length = logLine(line, sizeof(line), format, header, data, min((size_t)header.logSize, sizeof(data) - 1));
+        f.write((const uint8_t *)line, length);
+    }
+    f.close();
+    return true;
+}
+
+// a crash the callback saved, gone from flash once read so that one that
+// can't be shown doesn't crash every boot
+static bool crash_log_load() {
+    uint32_t address = CRASH_LOG_SECTOR * SPI_FLASH_SEC_SIZE;
+    if (!ESP.flashRead(address, (uint32_t *)&slot, sizeof(slot)) || slot.magic != CRASH_LOG_MAGIC) {
+        return false;
+    }
+    LogRing *ring = new (std::nothrow) LogRing;
+    bool read = ring && ESP.flashRead(address + sizeof(slot), (uint32_t *)ring, sizeof(LogRing));
+    ESP.flashEraseSector(CRASH_LOG_SECTOR);
+    if (!read || slot.check != slot_check(&slot, ring)) {
+        delete ring;
+        MIE_LOG_WARNING("Crash log unreadable");
+        return false;
+    }
+
+    if (slot.reason == REASON_SOFT_WDT_RST) {
+        snprintf(reset_reason, sizeof(reset_reason), "software watchdog at 0x%08x", slot.epc1);
+    } else {
+        snprintf(reset_reason, sizeof(reset_reason), "exception %u at 0x%08x", slot.exccause, slot.epc1);
+    }
+    if (crash_log_write(ring, slot.firmware == firmware_id)) {
+        MIE_LOG("Crash log saved to " CRASH_LOG_FILE);
+    } else {
+        MIE_LOG_ERROR("Error saving crash log");
+    }
+    delete ring;
+    return true;
+}
+
+// a restart crash_log_restart() asked for, its lines go back in the log
+static bool crash_log_load_restart() {
+    crash_rtc_t rtc;
+    if (!ESP.rtcUserMemoryRead(CRASH_LOG_RTC_OFFSET, (uint32_t *)&rtc, sizeof(rtc)) ||
+            rtc.magic != CRASH_LOG_MAGIC || rtc.check != rtc_check(&rtc)) {
+        return false;
+    }
+    uint32_t magic = 0;
+    ESP.rtcUserMemoryWrite(CRASH_LOG_RTC_OFFSET, &magic, sizeof(magic));
+
+    rtc.why[sizeof(rtc.why) - 1] = 0x00;
+    rtc.tail[sizeof(rtc.tail) - 1] = 0x00;
+    snprintf(reset_reason, sizeof(reset_reason), "restart: %s", rtc.why);
+    for (char *line = strtok(rtc.tail, "\r\n"); line; line = strtok(nullptr, "\r\n")) {
+        Debug.printf("Before restart: %s\r\n", line);
+    }
+    return true;
+}
+
+void crash_log_init() {
+    firmware_id = fnv1a(FNV1A_BASIS, GIT_DESCRIBE GIT_HASH, sizeof(GIT_DESCRIBE GIT_HASH)) ^ ESP.getSketchSize();
+
+    const rst_info *info = ESP.getResetInfoPtr();
+    bool restarted = crash_log_load_restart();
+    if (!crash_log_load() && !restarted) {
+        switch (info->reason) {
+            case REASON_DEFAULT_RST:
+                strlcpy(reset_reason, "power on", sizeof(reset_reason));
+                break;
+            case REASON_EXT_SYS_RST:
+                strlcpy(reset_reason, "reset pin", sizeof(reset_reason));
+                break;
+            case REASON_WDT_RST:
+                strlcpy(reset_reason, "hardware watchdog", sizeof(reset_reason));
+                break;
+            case REASON_EXCEPTION_RST:
+                snprintf(reset_reason, sizeof(reset_reason), "exception %u at 0x%08x", info->exccause, info->epc1);
+                break;
+            case REASON_SOFT_WDT_RST:
+                snprintf(reset_reason, sizeof(reset_reason), "software watchdog at 0x%08x", info->epc1);
+                break;
+            default:
+                strlcpy(reset_reason, "restart", sizeof(reset_reason));
+                break;
+        }
+    }
+    MIE_LOG("Last reset: %s", reset_reason);
+}
+
+void crash_log_restart(const char *why) {
+    static crash_rtc_t rtc;
+    memset(&rtc, 0, sizeof(rtc));
+    rtc.magic = CRASH_LOG_MAGIC;
+    rtc.uptime = millis();
+    strlcpy(rtc.why, why, sizeof(rtc.why));
+
+    // count back the newest lines that fit, then copy them oldest first
+    const LogRing &ring = Debug.ring();
+    char line[LOG_LINE_LENGTH];
+    uint32_t end = ring.first() + ring.count();
+    uint32_t start = end;
+    size_t used = 0;
+    while (start > ring.first()) {
+        uint32_t seq = start - 1;
+        if (!Debug.readLine(seq, line, sizeof(line)) || used + strlen(line) >= sizeof(rtc.tail)) {
+            break;
+        }
+        used += strlen(line);
+        start--;
+    }
+    used = 0;
+    for (uint32_t seq = start; seq < end && Debug.readLine(seq, line, sizeof(line));) {
+        size_t length = strlen(line);
+        memcpy(&rtc.tail[used], line, length);
+        used += length;
+    }
+
+    rtc.check = rtc_check(&rtc);
+    ESP.rtcUserMemoryWrite(CRASH_LOG_RTC_OFFSET, (uint32_t *)&rtc, sizeof(rtc));
+    ESP.restart();
+}
+
+const char *crash_log_reset_reason() {
+    return reset_reason;
+}
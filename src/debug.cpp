@@ -1,24 +1,117 @@
 #include "debug.h"
 
-#include <Ticker.h>
 #include <stdio.h>
 #include <xlogger.h>
 
+#include "counters.h"
+#include "crash_log.h"
+#include "heap_tracker.h"
 #include "homekit.h"
+#include "metrics.h"
 #include "mqtt.h"
+#include "profiler.h"
+#include "scheduler.h"
 #include "settings.h"
+#include "stack_monitor.h"
 
 xLogger Debug;
+static LogSyslogSink syslogSink;
 
-#define STATS_INTERVAL 11
-static Ticker statsTicker;
+#define STATS_INTERVAL 11000
+#define STATS_BUDGET 20000
 
 static char *heapFreeTopic;
 static char *heapMaxTopic;
 static char *stackFreeTopic;
 static char *homeKitClients;
+static char *loopP50Topic;
+static char *loopP99Topic;
+static char *loopMaxTopic;
+static char *heapFragmentationTopic;
+static char *heapTagTopics[HEAP_TAG_COUNT];
+static char *counterTopics[COUNTER_COUNT];
+
+static const char *name;
+
+static double metric_log_dropped(uint8_t index) {
+    return index < Debug.sinkCount() ? Debug.sink(index)->dropped : NAN;
+}
+
+static const char *metric_log_sink(uint8_t index) {
+    return index < Debug.sinkCount() ? Debug.sink(index)->name : "";
+}
+
+static const metric_t log_dropped_metric = {
+    "mel_log_dropped_lines_total", METRIC_COUNTER, "Log lines a destination had no room for",
+    metric_log_dropped, nullptr, "sink", XLOGGER_MAX_SINKS, metric_log_sink,
+};
+
+static void debug_publish_stats() {
+    if (!settings.debug) {
+        return;
+    }
+
+    HeapTag tag(HEAP_TAG_MQTT);
+    char str[11];
+    snprintf(str, sizeof(str), "%u", ESP.getFreeHeap());
+    mqtt.publish(heapFreeTopic, str);
+    snprintf(str, sizeof(str), "%u", ESP.getMaxFreeBlockSize());
+    mqtt.publish(heapMaxTopic, str);
+    snprintf(str, sizeof(str), "%u", stack_min_free());
+    mqtt.publish(stackFreeTopic, str);
+    // N * 1000 to scale it similar to memory values
+    snprintf(str, sizeof(str), "%d", homekit_clients_count() * 1000);
+    mqtt.publish(homeKitClients, str);
+    // loop() iteration times in microseconds
+    snprintf(str, sizeof(str), "%u", profiler_percentile(PROFILER_LOOP, 50));
+    mqtt.publish(loopP50Topic, str);
+    snprintf(str, sizeof(str), "%u", profiler_percentile(PROFILER_LOOP, 99));
+    mqtt.publish(loopP99Topic, str);
+    snprintf(str, sizeof(str), "%u", profiler_histogram(PROFILER_LOOP)->max);
+    mqtt.publish(loopMaxTopic, str);
+    snprintf(str, sizeof(str), "%u", ESP.getHeapFragmentation());
+    mqtt.publish(heapFragmentationTopic, str);
+    // live bytes per subsystem
+    for (uint8_t i = 0; i < HEAP_TAG_COUNT; i++) {
+        snprintf(str, sizeof(str), "%u", heap_tag_stats((heap_tag_t)i)->live);
+        mqtt.publish(heapTagTopics[i], str);
+    }
+    for (uint8_t i = 0; i < COUNTER_COUNT; i++) {
+        snprintf(str, sizeof(str), "%u", counters_get((counter_t)i));
+        mqtt.publish(counterTopics[i], str);
+    }
+}
+
+// topics and task are set up the first time stats are enabled and stay,
+// the task does nothing while they are disabled
+static void debug_start_stats() {
+    static bool started = false;
+    if (started) {
+        return;
+    }
+    started = true;
+
+    asprintf(&heapFreeTopic, "debug/%s/heap_free", name);
+    asprintf(&heapMaxTopic, "debug/%s/heap_max", name);
+    asprintf(&stackFreeTopic, "debug/%s/stack_free", name);
+    asprintf(&homeKitClients, "debug/%s/homekit_clients", name);
+    asprintf(&loopP50Topic, "debug/%s/loop_p50", name);
+    asprintf(&loopP99Topic, "debug/%s/loop_p99", name);
+    asprintf(&loopMaxTopic, "debug/%s/loop_max", name);
+    asprintf(&heapFragmentationTopic, "debug/%s/heap_fragmentation", name);
+    for (uint8_t i = 0; i < HEAP_TAG_COUNT; i++) {
+        asprintf(&heapTagTopics[i], "debug/%s/heap_%s", name, heap_tag_name((heap_tag_t)i));
+    }
+    for (uint8_t i = 0; i < COUNTER_COUNT; i++) {
+        asprintf(&counterTopics[i], "debug/%s/%s", name, counters_name((counter_t)i));
+    }
+
+    scheduler_every("stats", STATS_INTERVAL, SCHEDULER_PRIORITY_LOW, STATS_BUDGET, debug_publish_stats);
+}
 
 void debug_init(const char ssid[]) {
+    name = ssid;
+
 #ifdef MIE_DEBUG
     Serial.println("Initializing remote debug...");
 
@@ -28,28 +121,29 @@ void debug_init(const char ssid[]) {
     Debug.setTimeFormat(ltUTCTime);
     Debug.setSerial(&Serial);
     Debug.enableSerial(true);
+    Debug.setBinaryLog(true);
+    // levels are filtered when compiling, see MIE_LOG_LEVEL
+    Debug.setFilterDebugLevel(llDebug);
+    Debug.addSink(&syslogSink);
+    syslogSink.begin(settings.syslog_server, settings.syslog_port, name, "mel");
     MIE_LOG("%s remote log connected", ssid);
 #endif
+    metrics_register(&log_dropped_metric);
+    crash_log_init();
 
     if (settings.debug) {
         MIE_LOG("Memory stats reporting enabled");
-        asprintf(&heapFreeTopic, "debug/%s/heap_free", ssid);
-        asprintf(&heapMaxTopic, "debug/%s/heap_max", ssid);
-        asprintf(&stackFreeTopic, "debug/%s/stack_free", ssid);
-        asprintf(&homeKitClients, "debug/%s/homekit_clients", ssid);
-
-        statsTicker.attach_scheduled(STATS_INTERVAL, [] {
-            char str[6];
-            snprintf(str, sizeof(str), "%u", ESP.getFreeHeap());
-            mqtt.publish(heapFreeTopic, str);
-            snprintf(str, sizeof(str), "%u", ESP.getMaxFreeBlockSize());
-            mqtt.publish(heapMaxTopic, str);
-            snprintf(str, sizeof(str), "%u", ESP.getFreeContStack());
-            mqtt.publish(stackFreeTopic, str);
-            // N * 1000 to scale it similar to memory values
-            snprintf(str, sizeof(str), "%d", homekit_clients_count() * 1000);
-            mqtt.publish(homeKitClients, str);
-        });
+        debug_start_stats();
+    }
+}
+
+void debug_reload() {
+    syslogSink.begin(settings.syslog_server, settings.syslog_port, name, "mel");
+    if (settings.debug) {
+        MIE_LOG("Memory stats reporting enabled");
+        debug_start_stats();
+    } else {
+        MIE_LOG("Memory stats reporting disabled");
     }
 }
 
@@ -60,3 +154,7 @@ void logger_set_serial_enabled(bool enabled) {
 void debug_loop() {
     Debug.handle();
 }
+
+bool debug_log_line(uint32_t *position, char *str, size_t size) {
+    return Debug.readLine(*position, str, size);
+}
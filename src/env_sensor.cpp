@@ -2,17 +2,21 @@
 #include <Adafruit_Sensor.h>
 #include <DHT.h>
 #include <DHT_U.h>
-#include <Ticker.h>
 #include <Wire.h>
 
 #include "accessory.h"
 #include "debug.h"
 #include "env_sensor.h"
+#include "heap_tracker.h"
 #include "heatpump_client.h"
+#include "metrics.h"
 #include "mqtt.h"
+#include "scheduler.h"
 #include "settings.h"
 
-#define SAMPLE_INTERVAL 10
+#define SAMPLE_INTERVAL 10000
+// a DHT22 read bit-bangs for ~5ms, plus the MQTT publishes
+#define SAMPLE_BUDGET 50000
 
 static Adafruit_BME280 bme;
 
@@ -23,10 +27,13 @@ static DHT_Unified::Humidity dhtHumidity = dht.humidity();
 static Adafruit_Sensor *temperatureSensor = nullptr;
 static Adafruit_Sensor *humiditySensor = nullptr;
 
-static Ticker ticker;
-
 char env_sensor_status[30] = {0};
 
+// last reading
+static float temperature = NAN;
+static float humidity = NAN;
+static float dewPoint = NAN;
+
 static double dew_point(double t, double r) {
     // Magnus-Tetens approximation
     double a = 17.27;
@@ -36,14 +43,15 @@ static double dew_point(double t, double r) {
 }
 
 static void env_sensor_update() {
+    HeapTag tag(HEAP_TAG_SENSOR);
     sensors_event_t temperatureEvent;
     temperatureSensor->getEvent(&temperatureEvent);
     sensors_event_t humidityEvent;
     humiditySensor->getEvent(&humidityEvent);
 
-    float temperature = temperatureEvent.temperature;
-    float humidity = humidityEvent.relative_humidity;
-    float dewPoint = dew_point(temperature, humidity);
+    temperature = temperatureEvent.temperature;
+    humidity = humidityEvent.relative_humidity;
+    dewPoint = dew_point(temperature, humidity);
 
     sensor_t sensor;
     temperatureSensor->getSensor(&sensor);
@@ -72,6 +80,24 @@ static void env_sensor_update() {
     }
 }
 
+static double metric_temperature(uint8_t index) {
+    return temperature;
+}
+
+static double metric_humidity(uint8_t index) {
+    return humidity;
+}
+
+static double metric_dew_point(uint8_t index) {
+    return dewPoint;
+}
+
+static const metric_t metrics[] = {
+    {"mel_sensor_temperature_celsius", METRIC_GAUGE, "Temperature from the external sensor", metric_temperature},
+    {"mel_sensor_humidity_percent", METRIC_GAUGE, "Relative humidity from the external sensor", metric_humidity},
+    {"mel_sensor_dew_point_celsius", METRIC_GAUGE, "Dew point from the external sensor", metric_dew_point},
+};
+
 void env_sensor_init() {
     sensors_event_t temperatureEvent;
     sensors_event_t humidityEvent;
@@ -120,7 +146,10 @@ void env_sensor_init() {
     }
 
     if (temperatureSensor && humiditySensor) {
-        ticker.attach_scheduled(SAMPLE_INTERVAL, env_sensor_update);
+        scheduler_every("env sensor", SAMPLE_INTERVAL, SCHEDULER_PRIORITY_LOW, SAMPLE_BUDGET, env_sensor_update);
+        for (const metric_t &metric : metrics) {
+            metrics_register(&metric);
+        }
     } else {
         MIE_LOG("No temperature and humidity sensors found");
     }
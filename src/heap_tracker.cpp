@@ -0,0 +1,204 @@
+#include "heap_tracker.h"
+
+#include <Arduino.h>
+
+#include "scheduler.h"
+
+static const char *const tag_names[HEAP_TAG_COUNT] = {
+    "system", "web", "homekit", "heatpump", "mqtt", "sensor", "logger",
+};
+
+static heap_tag_t current_tag = HEAP_TAG_SYSTEM;
+static heap_tag_stats_t stats[HEAP_TAG_COUNT];
+static uint32_t untracked = 0;
+
+static heap_sample_t samples[HEAP_SAMPLES];
+static uint8_t sample_next = 0;
+static uint8_t sample_count = 0;
+
+heap_tag_t heap_tag_set(heap_tag_t tag) {
+    heap_tag_t previous = current_tag;
+    current_tag = tag;
+    return previous;
+}
+
+const char *heap_tag_name(heap_tag_t tag) {
+    return tag_names[tag];
+}
+
+const heap_tag_stats_t *heap_tag_stats(heap_tag_t tag) {
+    return &stats[tag];
+}
+
+uint32_t heap_untracked() {
+    return untracked;
+}
+
+static void heap_sample_take() {
+    heap_sample_t *sample = &samples[sample_next];
+    sample->at = millis() / 1000;
+    sample->free = ESP.getFreeHeap();
+    sample->max_block = ESP.getMaxFreeBlockSize();
+    sample->fragmentation = ESP.getHeapFragmentation();
+
+    sample_next = (sample_next + 1) % HEAP_SAMPLES;
+    if (sample_count < HEAP_SAMPLES) {
+        sample_count++;
+    }
+}
+
+uint8_t heap_sample_count() {
+    return sample_count;
+}
+
+const heap_sample_t *heap_sample(uint8_t index) {
+    uint8_t oldest = (sample_next + HEAP_SAMPLES - sample_count) % HEAP_SAMPLES;
+    return &samples[(oldest + index) % HEAP_SAMPLES];
+}
+
+void heap_tracker_init() {
+    heap_sample_take();
+    scheduler_every("heap sample", HEAP_SAMPLE_INTERVAL, SCHEDULER_PRIORITY_LOW, 1000, heap_sample_take);
+}
+
+#ifdef HEAP_TRACKING
+
+// open addressing table of live allocations, the size in the low 24 bits of
+// meta and the tag in the high 8
+struct heap_slot_t {
+    void *ptr;
+    uint32_t meta;
+};
+
+static heap_slot_t slots[HEAP_TRACKER_SLOTS];
+static uint16_t slots_used = 0;
+
+static uint16_t slot_home(void *ptr) {
+    return (uint32_t)(((uintptr_t)ptr >> 3) * 2654435761u) % HEAP_TRACKER_SLOTS;
+}
+
+static int slot_find(void *ptr) {
+    for (uint16_t i = slot_home(ptr), n = 0; n < HEAP_TRACKER_SLOTS; i = (i + 1) % HEAP_TRACKER_SLOTS, n++) {
+        if (slots[i].ptr == ptr) {
+            return i;
+        }
+        if (!slots[i].ptr) {
+            break;
+        }
+    }
+    return -1;
+}
+
+static void credit_free(uint32_t meta) {
+    heap_tag_stats_t *tag = &stats[meta >> 24];
+    tag->live -= meta & 0xffffff;
+    tag->frees++;
+}
+
+// backward shift deletion keeps probe sequences intact without tombstones
+static void slot_remove(uint16_t index) {
+    uint16_t hole = index;
+    uint16_t i = index;
+    for (;;) {
+        i = (i + 1) % HEAP_TRACKER_SLOTS;
+        if (!slots[i].ptr) {
+            break;
+        }
+        uint16_t home = slot_home(slots[i].ptr);
+        bool in_place = hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+        if (!in_place) {
+            slots[hole] = slots[i];
+            hole = i;
+        }
+    }
+    slots[hole].ptr = nullptr;
+    slots_used--;
+}
+
+static bool untrack(void *ptr, uint32_t *meta) {
+    int index = slot_find(ptr);
+    if (index < 0) {
+        return false;
+    }
+    *meta = slots[index].meta;
+    slot_remove(index);
+    return true;
+}
+
+static void track(void *ptr, size_t size) {
+    // a stale entry for a block freed by code that isn't wrapped
+    uint32_t meta;
+    if (untrack(ptr, &meta)) {
+        credit_free(meta);
+    }
+
+    if (slots_used >= HEAP_TRACKER_SLOTS * 3 / 4 || size > 0xffffff) {
+        untracked++;
+        return;
+    }
+
+    uint16_t i = slot_home(ptr);
+    while (slots[i].ptr) {
+        i = (i + 1) % HEAP_TRACKER_SLOTS;
+    }
+    slots[i].ptr = ptr;
+    slots[i].meta = size | (uint32_t)current_tag << 24;
+    slots_used++;
+
+    heap_tag_stats_t *tag = &stats[current_tag];
+    tag->live += size;
+    tag->peak = max(tag->peak, tag->live);
+    tag->allocs++;
+}
+
+extern "C" {
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+void *__wrap_malloc(size_t size) {
+    void *ptr = __real_malloc(size);
+    if (ptr) {
+        track(ptr, size);
+    }
+    return ptr;
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    void *ptr = __real_calloc(count, size);
+    if (ptr) {
+        track(ptr, count * size);
+    }
+    return ptr;
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    void *result = __real_realloc(ptr, size);
+    if (!result && size) {
+        // the original block is untouched
+        return result;
+    }
+
+    uint32_t meta;
+    if (ptr && untrack(ptr, &meta)) {
+        credit_free(meta);
+    }
+    if (result) {
+        track(result, size);
+    }
+    return result;
+}
+
+void __wrap_free(void *ptr) {
+    uint32_t meta;
+    if (ptr && untrack(ptr, &meta)) {
+        credit_free(meta);
+    }
+    __real_free(ptr);
+}
+
+}
+
+#endif
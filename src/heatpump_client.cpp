@@ -1,18 +1,21 @@
 #include <HeatPump.h>
 #include <homekit/characteristics.h>
-#include <Ticker.h>
 
 #include "accessory.h"
+#include "counters.h"
 #include "debug.h"
+#include "heap_tracker.h"
 #include "heatpump_client.h"
 #include "homekit.h"
+#include "metrics.h"
+#include "scheduler.h"
+#include "stack_monitor.h"
 
 HeatPump heatpump;
 
-static Ticker syncTicker;
-
 // slower sync seems to help in avoiding unresponsive homekit accessory
-#define SYNC_INTERVAL 3
+#define SYNC_INTERVAL 3000
+#define SYNC_BUDGET 150000
 
 
 // --- Settings changes
@@ -38,7 +41,7 @@ static void updateThermostatSettings(heatpumpSettings settings) {
     changed |= accessory_set_float(&ch_thermostat_target_temperature, settings.temperature, true);
 
     if (changed) {
-        MIE_LOG(" ⮕ HK therm target mode %d temp %.1f",
+        MIE_LOG_DEBUG(" ⮕ HK therm target mode %d temp %.1f",
                 ch_thermostat_target_heating_cooling_state.value.uint8_value,
                 ch_thermostat_target_temperature.value.float_value);
     }
@@ -70,7 +73,7 @@ static void updateFanSettings(heatpumpSettings settings) {
     }
 
     if (changed) {
-        MIE_LOG(" ⮕ HK fan active %d speed %d auto %d swing %d",
+        MIE_LOG_DEBUG(" ⮕ HK fan active %d speed %d auto %d swing %d",
                 ch_fan_active.value.uint8_value,
                 (int)ch_fan_rotation_speed.value.float_value,
                 ch_fan_target_state.value.uint8_value,
@@ -95,7 +98,7 @@ static void updateDehumidifierSettings(heatpumpSettings settings) {
     }
 
     if (changed) {
-        MIE_LOG(" ⮕ HK dehum active %d swing %d",
+        MIE_LOG_DEBUG(" ⮕ HK dehum active %d swing %d",
                 ch_dehumidifier_active.value.uint8_value,
                 ch_dehumidifier_swing_mode.value.uint8_value);
     }
@@ -133,7 +136,7 @@ static void updateThermostatOperatingStatus(bool operating) {
 
     if (changed) {
         (void)mode;
-        MIE_LOG(" ⮕ HK therm %s temp %.1f", mode, current_temperature);
+        MIE_LOG_DEBUG(" ⮕ HK therm %s temp %.1f", mode, current_temperature);
     }
 }
 
@@ -153,7 +156,7 @@ static void updateFanOperatingStatus(bool operating) {
 
     if (changed) {
         (void)status;
-        MIE_LOG(" ⮕ HK fan %s", status);
+        MIE_LOG_DEBUG(" ⮕ HK fan %s", status);
     }
 }
 
@@ -172,12 +175,13 @@ static void updateDehumidifierOperatingStatus(bool operating) {
     }
 
     if (changed) {
-        MIE_LOG(" ⮕ HK dehum state %d", ch_dehumidifier_current_state.value.uint8_value);
+        MIE_LOG_DEBUG(" ⮕ HK dehum state %d", ch_dehumidifier_current_state.value.uint8_value);
     }
 }
 
 
 static void settingsChanged() {
+    StackProbe probe(STACK_HP_SETTINGS_CHANGED);
     heatpumpSettings settings = heatpump.getSettings();
     MIE_LOG("⬅ HP power %s mode %s target %.1f fan %s v vane %s h vane %s",
             settings.power,
@@ -193,19 +197,88 @@ static void settingsChanged() {
 }
 
 static void statusChanged(heatpumpStatus status) {
-    MIE_LOG("⬅ HP room temp %.1f op %d cmp %d",
+    StackProbe probe(STACK_HP_STATUS_CHANGED);
+    MIE_LOG_DEBUG("⬅ HP room temp %.1f op %d cmp %d",
             status.roomTemperature,
             status.operating,
             status.compressorFrequency);
 
     accessory_set_float(&ch_thermostat_current_temperature, status.roomTemperature, false);
 
+    // the first status after boot only tells whether it was already running
+    static int8_t compressor_running = -1;
+    bool running = status.compressorFrequency > 0;
+    if (running && compressor_running == 0) {
+        counters_add(COUNTER_COMPRESSOR_STARTS);
+    }
+    compressor_running = running;
+
     updateThermostatOperatingStatus(status.operating);
     updateFanOperatingStatus(status.operating);
     updateDehumidifierOperatingStatus(status.operating);
 }
 
 
+// time operating since the last sync, in whole seconds
+static void countRuntime() {
+    static uint32_t last = millis();
+    static uint32_t operating_ms = 0;
+    uint32_t now = millis();
+    if (heatpump.isConnected() && heatpump.getOperating()) {
+        operating_ms += now - last;
+        counters_add(COUNTER_RUNTIME, operating_ms / 1000);
+        operating_ms %= 1000;
+    }
+    last = now;
+}
+
+
+// --- Metrics
+static metrics_histogram_t sync_durations;
+
+static double metric_connected(uint8_t index) {
+    return heatpump.isConnected();
+}
+
+static double metric_power(uint8_t index) {
+    return heatpump.isConnected() ? heatpump.getPowerSettingBool() : NAN;
+}
+
+static double metric_operating(uint8_t index) {
+    return heatpump.isConnected() ? heatpump.getOperating() : NAN;
+}
+
+static double metric_room_temperature(uint8_t index) {
+    return heatpump.isConnected() ? heatpump.getRoomTemperature() : NAN;
+}
+
+static double metric_target_temperature(uint8_t index) {
+    return heatpump.isConnected() ? heatpump.getTemperature() : NAN;
+}
+
+static double metric_compressor_frequency(uint8_t index) {
+    return heatpump.isConnected() ? heatpump.getStatus().compressorFrequency : NAN;
+}
+
+static const metrics_histogram_t *metric_sync_durations(uint8_t index) {
+    return &sync_durations;
+}
+
+static const metric_t metrics[] = {
+    {"mel_heatpump_connected", METRIC_GAUGE, "Whether the heat pump answers", metric_connected},
+    {"mel_heatpump_power", METRIC_GAUGE, "Heat pump power setting", metric_power},
+    {"mel_heatpump_operating", METRIC_GAUGE, "Whether the heat pump is heating or cooling", metric_operating},
+    {"mel_heatpump_room_temperature_celsius", METRIC_GAUGE, "Room temperature measured by the heat pump",
+            metric_room_temperature},
+    {"mel_heatpump_target_temperature_celsius", METRIC_GAUGE, "Heat pump target temperature",
+            metric_target_temperature},
+    {"mel_heatpump_compressor_frequency_hertz", METRIC_GAUGE, "Heat pump compressor frequency",
+            metric_compressor_frequency},
+    {"mel_heatpump_sync_duration_seconds", METRIC_HISTOGRAM, "Time taken by a sync with the heat pump",
+            nullptr, metric_sync_durations},
+};
+
+
 bool heatpump_init() {
     MIE_LOG("Connecting to heat pump... disabling serial logging");
     logger_set_serial_enabled(false);
@@ -216,16 +289,19 @@ bool heatpump_init() {
     heatpump.enableExternalUpdate();
     heatpump.disableAutoUpdate();
 
-    syncTicker.attach_scheduled(SYNC_INTERVAL, [] {
-        unsigned long start = millis();
+    scheduler_every("hp sync", SYNC_INTERVAL, SCHEDULER_PRIORITY_NORMAL, SYNC_BUDGET, [] {
+        HeapTag tag(HEAP_TAG_HEATPUMP);
+        StackProbe probe(STACK_HP_SYNC);
         if (heatpump.isConnected()) {
+            uint32_t start = micros();
             heatpump.sync();
-            int diff = millis() - start;
-            if (diff > 150) {
-                MIE_LOG("HP sync %dms", diff);
-            }
+            metrics_observe(&sync_durations, micros() - start);
         }
+        countRuntime();
     });
+    for (const metric_t &metric : metrics) {
+        metrics_register(&metric);
+    }
 
     delay(100);
     if (heatpump.connect(&Serial)) {
@@ -234,7 +310,7 @@ bool heatpump_init() {
     } else {
         Serial.begin(115200);
         logger_set_serial_enabled(true);
-        MIE_LOG("Heat pump connection failed, serial logging resumed");
+        MIE_LOG_WARNING("Heat pump connection failed, serial logging resumed");
         return false;
     }
 }
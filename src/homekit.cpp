@@ -2,26 +2,36 @@
 
 #include <Arduino.h>
 #include <ESP8266mDNS.h>
-#include <Ticker.h>
 #include <arduino_homekit_server.h>
 #include <homekit/characteristics.h>
 #include <homekit/types.h>
 
 #include "accessory.h"
 #include "debug.h"
+#include "heap_tracker.h"
 #include "heatpump_client.h"
 #include "homekit.h"
 #include "led_status_patterns.h"
+#include "metrics.h"
+#include "scheduler.h"
+#include "stack_monitor.h"
 
 static char serial[7];
-static Ticker updateTicker;
-static Ticker keepAliveTicker;
+static scheduler_task_t *updateTask;
+static metrics_histogram_t update_durations;
 
 #define ANNOUNCE_INTERVAL 1000
+#define ANNOUNCE_BUDGET 5000
 
 // throttle updates to the heat pump to try to send more settings at once and
 // avoid conflicts when changing multiple settings from HomeKit
 #define UPDATE_INTERVAL 5000
+// update() waits for the unit to acknowledge the settings
+#define UPDATE_BUDGET 1200000
+
+// controllers follow a write with more writes and reads, keep housekeeping
+// out of the way meanwhile
+#define REQUEST_DEFER 2000
 
 static heatpumpSettings _settingsForCurrentState() {
     heatpumpSettings settings;
@@ -76,24 +86,30 @@ static heatpumpSettings _settingsForCurrentState() {
     return settings;
 }
 
+static void updateHeatPump() {
+    HeapTag tag(HEAP_TAG_HEATPUMP);
+    StackProbe probe(STACK_HP_UPDATE);
+    uint32_t start = micros();
+
+    heatpumpSettings settings = _settingsForCurrentState();
+    heatpump.setSettings(settings);
+    MIE_LOG("⮕ HP updating power %s mode %s target %.1f fan %s v vane %s h vane %s",
+            settings.power,
+            settings.mode,
+            settings.temperature,
+            settings.fan,
+            settings.vane,
+            settings.wideVane);
+    heatpump.update();
+
+    uint32_t duration = micros() - start;
+    metrics_observe(&update_durations, duration);
+    MIE_LOG_DEBUG("HP update %ums", duration / 1000);
+}
+
 static void scheduleHeatPumpUpdate() {
-    updateTicker.once_ms_scheduled(UPDATE_INTERVAL, [] {
-        unsigned long start = millis();
-
-        heatpumpSettings settings = _settingsForCurrentState();
-        heatpump.setSettings(settings);
-        MIE_LOG("⮕ HP updating power %s mode %s target %.1f fan %s v vane %s h vane %s",
-                settings.power,
-                settings.mode,
-                settings.temperature,
-                settings.fan,
-                settings.vane,
-                settings.wideVane);
-        heatpump.update();
-
-        (void)start;
-        MIE_LOG("HP update %dms", millis() - start);
-    });
+    scheduler_defer(REQUEST_DEFER);
+    scheduler_run_in(updateTask, UPDATE_INTERVAL);
 }
 
 static void _updateFanState(bool active) {
@@ -113,6 +129,7 @@ static void _updateFanState(bool active) {
 }
 
 static void set_target_heating_cooling_state(homekit_value_t value) {
+    StackProbe probe(STACK_HK_TARGET_STATE);
     uint8_t targetState = value.uint8_value;
     accessory_set_uint8(&ch_thermostat_target_heating_cooling_state, targetState, false);
     MIE_LOG("⬅ HK therm target state %d", targetState);
@@ -127,6 +144,7 @@ static void set_target_heating_cooling_state(homekit_value_t value) {
 }
 
 static void set_target_temperature(homekit_value_t value) {
+    StackProbe probe(STACK_HK_TARGET_TEMPERATURE);
     float targetTemperature = value.float_value;
     accessory_set_float(&ch_thermostat_target_temperature, targetTemperature, false);
     MIE_LOG("⬅ HK target temp %.1f", targetTemperature);
@@ -135,6 +153,7 @@ static void set_target_temperature(homekit_value_t value) {
 }
 
 static void set_dehumidifier_active(homekit_value_t value) {
+    StackProbe probe(STACK_HK_DEHUMIDIFIER_ACTIVE);
     uint8_t active = value.uint8_value;
     accessory_set_uint8(&ch_dehumidifier_active, active, false);
     MIE_LOG("⬅ HK dehum active %d", active);
@@ -149,6 +168,7 @@ static void set_dehumidifier_active(homekit_value_t value) {
 }
 
 static void set_swing_horizontal(homekit_value_t value) {
+    StackProbe probe(STACK_HK_HORIZONTAL_SWING);
     uint8_t swing = value.uint8_value;
     accessory_set_uint8(&ch_dehumidifier_swing_mode, swing, false);
     MIE_LOG("⬅ HK hor swing %d", swing);
@@ -157,6 +177,7 @@ static void set_swing_horizontal(homekit_value_t value) {
 }
 
 static void set_fan_active(homekit_value_t value) {
+    StackProbe probe(STACK_HK_FAN_ACTIVE);
     uint8_t active = value.uint8_value;
     accessory_set_uint8(&ch_fan_active, active, false);
     MIE_LOG("⬅ HK fan active %d", active);
@@ -171,6 +192,7 @@ static void set_fan_active(homekit_value_t value) {
 }
 
 static void set_fan_speed(homekit_value_t value) {
+    StackProbe probe(STACK_HK_FAN_SPEED);
     float speed = roundf(value.float_value);
     if (accessory_set_float(&ch_fan_rotation_speed, speed, false)) {
         MIE_LOG("⬅ HK fan speed %d", (int)speed);
@@ -189,6 +211,7 @@ static void set_fan_speed(homekit_value_t value) {
 }
 
 static void set_fan_auto_mode(homekit_value_t value) {
+    StackProbe probe(STACK_HK_FAN_AUTO);
     uint8_t mode = value.uint8_value;
     accessory_set_uint8(&ch_fan_target_state, mode, false);
     MIE_LOG("⬅ HK fan auto %d", mode);
@@ -201,6 +224,7 @@ static void set_fan_auto_mode(homekit_value_t value) {
 }
 
 static void set_fan_swing(homekit_value_t value) {
+    StackProbe probe(STACK_HK_VERTICAL_SWING);
     uint8_t swing = value.uint8_value;
     accessory_set_uint8(&ch_fan_swing_mode, swing, false);
     MIE_LOG("⬅ HK ver swing %d", swing);
@@ -208,6 +232,77 @@ static void set_fan_swing(homekit_value_t value) {
 }
 
 
+bool homekit_control_accepts(const homekit_characteristic_t *characteristic, homekit_value_t value) {
+    float number;
+    switch (characteristic->format) {
+        case homekit_format_uint8:
+            number = value.uint8_value;
+            break;
+        case homekit_format_float:
+            number = value.float_value;
+            if (!isfinite(number)) {
+                return false;
+            }
+            break;
+        default:
+            return false;
+    }
+    if (value.format != characteristic->format) {
+        return false;
+    }
+    if ((characteristic->min_value && number < *characteristic->min_value) ||
+            (characteristic->max_value && number > *characteristic->max_value)) {
+        return false;
+    }
+    if (characteristic->valid_values.count) {
+        for (int i = 0; i < characteristic->valid_values.count; i++) {
+            if (characteristic->valid_values.values[i] == value.uint8_value) {
+                return true;
+            }
+        }
+        return false;
+    }
+    return true;
+}
+
+bool homekit_control(homekit_characteristic_t *characteristic, homekit_value_t value) {
+    // setters are installed once the accessory is paired
+    if (!updateTask || !homekit_control_accepts(characteristic, value)) {
+        return false;
+    }
+    characteristic->setter(value);
+    homekit_characteristic_notify(characteristic, characteristic->value);
+    return true;
+}
+
+heatpumpSettings homekit_desired_settings() {
+    return _settingsForCurrentState();
+}
+
+bool homekit_update_pending() {
+    return updateTask && updateTask->armed;
+}
+
+
+static double metric_paired(uint8_t index) {
+    return homekit_is_paired();
+}
+
+static double metric_clients(uint8_t index) {
+    return homekit_clients_count();
+}
+
+static const metrics_histogram_t *metric_update_durations(uint8_t index) {
+    return &update_durations;
+}
+
+static const metric_t metrics[] = {
+    {"mel_homekit_paired", METRIC_GAUGE, "Whether the accessory is paired", metric_paired},
+    {"mel_homekit_clients", METRIC_GAUGE, "Connected HomeKit controllers", metric_clients},
+    {"mel_heatpump_update_duration_seconds", METRIC_HISTOGRAM,
+            "Time taken to send HomeKit changes to the heat pump", nullptr, metric_update_durations},
+};
+
 // the loop function will be called during the pairing process
 void homekit_init(const char *ssid, std::function<void()> loop) {
     MIE_LOG("Starting HomeKit server...");
@@ -234,6 +329,11 @@ void homekit_init(const char *ssid, std::function<void()> loop) {
     // or on firmware updates
     homekit_update_config_number();
 
+    updateTask = scheduler_once("hp update", SCHEDULER_PRIORITY_HIGH, UPDATE_BUDGET, updateHeatPump);
+    for (const metric_t &metric : metrics) {
+        metrics_register(&metric);
+    }
+
     ch_thermostat_target_heating_cooling_state.setter = set_target_heating_cooling_state;
     ch_thermostat_target_temperature.setter = set_target_temperature;
 
@@ -247,7 +347,8 @@ void homekit_init(const char *ssid, std::function<void()> loop) {
 
     // Keep HomeKit connection alive
     // https://github.com/Mixiaoxiao/Arduino-HomeKit-ESP8266/issues/9
-    keepAliveTicker.attach_ms_scheduled(ANNOUNCE_INTERVAL, []() {
+    scheduler_every("mdns announce", ANNOUNCE_INTERVAL, SCHEDULER_PRIORITY_NORMAL, ANNOUNCE_BUDGET, []() {
+        HeapTag tag(HEAP_TAG_HOMEKIT);
         MDNS.announce();
     });
 }
@@ -1,322 +1,180 @@
-#include <sys/pgmspace.h>
+#include <Arduino.h>
 
 // generated file, edit web/index.html
-const char* index_html PROGMEM = R"====(
-<!DOCTYPE html>
-<html lang='en'>
-<head>
-<title>MEL Heat Pump</title>
-<meta charset='utf-8'>
-<meta name='viewport' content='width=device-width,initial-scale=1'/>
-<style>
-body {
-  text-align: center;
-  font-family:sans-serif;
-}
-
-div, input {
-  padding: 5px;
-  font-size: 1em;
-  margin: 5px 0;
-  box-sizing: border-box;
-}
-
-input, button {
-  border-radius: .3rem;
-  width: 100%
-}
-
-button {
-  cursor: pointer;
-  border: 0;
-  background-color: #1fa3ec;
-  color: #fff;
-  line-height: 2.4rem;
-  font-size: 1.2rem;
-  width: 100%
-}
-
-button:disabled {
-  background-color: lightgray;
-}
-
-input[type='file'] {
-  border:1px solid #1fa3ec
-}
-
-button.danger {
-  background-color: #dc3630;
-}
-
-.wrap {
-  text-align: left;
-  display: inline-block;
-  min-width: 260px;
-  max-width: 400px
-}
-
-dl {
-  width: 100%;
-  overflow: hidden;
-}
-
-dt {
-  display: inline-block;
-  min-width: 100px;
-  font-weight: bold;
-}
-
-dd {
-  display: inline;
-  margin: 0;
-}
-
-dd:after {
-  display: block;
-  content: '';
-}
-
-h2 {
-  padding-top: 20px;
-}
-
-form {
-  margin-bottom: 10px;
-}
-
-form#upload_form {
-  margin-bottom: 40px;
-}
-
-.caption {
-  font-size: small;
-  color: darkgray;
-}
-
-.footer {
-  margin-top: 40px;
-  border-top: solid 1px darkgray;
-  padding-top: 8px;
-}
-
-.footer a {
-  font-size: smaller;
-  color: darkgray;
-}
-
-@media (prefers-color-scheme: dark) {
-  body {
-    color: #ddd;
-    background: #121212;
-  }
-  button:disabled {
-    background-color: #333;
-  }
-}
-</style>
-</head>
-<body>
-<script>
-function _(s) {
-    if (s.charAt(0) === '#') {
-        return document.querySelector(s)
-    } else {
-        return document.querySelectorAll(s)
-    }
-}
-
-function rebootingTimer(button, msg) {
-    let counter = 30
-    button.disabled = true
-    setInterval(function() {
-        if (counter >= 0) {
-            button.innerHTML = msg + counter + "s"
-            counter -= 1
-        } else {
-            window.location.reload(1)
-        }
-    }, 1000);
-}
-
-function upload(e) {
-    e.preventDefault()
-    let form = _('#upload_form')
-    let button = form.querySelector('button')
-    button.innerHTML = 'Uploading…'
-    button.disabled = true
-
-    let formData = new FormData(form)
-    let request = new XMLHttpRequest()
-    request.onload = function(e) {
-        let response = this.responseText
-        if (response.includes('Update Success')) {
-            rebootingTimer(button, 'Done, rebooting… ')
-        } else {
-            button.style = 'background-color:darkred'
-            button.innerHTML = 'Error: ' + response.substr(response.indexOf(':') + 2)
-        }
-    }
-    request.open('POST', form.action)
-    request.send(formData)
-}
-
-function reboot(e) {
-    e.preventDefault()
-    let form = this
-    let button = this.querySelector('button')
-    let request = new XMLHttpRequest()
-    request.onload = function (e) {
-        if (request.status == 200) {
-            rebootingTimer(button, 'Rebooting… ')
-        }
-    }
-    request.open('POST', form.action)
-    request.send()
-}
-
-function confirm(button) {
-    var origContent = button.innerHTML
-    var clickTime
-    var tid
-    var state = 0
-
-    function cancel() {
-        state = 0
-        button.innerHTML = origContent
-    }
-
-    return function(event) {
-        if (state == 0) {
-            event.preventDefault()
-            state = 1
-            clickTime = +new Date()
-            button.innerHTML = 'Are you sure?'
-            tid = setTimeout(cancel, 3000)
-        } else if (new Date() - clickTime < 500) {
-            event.preventDefault()
-        } else {
-            clearTimeout(tid)
-        }
-    }
-}
-
-function saveSettings(e) {
-    e.preventDefault()
-    let formData = new FormData(this)
-    let button = this.querySelector('button')
-    let request = new XMLHttpRequest()
-    request.onload = function(e) {
-        if (request.status == 200) {
-            rebootingTimer(button, 'Saved, rebooting…')
-        }
-    }
-    request.open('POST', '/_settings')
-    request.send(formData)
-}
-
-function loadSettings() {
-    let request = new XMLHttpRequest()
-    request.onload = function (ev) {
-        let json = JSON.parse(request.response)
-        for (let key in json) {
-            let el = _('[name=' + key + ']')[0];
-            if (el) {
-                el.value = json[key]
-            }
-        }
-    }
-    request.open('GET', '/_settings')
-    request.send()
-}
-
-function loadStatus() {
-    let request = new XMLHttpRequest()
-    request.onload = function (ev) {
-        let json = JSON.parse(request.response)
-        for (let key in json) {
-            let el = _('#status_' + key);
-            if (el) {
-                el.innerHTML = json[key]
-            }
-        }
-        document.title = json['title']
-    }
-    request.open('GET', '/_status')
-    request.send()
-}
-
-window.onload = function () {
-    _('#firmware_file').onchange = function (e) {
-        _('#upload_button').disabled = this.files.lenght === 0
-    }
-
-    _('.needsConfirm').forEach(function (button) {
-        button.onclick = confirm(button)
-    })
-
-    _('#upload_form').onsubmit = upload
-    _('#reboot_form').onsubmit = reboot
-    _('#unpair_form').onsubmit = reboot
-    _('#reset_wifi_form').onsubmit = reboot
-    _('#settings_form').onsubmit = saveSettings
-
-    loadSettings()
-    loadStatus()
-}
-</script>
-  <div class='wrap'>
-    <h1 id='status_title'>MEL Heat Pump</h1>
-    <dl>
-    <dt>HomeKit:</dt><dd id='status_homekit'></dd>
-    <dt>Heat Pump:</dt><dd id='status_heatpump'></dd>
-    <dt>Env Sensor:</dt><dd id='status_env'></dd>
-    <dt>MQTT:</dt><dd id='status_mqtt'></dd>
-    <dt>Uptime:</dt><dd id='status_uptime'></dd>
-    <dt>Heap:</dt><dd id='status_heap'></dd>
-    <dt>Firmware:</dt><dd id='status_firmware'></dd>
-    </dl>
-    <h2>Settings</h2>
-    <form id='settings_form' action='/_settings' method='post'>
-      <p><label for='mqtt_server'>MQTT Broker</label>
-      <input placeholder='Address' name='mqtt_server' type='text' maxlength=32>
-      <input placeholder='Port' value='1883' name='mqtt_port' type='text' maxlength=6>
-      </p>
-      <p><label for='mqtt_temp'>Environment Sensor</label>
-      <input placeholder='Temperature reporting topic' name='mqtt_temp' type='text' maxlength=80>
-      <input placeholder='Relative humidity reporting topic' name='mqtt_hum' type='text' maxlength=80>
-      <input placeholder='Dew point reporting topic' name='mqtt_dew_point' type='text' maxlength=80>
-      <span class='caption'>If these topics are set, temperature and relative
-        humidity readings will be periodically posted to mqtt. &mdash; This
-        feature requires an external sensor.</p>
-  <!--
-      <p><label for='mqtt_remote_temp'>Remote Temperature</label>
-      <input placeholder='Remote temperature topic' name='mqtt_remote_temp' type='text' maxlength=80>
-      <span class='caption'>An external room sensor can report the temperature for the heat pump
-      thermostat.</p>
-  -->
-      <button>Save Settings</button>
-      <p class='caption'>Saving settings will reboot the ESP.</p>
-    </form>
-    <h2>Firmware Update</h2>
-    <form id='upload_form' action='/_update' method='post' enctype='multipart/form-data'>
-      <input id='firmware_file' name='firmware' type='file' accept='.bin,.bin.gz,.gz'>
-      <button id='upload_button' disabled>Update Firmware</button>
-    </form>
-    <form id='reboot_form' action='/_reboot' method='post'>
-      <button class="needsConfirm">Reboot ESP</button>
-    </form>
-    <form id='reset_wifi_form' action='/_reset_wifi' method='post'>
-      <button class="danger needsConfirm">Reset WiFi Settings</button>
-    </form>
-    <form id='unpair_form' action='/_unpair' method='post'>
-      <button class="danger needsConfirm">Reset HomeKit Pairing</button>
-    </form>
-    <p class="footer">
-    <a href="https://github.com/micampe/mel-heatpump-homekit">
-      github.com/micampe/mel-heatpump-homekit</a>
-    </p>
-  </div>
-</body>
-</html>
-
-)====";
+extern const uint8_t index_html_gz[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xbd, 0x19, 0xed, 0x72, 0x1b, 0xb7,
+    0xf1, 0x3f, 0x9f, 0x02, 0xb6, 0xa7, 0xb9, 0xe3, 0x58, 0x3c, 0x52, 0x52, 0x92, 0xc9, 0x50, 0xa2,
+    0xd2, 0xc4, 0x96, 0xeb, 0xb4, 0x72, 0xec, 0x5a, 0xca, 0x34, 0x1d, 0x8f, 0x47, 0x03, 0x1e, 0x96,
+    0x3c, 0x54, 0xf7, 0x15, 0x00, 0x47, 0x9a, 0x69, 0x3c, 0xd3, 0xa7, 0xe9, 0x83, 0xf5, 0x49, 0xba,
+    0x0b, 0xe0, 0x8e, 0xa0, 0x78, 0x92, 0x9c, 0x26, 0xd3, 0xf1, 0xd8, 0x34, 0xb0, 0x8b, 0xfd, 0xde,
+    0xc5, 0x2e, 0xee, 0xf4, 0xd1, 0xf3, 0xd7, 0xcf, 0xae, 0xfe, 0xfe, 0xe6, 0x9c, 0x65, 0xa6, 0xc8,
+    0xcf, 0x06, 0xa7, 0xf4, 0xc3, 0x72, 0x5e, 0x2e, 0x67, 0x11, 0x94, 0x11, 0x6d, 0x00, 0x17, 0xf8,
+    0x63, 0xa4, 0xc9, 0xe1, 0xec, 0xd5, 0xf9, 0x05, 0x7b, 0x09, 0xdc, 0xb0, 0x37, 0x4d, 0x51, 0x9f,
+    0x8e, 0xdd, 0xe6, 0xe0, 0xb4, 0x00, 0xc3, 0x59, 0x9a, 0x71, 0xa5, 0xc1, 0xcc, 0xa2, 0xc6, 0x2c,
+    0x46, 0x5f, 0x45, 0xed, 0x76, 0xc9, 0x0b, 0x98, 0x45, 0x2b, 0x09, 0xeb, 0xba, 0x52, 0x26, 0x62,
+    0x69, 0x55, 0x1a, 0x28, 0x11, 0x6d, 0x2d, 0x85, 0xc9, 0x66, 0x02, 0x56, 0x32, 0x85, 0x91, 0x5d,
+    0x1c, 0xc8, 0x52, 0x1a, 0xc9, 0xf3, 0x91, 0x4e, 0x79, 0x0e, 0xb3, 0xc3, 0x68, 0x8c, 0x44, 0xb4,
+    0xd9, 0x10, 0x8f, 0x79, 0x25, 0x36, 0xec, 0x9f, 0x03, 0x03, 0x1f, 0xcc, 0x88, 0xe7, 0x72, 0x59,
+    0x4e, 0x59, 0x8a, 0x64, 0x40, 0x9d, 0x0c, 0x16, 0x48, 0x71, 0xb4, 0xe0, 0x85, 0xcc, 0x37, 0x53,
+    0xcd, 0x4b, 0x3d, 0xd2, 0xa0, 0xe4, 0xe2, 0x64, 0xf0, 0x71, 0x20, 0xe4, 0xea, 0x80, 0xc9, 0xb2,
+    0x6e, 0x0c, 0x1e, 0xad, 0xb9, 0x10, 0xb2, 0x5c, 0x4e, 0xd9, 0x17, 0xf5, 0x07, 0x7f, 0x48, 0xcb,
+    0x9f, 0x61, 0xca, 0x0e, 0xa1, 0x38, 0x19, 0x14, 0x5c, 0x2d, 0x65, 0x69, 0x81, 0x6c, 0x72, 0x82,
+    0xec, 0x3e, 0x10, 0xd4, 0xe2, 0xcf, 0x2b, 0x25, 0x40, 0x8d, 0x70, 0x8b, 0x68, 0x5a, 0x72, 0x07,
+    0x6c, 0xde, 0x18, 0x53, 0x95, 0x48, 0xd6, 0x43, 0x15, 0x17, 0xb2, 0xd1, 0x53, 0x96, 0x1c, 0x2b,
+    0x22, 0x67, 0xf5, 0x41, 0xd2, 0x93, 0xc9, 0x1f, 0xf0, 0x4c, 0x87, 0x9c, 0x36, 0x4a, 0x57, 0x6a,
+    0xca, 0xea, 0x4a, 0x3a, 0xd9, 0xdd, 0xe9, 0xa9, 0x65, 0xc9, 0xd3, 0x9b, 0xa5, 0xaa, 0x9a, 0x52,
+    0x8c, 0xd2, 0x2a, 0x27, 0xac, 0x27, 0x87, 0x0b, 0x7e, 0x0c, 0xe9, 0xc9, 0xa0, 0x5d, 0x2f, 0x16,
+    0xa8, 0x56, 0x2e, 0x4b, 0x18, 0x65, 0x20, 0x97, 0x99, 0x99, 0xb2, 0xa3, 0xe4, 0x73, 0xcb, 0x2f,
+    0x54, 0x27, 0x39, 0xba, 0x53, 0x84, 0xa9, 0x90, 0x9a, 0xcf, 0x73, 0x10, 0x24, 0xf8, 0x1e, 0xbf,
+    0x9c, 0x68, 0x2e, 0x15, 0xdf, 0x74, 0x7a, 0xbe, 0x33, 0x9b, 0x1a, 0xbd, 0xb7, 0x90, 0x39, 0x44,
+    0xef, 0x3b, 0x65, 0xa7, 0x87, 0x68, 0x24, 0x5d, 0xe5, 0x52, 0xb4, 0x22, 0x76, 0x0c, 0x12, 0x81,
+    0xa1, 0x03, 0xaa, 0x97, 0xfc, 0x13, 0x91, 0x1e, 0x7f, 0x79, 0x3c, 0x21, 0xe2, 0xc9, 0x5a, 0xf1,
+    0xfa, 0x96, 0x3b, 0x73, 0x58, 0x98, 0x13, 0x74, 0x99, 0xae, 0x73, 0xbe, 0x99, 0xa2, 0xdb, 0xac,
+    0xa2, 0xf3, 0xbc, 0x4a, 0x6f, 0xd0, 0x3d, 0xb2, 0x1c, 0x79, 0x85, 0x8e, 0xbe, 0x9c, 0x90, 0x03,
+    0x0b, 0xfe, 0xa1, 0xdd, 0xf9, 0x7c, 0x82, 0x3b, 0xe4, 0xee, 0x1c, 0x49, 0x06, 0x6a, 0x9f, 0x0c,
+    0xaa, 0x15, 0xa8, 0x45, 0x5e, 0xad, 0xa7, 0x2c, 0x93, 0x42, 0x40, 0x69, 0x83, 0x82, 0x82, 0xe1,
+    0x61, 0x36, 0x87, 0x93, 0x49, 0x17, 0x27, 0x6b, 0x6f, 0xed, 0x79, 0x95, 0x0b, 0x4b, 0x42, 0xec,
+    0x93, 0xd8, 0x86, 0xd0, 0xc4, 0xa1, 0x4c, 0xf9, 0xc2, 0x58, 0x4b, 0x74, 0x88, 0x9e, 0x89, 0xcf,
+    0x80, 0x29, 0x8b, 0x22, 0xc2, 0xcc, 0x8e, 0xb6, 0xc1, 0x39, 0x32, 0x55, 0x8d, 0x1a, 0x5a, 0xce,
+    0x1f, 0x91, 0xb7, 0x2a, 0x10, 0xe6, 0xe8, 0x62, 0xfc, 0xa1, 0x81, 0x0b, 0x12, 0x6c, 0x0b, 0x7d,
+    0xd2, 0xd4, 0x79, 0xc5, 0xc5, 0x75, 0x3f, 0xe6, 0xe7, 0x1e, 0x33, 0x49, 0x79, 0x6d, 0xa4, 0x0d,
+    0xc0, 0x20, 0x4e, 0x74, 0xc1, 0xf3, 0xbc, 0x8b, 0x2d, 0xc1, 0xd5, 0x4d, 0xeb, 0xfa, 0x64, 0x51,
+    0x55, 0x4e, 0x74, 0x4f, 0xd0, 0x4a, 0xe5, 0xa8, 0xf9, 0x70, 0xb7, 0x3b, 0x2e, 0x04, 0x28, 0x18,
+    0xb6, 0xa7, 0x77, 0x14, 0xf9, 0xca, 0xf3, 0xf7, 0xf4, 0x78, 0x8f, 0x00, 0x94, 0x04, 0x3d, 0x22,
+    0xfc, 0xb1, 0x00, 0x21, 0x39, 0x8b, 0x6b, 0x05, 0x0b, 0x50, 0xda, 0x85, 0x10, 0xd6, 0x85, 0x0c,
+    0x0a, 0x70, 0x98, 0x43, 0x1b, 0x8e, 0xb6, 0x28, 0x74, 0xf1, 0x25, 0x44, 0x98, 0x46, 0x94, 0x40,
+    0x47, 0xf4, 0xe7, 0xe4, 0x13, 0xe3, 0xff, 0xc9, 0xf1, 0xf1, 0x31, 0xe1, 0x7e, 0x1c, 0x9c, 0x8e,
+    0x7d, 0xd9, 0x39, 0x1d, 0xfb, 0xfa, 0x47, 0xac, 0xa8, 0x1a, 0xa5, 0x4a, 0xd6, 0xe6, 0x6c, 0xb0,
+    0x68, 0xca, 0xd4, 0x9a, 0xf4, 0x3a, 0xd6, 0x24, 0x89, 0x5c, 0xb0, 0x58, 0x27, 0x54, 0x02, 0xbf,
+    0x31, 0xf1, 0x64, 0xc8, 0x66, 0xb3, 0x19, 0x8b, 0x9e, 0x44, 0x04, 0x52, 0x60, 0x1a, 0x55, 0x32,
+    0x51, 0xa5, 0x4d, 0x81, 0x6e, 0x4f, 0x7e, 0x6a, 0x40, 0x6d, 0x2e, 0x21, 0x87, 0xd4, 0x54, 0x0a,
+    0x4f, 0x0f, 0x3e, 0x32, 0xc8, 0x35, 0x3c, 0x84, 0xf9, 0x4d, 0x9e, 0x5b, 0x64, 0xf2, 0x7c, 0xcb,
+    0x5c, 0xc1, 0x1c, 0x2d, 0x8b, 0xe6, 0xbe, 0x92, 0x05, 0xa8, 0xd8, 0xe9, 0x78, 0xc0, 0x0a, 0xbd,
+    0x24, 0xc6, 0x39, 0x18, 0xac, 0xb6, 0x0d, 0x15, 0x1a, 0x36, 0x63, 0xc7, 0x93, 0x2e, 0x45, 0x5b,
+    0x1b, 0xcc, 0x98, 0x51, 0x0d, 0x0c, 0xb0, 0x68, 0x7f, 0x47, 0x48, 0x2b, 0x9e, 0xc7, 0x2d, 0xe9,
+    0xb8, 0x55, 0xaa, 0x25, 0x70, 0x36, 0x63, 0x13, 0x6b, 0x72, 0x47, 0x43, 0x96, 0x25, 0xa8, 0x97,
+    0x57, 0xaf, 0x2e, 0x90, 0x08, 0xb2, 0x63, 0x4f, 0x3b, 0x4e, 0x4f, 0xd9, 0x63, 0xfd, 0x78, 0xd0,
+    0xae, 0x46, 0x33, 0x76, 0xb8, 0x55, 0x70, 0x2d, 0x4b, 0x51, 0xad, 0x13, 0x4c, 0x03, 0x4e, 0x4c,
+    0x12, 0x05, 0x14, 0xbd, 0xf1, 0xa1, 0x55, 0xeb, 0x80, 0x52, 0x6e, 0x32, 0x3c, 0x09, 0x15, 0x74,
+    0xe1, 0x1d, 0x03, 0x71, 0x86, 0x04, 0x83, 0x61, 0x85, 0x76, 0x79, 0x0e, 0x0b, 0xde, 0xe4, 0x26,
+    0x1e, 0x5a, 0x0d, 0x6d, 0xe8, 0xcf, 0xd0, 0x0f, 0x51, 0x98, 0x0c, 0x91, 0x03, 0xfa, 0xc2, 0x3b,
+    0xb3, 0x58, 0xb7, 0x2c, 0x1f, 0x39, 0x20, 0x62, 0xf6, 0xe8, 0x14, 0xfd, 0x60, 0x69, 0xa1, 0x69,
+    0xff, 0xf3, 0xaf, 0x7f, 0x47, 0x77, 0x59, 0xae, 0xe5, 0xff, 0x9c, 0xe3, 0x45, 0x37, 0x63, 0x25,
+    0xac, 0xd9, 0x0b, 0xbf, 0x8c, 0x69, 0xdf, 0x09, 0xa1, 0x00, 0x19, 0x6b, 0xe3, 0x11, 0x7e, 0x7c,
+    0x75, 0xf1, 0xd2, 0x98, 0xfa, 0xad, 0xdb, 0x44, 0x25, 0x3c, 0x38, 0xa9, 0x4a, 0xe2, 0x48, 0xb2,
+    0xb6, 0x3e, 0x80, 0xd6, 0x8b, 0x0a, 0x74, 0x5d, 0x95, 0x68, 0x42, 0xe4, 0x9b, 0x49, 0x9d, 0xb4,
+    0xeb, 0x2b, 0x2c, 0x9f, 0xd6, 0x4b, 0xed, 0x06, 0xea, 0x90, 0xe6, 0x8d, 0x00, 0x1d, 0xa3, 0x02,
+    0x82, 0x1b, 0x60, 0x97, 0x4d, 0x9a, 0x82, 0xd6, 0xd1, 0xd0, 0x85, 0x62, 0x6f, 0xbc, 0x44, 0xcf,
+    0xab, 0x12, 0x0e, 0xb6, 0xd1, 0x84, 0x2a, 0xb3, 0x28, 0x88, 0x4b, 0xaf, 0xbd, 0x4d, 0x09, 0xb2,
+    0xcd, 0x5e, 0xe6, 0x50, 0x3e, 0x2a, 0x10, 0x51, 0xaf, 0x25, 0xcf, 0x95, 0xa2, 0xe4, 0x8a, 0x30,
+    0x32, 0x3a, 0x31, 0x75, 0x33, 0xd7, 0x46, 0x85, 0x62, 0x0b, 0xf8, 0xf0, 0x7a, 0x11, 0x47, 0x53,
+    0x4c, 0x99, 0xa7, 0xec, 0xc8, 0xc5, 0x79, 0x67, 0x99, 0x1a, 0xca, 0x38, 0x7a, 0xf3, 0xfa, 0xf2,
+    0x2a, 0x3a, 0x70, 0x9e, 0xe4, 0xd6, 0x40, 0x5b, 0xdb, 0x69, 0x28, 0x45, 0xdc, 0x7a, 0x62, 0xb8,
+    0x9f, 0x22, 0x9f, 0x12, 0x41, 0x64, 0xd9, 0xdd, 0xa0, 0xb1, 0xb6, 0xbe, 0x2b, 0x68, 0x7e, 0x8b,
+    0x67, 0x99, 0x93, 0xc7, 0x79, 0xce, 0x6b, 0x60, 0xb8, 0x69, 0x34, 0xd6, 0x0d, 0xac, 0xfe, 0x93,
+    0xfb, 0x7c, 0xf5, 0xf6, 0xb6, 0x97, 0x7e, 0xbd, 0xa1, 0x76, 0x0c, 0x84, 0xb7, 0xd1, 0x42, 0xaa,
+    0xc2, 0x33, 0x20, 0xce, 0x2b, 0xae, 0x58, 0xa5, 0xe4, 0xf2, 0x99, 0xbb, 0xa7, 0x50, 0xee, 0xdb,
+    0x6e, 0xb5, 0x28, 0x69, 0x2e, 0xd3, 0x1b, 0x12, 0xce, 0xae, 0x8c, 0x14, 0xf6, 0x97, 0xf4, 0xa0,
+    0x20, 0x99, 0x04, 0x1c, 0x78, 0x99, 0x42, 0x6e, 0x2b, 0xca, 0x16, 0xda, 0x13, 0x29, 0x01, 0x4f,
+    0xab, 0x93, 0x2d, 0x86, 0xdb, 0x64, 0x20, 0xc7, 0x75, 0xa5, 0xd6, 0xd1, 0xf1, 0x35, 0xc9, 0x82,
+    0xf6, 0x7d, 0xdb, 0x32, 0x3b, 0x1c, 0x74, 0xa2, 0xe2, 0xea, 0x29, 0xb9, 0x0a, 0xc3, 0x04, 0xe2,
+    0xfe, 0xc4, 0xff, 0x46, 0x01, 0xdb, 0x54, 0x0d, 0xd3, 0x8d, 0x82, 0xaf, 0xa3, 0x01, 0xea, 0x85,
+    0xbb, 0x58, 0x22, 0xe9, 0x78, 0xd5, 0x98, 0xd8, 0x69, 0x73, 0x80, 0xf5, 0x14, 0xfd, 0xd4, 0xe6,
+    0x08, 0xc9, 0xb4, 0xa5, 0xcb, 0x46, 0x5b, 0xe3, 0xb0, 0x53, 0xf6, 0xc5, 0xe4, 0x3e, 0x29, 0xbb,
+    0x2c, 0x4b, 0x73, 0xe0, 0xaa, 0xe5, 0x82, 0x6c, 0x9d, 0x6b, 0x03, 0x4f, 0x69, 0xbe, 0x82, 0x4b,
+    0x30, 0xe4, 0x7b, 0xfd, 0x60, 0x40, 0xf7, 0x95, 0x24, 0x8a, 0xe7, 0xe1, 0xff, 0x29, 0xc4, 0xef,
+    0x8c, 0xf0, 0x47, 0x5d, 0x84, 0xf7, 0x58, 0x7f, 0x3f, 0x1b, 0xb0, 0xb7, 0x63, 0x5f, 0xb3, 0xe8,
+    0xbb, 0x12, 0x6f, 0x27, 0x74, 0x45, 0xab, 0x7f, 0xc4, 0xa6, 0xbe, 0xb2, 0x44, 0x83, 0xc0, 0x39,
+    0xe1, 0xf5, 0xc5, 0xfa, 0xbc, 0x7b, 0x89, 0x36, 0x0c, 0x88, 0xe0, 0xa5, 0x73, 0x64, 0xfd, 0xe8,
+    0xa2, 0x8d, 0xda, 0xde, 0x40, 0xe2, 0x25, 0x98, 0xb7, 0xbe, 0x42, 0xe1, 0xd0, 0x83, 0x6d, 0x4f,
+    0x1c, 0xfd, 0x38, 0xc2, 0x1d, 0xc3, 0x71, 0x90, 0xb9, 0xb7, 0xa0, 0x12, 0x1b, 0xf1, 0x70, 0x45,
+    0xdd, 0x13, 0x4d, 0xfc, 0x3e, 0xda, 0x50, 0xd8, 0x90, 0xf3, 0x6a, 0xae, 0x78, 0xa1, 0xbd, 0xef,
+    0x7e, 0x78, 0x7b, 0x71, 0x89, 0x11, 0x96, 0x66, 0x6f, 0xec, 0x6e, 0x50, 0x2e, 0xc7, 0x63, 0x86,
+    0x9c, 0x32, 0x48, 0x6f, 0xf0, 0x6a, 0xc3, 0x31, 0x07, 0x34, 0xe3, 0x0a, 0xa7, 0x3f, 0x83, 0x71,
+    0x8f, 0xf9, 0xcf, 0x4b, 0xc1, 0xd6, 0x55, 0x93, 0x0b, 0x76, 0x03, 0x50, 0x63, 0xc8, 0x80, 0x54,
+    0x0c, 0xdd, 0x81, 0x17, 0xe0, 0x7e, 0xf8, 0x50, 0x9b, 0x12, 0x05, 0xb3, 0x83, 0x25, 0x8b, 0x34,
+    0xdf, 0x47, 0x43, 0x6c, 0x03, 0xd5, 0x39, 0x4f, 0xb3, 0x78, 0x5b, 0x06, 0x2d, 0xe2, 0xd0, 0xf6,
+    0xbf, 0x24, 0x13, 0x96, 0x27, 0xe3, 0xf6, 0x12, 0x1a, 0x1b, 0xfd, 0xec, 0x96, 0xb4, 0xa2, 0x61,
+    0x1c, 0x1c, 0x5a, 0xc7, 0x4f, 0xc8, 0x96, 0xc3, 0xfe, 0xb2, 0x17, 0x8d, 0xaf, 0x75, 0x6b, 0x91,
+    0x5b, 0x75, 0xcf, 0x31, 0x21, 0xf3, 0xa0, 0xc6, 0x78, 0xe5, 0xf9, 0xd1, 0xb0, 0xc6, 0x3e, 0xc5,
+    0x1f, 0x39, 0xc0, 0x1e, 0x95, 0x6c, 0x45, 0x98, 0xd8, 0x8a, 0xd6, 0x19, 0xe5, 0x12, 0x03, 0x14,
+    0x1a, 0x67, 0xe2, 0x39, 0xe4, 0x74, 0xf7, 0xe3, 0xc1, 0x6d, 0x4e, 0xce, 0x1b, 0x99, 0x8b, 0x2e,
+    0x29, 0x6d, 0x7f, 0xca, 0xdb, 0x5b, 0x3b, 0xe8, 0x4c, 0x5a, 0x89, 0x7e, 0x7d, 0x6f, 0x42, 0x98,
+    0x74, 0xd7, 0xd6, 0xe4, 0xc5, 0x26, 0xcf, 0x07, 0x8e, 0x47, 0x8f, 0x2d, 0x3d, 0x8f, 0xae, 0x44,
+    0xba, 0x65, 0x62, 0xe5, 0x66, 0xbf, 0xfc, 0xc2, 0x1e, 0x59, 0x32, 0x04, 0x6e, 0xe9, 0x75, 0x8d,
+    0x66, 0xaa, 0x70, 0xa6, 0x87, 0xf3, 0x1c, 0x68, 0x15, 0x47, 0x35, 0xf2, 0xdd, 0x23, 0xd1, 0x6a,
+    0xe5, 0xe8, 0xdd, 0x7d, 0xd8, 0xc2, 0x49, 0x70, 0xfa, 0x4d, 0xe8, 0x39, 0x01, 0xeb, 0x8f, 0x2b,
+    0xa1, 0x96, 0xd8, 0x0d, 0x6c, 0x3c, 0x8c, 0x86, 0xbf, 0xed, 0x1d, 0xb3, 0xc3, 0xcc, 0x89, 0x98,
+    0xf0, 0x1a, 0x3d, 0x2b, 0x9e, 0x65, 0x68, 0xe3, 0xd8, 0x09, 0xe1, 0xe7, 0x1e, 0x4c, 0x03, 0x1c,
+    0xf2, 0xcd, 0xb7, 0x80, 0x0b, 0x88, 0x2d, 0x72, 0x3b, 0x92, 0x0f, 0x7d, 0xec, 0x3b, 0xdf, 0xde,
+    0x2d, 0xa7, 0x85, 0x93, 0xa2, 0x36, 0xc4, 0xda, 0x2a, 0xdf, 0x89, 0xb8, 0x8d, 0xc2, 0x5e, 0x00,
+    0xc5, 0x76, 0x00, 0xa0, 0xa5, 0x87, 0xe0, 0xa8, 0x97, 0x42, 0x86, 0x83, 0x22, 0x84, 0x5a, 0x07,
+    0xbb, 0xd6, 0xb4, 0x11, 0x8e, 0xaf, 0x39, 0x94, 0x4b, 0x93, 0x45, 0x28, 0x29, 0x0b, 0x7d, 0x67,
+    0xa9, 0x20, 0xf8, 0xc2, 0x82, 0x03, 0x1a, 0xdd, 0x11, 0x5f, 0xa6, 0x22, 0x9c, 0x56, 0xef, 0x38,
+    0x2d, 0xcb, 0xf0, 0x9c, 0x2c, 0xb7, 0x54, 0x77, 0xe9, 0x21, 0xa5, 0x7d, 0x4b, 0xbb, 0xa4, 0xdc,
+    0x89, 0x00, 0x3f, 0x40, 0x76, 0x53, 0x85, 0x9f, 0x27, 0xef, 0xb6, 0xae, 0xae, 0x39, 0x45, 0xaf,
+    0x47, 0x4c, 0xd2, 0x9c, 0x6b, 0xfd, 0xbd, 0x33, 0x66, 0xe4, 0x37, 0xa3, 0x0e, 0xda, 0x1f, 0x08,
+    0x1e, 0xda, 0x23, 0x60, 0x2b, 0x0d, 0xd5, 0xb9, 0x9d, 0x5e, 0x86, 0xee, 0xa0, 0x2e, 0x19, 0xb7,
+    0xcd, 0xf3, 0xff, 0xdc, 0xa4, 0xad, 0x5a, 0x1a, 0xff, 0xd0, 0x56, 0xdb, 0x3f, 0x5f, 0xbe, 0xfe,
+    0x3e, 0xa9, 0xe9, 0x99, 0xab, 0xbb, 0x23, 0xda, 0x16, 0x76, 0x48, 0x71, 0xc9, 0x62, 0x42, 0xc6,
+    0x28, 0x21, 0xaf, 0xd0, 0x99, 0xf6, 0xbc, 0xcd, 0x18, 0x2c, 0x04, 0xef, 0xdc, 0x6b, 0x18, 0xb6,
+    0xb8, 0x84, 0xf4, 0x94, 0x45, 0x58, 0x16, 0xdf, 0x4d, 0xde, 0x9f, 0x58, 0x63, 0x23, 0xd2, 0x67,
+    0x9f, 0x31, 0x4a, 0x0c, 0x1b, 0x5c, 0x64, 0x29, 0x5f, 0x3c, 0xed, 0x1c, 0x89, 0x80, 0xb6, 0x10,
+    0xce, 0x2c, 0xf1, 0x77, 0x48, 0xe3, 0xbd, 0xc5, 0x3b, 0x8c, 0xc2, 0x46, 0xc4, 0xe5, 0x2a, 0xa2,
+    0xdb, 0x1a, 0x1d, 0x22, 0xfb, 0x8e, 0x62, 0xb7, 0x6e, 0xfe, 0xe9, 0xfc, 0x81, 0xb2, 0xb9, 0x6f,
+    0x62, 0x5b, 0x82, 0x7e, 0x37, 0x03, 0xef, 0xd6, 0xd0, 0xfb, 0x6c, 0x8c, 0x55, 0x65, 0xc7, 0xc3,
+    0x0f, 0xeb, 0x32, 0x76, 0xe5, 0xf2, 0x5e, 0x95, 0x74, 0x56, 0xad, 0x2f, 0x6d, 0xc3, 0x11, 0xb7,
+    0x3e, 0xfb, 0x14, 0x5f, 0x3e, 0x71, 0x4d, 0xca, 0xb5, 0xf7, 0xe6, 0xb0, 0x75, 0xa2, 0x37, 0x7e,
+    0x78, 0x51, 0xef, 0x3a, 0xc0, 0xe6, 0xae, 0x7d, 0x3a, 0x8d, 0x42, 0xda, 0x5d, 0x2a, 0x59, 0x50,
+    0x7b, 0xca, 0x23, 0xbe, 0xdf, 0x6d, 0x05, 0xad, 0x19, 0x9c, 0xc8, 0xbf, 0x97, 0x17, 0x02, 0x2b,
+    0xdc, 0xef, 0x82, 0xbb, 0x6d, 0x6e, 0x4f, 0xf7, 0x99, 0x1a, 0xaf, 0x5b, 0xec, 0x1a, 0x18, 0xce,
+    0x19, 0x28, 0xa0, 0x6d, 0x58, 0x59, 0xc6, 0x35, 0xfd, 0x4f, 0x6d, 0x70, 0x17, 0x72, 0xec, 0x95,
+    0x2c, 0x42, 0x95, 0xe7, 0xd5, 0x1a, 0xfd, 0x46, 0x97, 0xac, 0xc6, 0x7f, 0xf2, 0x0d, 0x5b, 0x67,
+    0xdc, 0xd0, 0xdb, 0x72, 0xb9, 0x04, 0x71, 0x42, 0x94, 0xd6, 0x19, 0x94, 0x16, 0x1b, 0x27, 0x48,
+    0xe0, 0x05, 0x93, 0x1a, 0x75, 0x5f, 0x34, 0x1a, 0xf3, 0x22, 0x36, 0x55, 0xc5, 0x0a, 0x5e, 0x6e,
+    0x18, 0x0d, 0x98, 0xa9, 0x92, 0x73, 0x50, 0x7a, 0x68, 0xad, 0xe5, 0x4f, 0xd8, 0xb6, 0xb2, 0xc2,
+    0x0e, 0x3e, 0x70, 0x7f, 0x8b, 0x1a, 0x18, 0x94, 0x5c, 0xf4, 0xc8, 0xbf, 0x56, 0x9c, 0x93, 0xbc,
+    0x97, 0x55, 0xa3, 0x52, 0x37, 0x8f, 0x07, 0xa6, 0xdf, 0xb6, 0x8d, 0xe4, 0x01, 0x6d, 0x71, 0xbc,
+    0x03, 0x82, 0x53, 0x31, 0xda, 0xc6, 0x2a, 0x4d, 0xb6, 0x71, 0x48, 0x09, 0x17, 0xc2, 0x62, 0x5c,
+    0x48, 0x8d, 0x65, 0x8f, 0x3a, 0x4b, 0x6f, 0xbd, 0x83, 0x4f, 0x74, 0x0c, 0xac, 0x12, 0x41, 0xcd,
+    0x9b, 0x6d, 0x84, 0x3c, 0x51, 0x34, 0x1a, 0x75, 0xc4, 0x3d, 0xce, 0xb5, 0xb5, 0xdc, 0x21, 0xa1,
+    0xcd, 0xc4, 0xe6, 0xb2, 0x9d, 0x9f, 0x02, 0x31, 0x93, 0x67, 0x17, 0xaf, 0x2f, 0xcf, 0x9f, 0xef,
+    0xe9, 0xe8, 0x6a, 0x86, 0x37, 0x46, 0x4f, 0xf8, 0xd0, 0x01, 0x4a, 0x07, 0x9a, 0x22, 0xd7, 0xd8,
+    0x37, 0x5e, 0xdb, 0xd7, 0xe2, 0x21, 0xa2, 0x3a, 0xaf, 0xed, 0xcf, 0xbd, 0xc1, 0x5b, 0x4d, 0xdb,
+    0xe7, 0xec, 0x3c, 0xad, 0x50, 0x53, 0x49, 0x44, 0x74, 0x42, 0xf7, 0x5d, 0x66, 0xec, 0x6b, 0xda,
+    0x04, 0x85, 0xc0, 0x83, 0x49, 0x09, 0x20, 0xf4, 0x33, 0x37, 0xb4, 0xf6, 0xf6, 0x94, 0xdb, 0x41,
+    0xd6, 0xb7, 0xcc, 0x28, 0x08, 0x4d, 0x63, 0x48, 0xf9, 0xd6, 0xac, 0x4b, 0xa6, 0xdb, 0x7b, 0x37,
+    0x42, 0x74, 0x8c, 0x88, 0x42, 0x52, 0x26, 0x39, 0x80, 0xc5, 0x71, 0xad, 0x7c, 0x0f, 0x8e, 0x03,
+    0x38, 0x3a, 0x65, 0xcd, 0xa5, 0xba, 0x1f, 0x07, 0x13, 0x09, 0xcc, 0xf5, 0x5a, 0x2e, 0xe4, 0xfd,
+    0x78, 0xb7, 0x3a, 0xc6, 0x10, 0x2b, 0x9c, 0x03, 0x07, 0x61, 0x3d, 0x1e, 0xec, 0x85, 0xb2, 0x7b,
+    0xca, 0xf4, 0x6f, 0x96, 0xa7, 0x42, 0xae, 0x98, 0xbd, 0x89, 0x67, 0x11, 0xbd, 0xbf, 0xdb, 0xaf,
+    0x3b, 0x87, 0x4c, 0x8a, 0x99, 0x0f, 0xbe, 0x6b, 0x57, 0x6b, 0x6e, 0x7f, 0xe5, 0xc9, 0x0e, 0xe9,
+    0x2c, 0x7d, 0x1c, 0x12, 0xe6, 0xec, 0x65, 0x55, 0xc0, 0x5f, 0xa4, 0x99, 0x9e, 0x8e, 0x71, 0x71,
+    0x2a, 0x44, 0x78, 0x3c, 0x43, 0xd8, 0x8d, 0x34, 0xd1, 0x19, 0x02, 0x85, 0x47, 0x6f, 0xc9, 0xf4,
+    0x1f, 0x40, 0x68, 0x8d, 0xc0, 0xf0, 0x84, 0x0d, 0xcd, 0x5e, 0x6c, 0x3b, 0xcf, 0x87, 0xa8, 0xe7,
+    0xe5, 0x0a, 0xa7, 0x9f, 0x92, 0xbe, 0xa8, 0xf4, 0xe1, 0x43, 0xb9, 0x0a, 0xb1, 0x5f, 0xfd, 0xf5,
+    0xea, 0xaa, 0x17, 0xaf, 0xf8, 0xc9, 0xec, 0xc8, 0xfc, 0x03, 0x76, 0x17, 0x45, 0xbf, 0x08, 0x8d,
+    0x05, 0xdd, 0x52, 0xf0, 0x4e, 0xdd, 0x76, 0xf4, 0xba, 0xa8, 0xaa, 0x7e, 0xc4, 0x1c, 0x01, 0x21,
+    0xe2, 0x33, 0xf7, 0x74, 0xaa, 0x7b, 0x91, 0xfd, 0xbb, 0xaa, 0xde, 0xa1, 0xcc, 0xb5, 0x7d, 0x22,
+    0x84, 0x7e, 0xaf, 0x58, 0x48, 0x88, 0xff, 0xc2, 0x27, 0x6a, 0x2f, 0x76, 0x9b, 0xc5, 0xdd, 0x81,
+    0xb1, 0xf5, 0x7c, 0x76, 0x74, 0xd6, 0x86, 0x1c, 0x06, 0xc4, 0x11, 0xee, 0xd8, 0xe9, 0xc6, 0x1e,
+    0xdc, 0x89, 0x54, 0xe6, 0x5e, 0x9c, 0x66, 0x61, 0x3f, 0xc1, 0x0a, 0x30, 0x59, 0x85, 0xa8, 0x75,
+    0xa5, 0x0d, 0x45, 0x9d, 0xcb, 0xbf, 0xb3, 0x9d, 0xf1, 0xf5, 0x74, 0xec, 0x77, 0x91, 0x25, 0x51,
+    0x72, 0x4c, 0x5b, 0x59, 0x99, 0x7b, 0xce, 0xbc, 0xcd, 0x3b, 0xcc, 0xdc, 0x80, 0x73, 0x63, 0x91,
+    0x6f, 0xf1, 0x65, 0x80, 0x15, 0xc2, 0x7e, 0xce, 0x2a, 0x9a, 0xdc, 0x48, 0x2c, 0xa3, 0xc6, 0x32,
+    0x1a, 0x51, 0x1d, 0x25, 0xa9, 0xdc, 0xc4, 0x40, 0x64, 0x77, 0x4b, 0x99, 0xff, 0x84, 0xd9, 0x59,
+    0x86, 0x05, 0x1f, 0xc5, 0x90, 0x69, 0x0a, 0xb5, 0x99, 0x45, 0xc9, 0x5c, 0x96, 0x07, 0xf4, 0x4f,
+    0xb2, 0xfc, 0xf9, 0x00, 0xff, 0x6e, 0xd5, 0x0c, 0x05, 0xf5, 0xe5, 0x8e, 0xb5, 0xd5, 0xee, 0xcc,
+    0xbf, 0xd2, 0xb6, 0x6a, 0xf6, 0x18, 0xa1, 0xd3, 0x35, 0xac, 0x40, 0x81, 0xae, 0x6e, 0xfb, 0x2e,
+    0x1b, 0xfb, 0x7c, 0x7f, 0x1c, 0x56, 0xcd, 0xc7, 0x67, 0xee, 0x0d, 0x91, 0x9d, 0x5f, 0xbe, 0xb9,
+    0x9f, 0xe1, 0x6e, 0xa9, 0xda, 0x61, 0xda, 0x82, 0x1e, 0x62, 0xec, 0xbf, 0x07, 0xde, 0xe6, 0x8f,
+    0xc7, 0xd9, 0xdf, 0xe4, 0x0b, 0x79, 0x9f, 0xfb, 0xb7, 0x5e, 0x0e, 0xea, 0x6a, 0xe8, 0x65, 0xbb,
+    0xfd, 0x1b, 0x04, 0xf0, 0xb5, 0x8c, 0xbd, 0x41, 0x32, 0x28, 0x43, 0x8f, 0x08, 0x75, 0x4b, 0xc5,
+    0x7d, 0xc1, 0x7a, 0x8c, 0x5b, 0x9c, 0x65, 0xd8, 0x6e, 0xcc, 0x1e, 0x67, 0xd8, 0x5e, 0xe9, 0xe9,
+    0x78, 0xbc, 0x94, 0x26, 0x6b, 0xe6, 0x49, 0x5a, 0x15, 0xe3, 0x42, 0xa6, 0xbc, 0xa8, 0x61, 0x5c,
+    0x40, 0x3e, 0x6a, 0x4b, 0xdb, 0xc8, 0x17, 0x45, 0x3c, 0xfa, 0x89, 0x98, 0xa7, 0x63, 0x4e, 0x12,
+    0xd4, 0x36, 0xf7, 0xe4, 0x8a, 0x7e, 0xfc, 0xc7, 0xa7, 0xb1, 0xfb, 0x46, 0xff, 0x5f, 0x39, 0xb3,
+    0x18, 0x4e, 0xb4, 0x1f, 0x00, 0x00,
+};
+extern const size_t index_html_gz_size = sizeof(index_html_gz);
+const char *index_html_etag = "\"1cedc2c501a1ed8d\"";
@@ -0,0 +1,970 @@
+#include "http_server.h"
+
+#include <Arduino.h>
+#include <stdarg.h>
+
+#include <new>
+
+#include "debug.h"
+
+enum http_state_t {
+    HTTP_STATE_REQUEST_LINE,
+    HTTP_STATE_HEADERS,
+    HTTP_STATE_BODY,
+    HTTP_STATE_UPLOAD,
+    HTTP_STATE_SEND,
+    HTTP_STATE_DONE,
+};
+
+// position in a multipart/form-data body
+enum http_part_t {
+    HTTP_PART_PREAMBLE,
+    // after a boundary: "\r\n" starts a part, "--" ends the body
+    HTTP_PART_DELIMITER,
+    HTTP_PART_HEADERS,
+    HTTP_PART_DATA,
+    HTTP_PART_EPILOGUE,
+};
+
+enum http_source_t {
+    HTTP_SOURCE_NONE,
+    HTTP_SOURCE_PROGMEM,
+    HTTP_SOURCE_FILE,
+    HTTP_SOURCE_STEPS,
+};
+
+struct http_route_t {
+    const char *path;
+    http_method_t method;
+    http_handler_t handler;
+    http_upload_t upload;
+};
+
+// offset into data for values that are absent
+#define HTTP_NONE 0xffff
+// chunk size prefix of a streamed response step, four hex digits and CRLF
+#define HTTP_CHUNK_HEAD 6
+// CRLF after a chunk and the final "0\r\n\r\n"
+#define HTTP_CHUNK_TAIL 7
+
+static void http_json_sink(void *context, const char *data, size_t size);
+
+struct http_request_t {
+    explicit http_request_t(const WiFiClient &client) :
+            client(client), json(json_buffer, sizeof(json_buffer), http_json_sink, this) {
+        memset(headers, 0xff, sizeof(headers));
+    }
+
+    WiFiClient client;
+    http_state_t state = HTTP_STATE_REQUEST_LINE;
+    uint32_t last_progress = 0;
+    const http_route_t *route = nullptr;
+    http_method_t method = HTTP_METHOD_OTHER;
+
+    // path, arguments, header values and body, NUL terminated
+    char data[HTTP_DATA_SIZE];
+    uint16_t data_used = 0;
+    uint16_t path = HTTP_NONE;
+    uint16_t headers[HTTP_HEADERS];
+    uint16_t arg_names[HTTP_MAX_ARGS];
+    uint16_t arg_values[HTTP_MAX_ARGS];
+    uint8_t arg_count = 0;
+    uint16_t body = HTTP_NONE;
+    uint16_t body_size = 0;
+    // body bytes still to be read
+    uint32_t remaining = 0;
+
+    // the current head line is collected in out
+    uint16_t line_used = 0;
+    bool line_overflow = false;
+
+    // multipart body, scanned in out
+    http_part_t part = HTTP_PART_PREAMBLE;
+    uint16_t delimiter = HTTP_NONE;
+    uint8_t delimiter_size = 0;
+    uint16_t scan_used = 0;
+    bool part_file = false;
+    bool upload_started = false;
+    bool upload_ended = false;
+
+    char extra_headers[HTTP_HEADERS_SIZE];
+    uint16_t extra_headers_used = 0;
+
+    char out[HTTP_OUT_SIZE];
+    uint16_t out_start = 0;
+    uint16_t out_end = 0;
+    bool responded = false;
+    bool overflow = false;
+    bool detached = false;
+
+    http_source_t source = HTTP_SOURCE_NONE;
+    PGM_P progmem = nullptr;
+    size_t progmem_left = 0;
+    File file;
+    http_step_t step = nullptr;
+    uint16_t step_index = 0;
+    uint32_t step_data = 0;
+    char json_buffer[64];
+    JsonWriter json;
+
+    void (*on_close)() = nullptr;
+};
+
+static WiFiServer *server = nullptr;
+static http_route_t routes[HTTP_MAX_ROUTES];
+static uint8_t route_count = 0;
+static http_request_t *connections[HTTP_MAX_CONNECTIONS];
+
+static const char *const header_names[HTTP_HEADERS] = {
+    "Content-Length",
+    "Content-Type",
+    "If-Match",
+    "If-None-Match",
+};
+
+static const char *const method_names[HTTP_METHOD_OTHER] = {
+    "GET", "HEAD", "POST", "PUT", "PATCH", "DELETE",
+};
+
+static const char *http_reason(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 202: return "Accepted";
+        case 204: return "No Content";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 408: return "Request Timeout";
+        case 409: return "Conflict";
+        case 412: return "Precondition Failed";
+        case 413: return "Payload Too Large";
+        case 414: return "URI Too Long";
+        case 415: return "Unsupported Media Type";
+        case 428: return "Precondition Required";
+        case 503: return "Service Unavailable";
+        default: return status < 500 ? "Error" : "Internal Server Error";
+    }
+}
+
+void http_server_init(uint16_t port) {
+    server = new WiFiServer(port);
+    server->begin();
+}
+
+void http_on(const char *path, http_method_t method, http_handler_t handler, http_upload_t upload) {
+    if (route_count == HTTP_MAX_ROUTES) {
+        MIE_LOG_WARNING("Too many routes, %s not added", path);
+        return;
+    }
+    routes[route_count++] = {path, method, handler, upload};
+}
+
+// request data
+
+static uint16_t http_store(http_request_t *request, const char *str, size_t size) {
+    if (request->data_used + size + 1 > HTTP_DATA_SIZE) {
+        return HTTP_NONE;
+    }
+    uint16_t offset = request->data_used;
+    memcpy(request->data + offset, str, size);
+    request->data[offset + size] = '\0';
+    request->data_used += size + 1;
+    return offset;
+}
+
+static int http_hex(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+// percent decoding in place, '+' is a space in arguments
+static void http_decode(char *str, bool plus) {
+    char *out = str;
+    for (char *p = str; *p; p++) {
+        int high, low;
+        if (*p == '%' && (high = http_hex(p[1])) >= 0 && (low = http_hex(p[2])) >= 0) {
+            *out++ = high << 4 | low;
+            p += 2;
+        } else if (*p == '+' && plus) {
+            *out++ = ' ';
+        } else {
+            *out++ = *p;
+        }
+    }
+    *out = '\0';
+}
+
+// split "a=1&b=2" already in data into arguments, decoded in place
+static bool http_parse_args(http_request_t *request, uint16_t offset) {
+    char *p = request->data + offset;
+    while (*p) {
+        char *end = strchr(p, '&');
+        if (end) {
+            *end = '\0';
+        }
+        if (*p) {
+            if (request->arg_count == HTTP_MAX_ARGS) {
+                return false;
+            }
+            char *value = strchr(p, '=');
+            if (value) {
+                *value++ = '\0';
+            } else {
+                // "flag" alone, the value is the empty string at its end
+                value = p + strlen(p);
+            }
+            http_decode(p, true);
+            http_decode(value, true);
+            request->arg_names[request->arg_count] = p - request->data;
+            request->arg_values[request->arg_count] = value - request->data;
+            request->arg_count++;
+        }
+        if (!end) {
+            break;
+        }
+        p = end + 1;
+    }
+    return true;
+}
+
+http_method_t http_method(const http_request_t *request) {
+    return request->method;
+}
+
+const char *http_path(const http_request_t *request) {
+    return request->data + request->path;
+}
+
+const char *http_header(const http_request_t *request, http_header_t header) {
+    uint16_t offset = request->headers[header];
+    return offset == HTTP_NONE ? nullptr : request->data + offset;
+}
+
+const char *http_body(const http_request_t *request, size_t *size) {
+    if (request->body == HTTP_NONE) {
+        *size = 0;
+        return "";
+    }
+    *size = request->body_size;
+    return request->data + request->body;
+}
+
+uint8_t http_arg_count(const http_request_t *request) {
+    return request->arg_count;
+}
+
+const char *http_arg_name(const http_request_t *request, uint8_t index) {
+    return request->data + request->arg_names[index];
+}
+
+const char *http_arg_value(const http_request_t *request, uint8_t index) {
+    return request->data + request->arg_values[index];
+}
+
+const char *http_arg(const http_request_t *request, const char *name) {
+    for (uint8_t i = 0; i < request->arg_count; i++) {
+        if (strcmp(http_arg_name(request, i), name) == 0) {
+            return http_arg_value(request, i);
+        }
+    }
+    return nullptr;
+}
+
+// responses
+
+void http_add_header(http_request_t *request, const char *name, const char *value) {
+    size_t room = HTTP_HEADERS_SIZE - request->extra_headers_used;
+    int size = snprintf(request->extra_headers + request->extra_headers_used, room, "%s: %s\r\n", name, value);
+    if (size < 0 || (size_t)size >= room) {
+        MIE_LOG_WARNING("HTTP header %s dropped", name);
+        request->extra_headers[request->extra_headers_used] = '\0';
+        return;
+    }
+    request->extra_headers_used += size;
+}
+
+// size < 0 for chunked encoding
+static bool http_head(http_request_t *request, int status, const char *type, long size) {
+    request->responded = true;
+    request->state = HTTP_STATE_SEND;
+    request->extra_headers[request->extra_headers_used] = '\0';
+
+    int used = snprintf(request->out, HTTP_OUT_SIZE, "HTTP/1.1 %d %s\r\n", status, http_reason(status));
+    if (type) {
+        used += snprintf(request->out + used, HTTP_OUT_SIZE - used, "Content-Type: %s\r\n", type);
+    }
+    if (size >= 0) {
+        used += snprintf(request->out + used, HTTP_OUT_SIZE - used, "Content-Length: %ld\r\n", size);
+    } else {
+        used += snprintf(request->out + used, HTTP_OUT_SIZE - used, "Transfer-Encoding: chunked\r\n");
+    }
+    used += snprintf(request->out + used, HTTP_OUT_SIZE - used, "%sConnection: close\r\n\r\n",
+            request->extra_headers);
+    if (used >= HTTP_OUT_SIZE) {
+        MIE_LOG_WARNING("HTTP response head too large");
+        request->overflow = true;
+        return false;
+    }
+    request->out_start = 0;
+    request->out_end = used;
+    return true;
+}
+
+void http_send(http_request_t *request, int status, const char *type, const char *body, size_t size) {
+    if (body && !size) {
+        size = strlen(body);
+    }
+    if (!http_head(request, status, type, size)) {
+        return;
+    }
+    if (size > (size_t)(HTTP_OUT_SIZE - request->out_end)) {
+        MIE_LOG_WARNING("HTTP response too large: %u", size);
+        request->overflow = true;
+        return;
+    }
+    if (size) {
+        memcpy(request->out + request->out_end, body, size);
+        request->out_end += size;
+    }
+}
+
+void http_send_P(http_request_t *request, int status, const char *type, PGM_P body, size_t size) {
+    if (http_head(request, status, type, size)) {
+        request->source = HTTP_SOURCE_PROGMEM;
+        request->progmem = body;
+        request->progmem_left = size;
+    }
+}
+
+void http_send_file(http_request_t *request, int status, const char *type, File &file) {
+    if (!file) {
+        http_send(request, 404, "text/plain", "Not found");
+        return;
+    }
+    if (http_head(request, status, type, file.size())) {
+        request->source = HTTP_SOURCE_FILE;
+        request->file = file;
+    }
+}
+
+void http_send_steps(http_request_t *request, int status, const char *type, http_step_t step) {
+    if (http_head(request, status, type, -1)) {
+        request->source = HTTP_SOURCE_STEPS;
+        request->step = step;
+        request->step_index = 0;
+        request->step_data = 0;
+        request->json = JsonWriter(request->json_buffer, sizeof(request->json_buffer), http_json_sink, request);
+    }
+}
+
+void http_write(http_request_t *request, const char *data, size_t size) {
+    if (request->out_end + size > HTTP_OUT_SIZE - HTTP_CHUNK_TAIL) {
+        request->overflow = true;
+        return;
+    }
+    memcpy(request->out + request->out_end, data, size);
+    request->out_end += size;
+}
+
+void http_printf(http_request_t *request, const char *format, ...) {
+    size_t room = HTTP_OUT_SIZE - HTTP_CHUNK_TAIL - request->out_end;
+    va_list args;
+    va_start(args, format);
+    int size = vsnprintf(request->out + request->out_end, room, format, args);
+    va_end(args);
+    if (size < 0 || (size_t)size >= room) {
+        request->overflow = true;
+        return;
+    }
+    request->out_end += size;
+}
+
+static void http_json_sink(void *context, const char *data, size_t size) {
+    http_write((http_request_t *)context, data, size);
+}
+
+JsonWriter &http_json(http_request_t *request) {
+    return request->json;
+}
+
+uint32_t *http_step_data(http_request_t *request) {
+    return &request->step_data;
+}
+
+WiFiClient http_detach(http_request_t *request) {
+    request->detached = true;
+    request->responded = true;
+    request->state = HTTP_STATE_DONE;
+    return request->client;
+}
+
+void http_on_close(http_request_t *request, void (*callback)()) {
+    request->on_close = callback;
+}
+
+// request parsing
+
+static void http_dispatch(http_request_t *request) {
+    request->state = HTTP_STATE_SEND;
+    request->route->handler(request);
+    if (!request->responded) {
+        MIE_LOG_WARNING("No response for %s", http_path(request));
+        http_send(request, 500);
+    }
+}
+
+static void http_fail(http_request_t *request, int status) {
+    http_send(request, status, "text/plain", http_reason(status));
+}
+
+static void http_request_line(http_request_t *request, char *line) {
+    char *target = strchr(line, ' ');
+    char *version = target ? strchr(target + 1, ' ') : nullptr;
+    if (!version || strncmp(version + 1, "HTTP/1.", 7) != 0) {
+        http_fail(request, 400);
+        return;
+    }
+    *target++ = '\0';
+    *version = '\0';
+
+    request->method = HTTP_METHOD_OTHER;
+    for (uint8_t i = 0; i < HTTP_METHOD_OTHER; i++) {
+        if (strcmp(line, method_names[i]) == 0) {
+            request->method = (http_method_t)i;
+        }
+    }
+
+    char *query = strchr(target, '?');
+    if (query) {
+        *query++ = '\0';
+    }
+    http_decode(target, false);
+    request->path = http_store(request, target, strlen(target));
+    if (request->path == HTTP_NONE) {
+        http_fail(request, 414);
+        return;
+    }
+    if (query) {
+        uint16_t args = http_store(request, query, strlen(query));
+        if (args == HTTP_NONE || !http_parse_args(request, args)) {
+            http_fail(request, 414);
+            return;
+        }
+    }
+    request->state = HTTP_STATE_HEADERS;
+}
+
+static void http_header_line(http_request_t *request, char *line) {
+    char *value = strchr(line, ':');
+    if (!value) {
+        return;
+    }
+    *value++ = '\0';
+    while (*value == ' ' || *value == '\t') {
+        value++;
+    }
+    size_t size = strlen(value);
+    while (size && (value[size - 1] == ' ' || value[size - 1] == '\t')) {
+        size--;
+    }
+
+    for (uint8_t i = 0; i < HTTP_HEADERS; i++) {
+        if (request->headers[i] == HTTP_NONE && strcasecmp(line, header_names[i]) == 0) {
+            request->headers[i] = http_store(request, value, size);
+            if (request->headers[i] == HTTP_NONE) {
+                http_fail(request, 413);
+            }
+            return;
+        }
+    }
+}
+
+static bool http_begin_upload(http_request_t *request) {
+    const char *type = http_header(request, HTTP_HEADER_CONTENT_TYPE);
+    const char *boundary = type ? strstr(type, "boundary=") : nullptr;
+    if (!boundary || strncasecmp(type, "multipart/form-data", 19) != 0) {
+        return false;
+    }
+    boundary += 9;
+    size_t size = strcspn(boundary, ";");
+    if (size >= 2 && boundary[0] == '"' && boundary[size - 1] == '"') {
+        boundary++;
+        size -= 2;
+    }
+    if (size == 0 || size > 70) {
+        return false;
+    }
+
+    char delimiter[76] = "\r\n--";
+    memcpy(delimiter + 4, boundary, size);
+    request->delimiter = http_store(request, delimiter, size + 4);
+    request->delimiter_size = size + 4;
+    if (request->delimiter == HTTP_NONE) {
+        return false;
+    }
+
+    // the first boundary isn't preceded by a line break, pretend it is
+    memcpy(request->out, "\r\n", 2);
+    request->scan_used = 2;
+    request->part = HTTP_PART_PREAMBLE;
+    request->state = HTTP_STATE_UPLOAD;
+    return true;
+}
+
+static void http_head_end(http_request_t *request) {
+    bool path_found = false;
+    for (uint8_t i = 0; i < route_count; i++) {
+        if (strcmp(routes[i].path, http_path(request)) == 0) {
+            path_found = true;
+            if (routes[i].method == request->method) {
+                request->route = &routes[i];
+                break;
+            }
+        }
+    }
+    if (!request->route) {
+        http_fail(request, path_found ? 405 : 404);
+        return;
+    }
+
+    const char *length = http_header(request, HTTP_HEADER_CONTENT_LENGTH);
+    request->remaining = length ? strtoul(length, nullptr, 10) : 0;
+
+    if (request->route->upload) {
+        if (!http_begin_upload(request) || !request->remaining) {
+            http_fail(request, 400);
+        }
+    } else if (request->remaining) {
+        if (request->remaining >= (uint32_t)(HTTP_DATA_SIZE - request->data_used)) {
+            http_fail(request, 413);
+            return;
+        }
+        request->body = request->data_used;
+        request->state = HTTP_STATE_BODY;
+    } else {
+        http_dispatch(request);
+    }
+}
+
+static void http_line(http_request_t *request) {
+    char *line = request->out;
+    size_t size = request->line_used;
+    bool overflow = request->line_overflow;
+    request->line_used = 0;
+    request->line_overflow = false;
+
+    if (size && line[size - 1] == '\r') {
+        size--;
+    }
+    line[size] = '\0';
+
+    if (request->state == HTTP_STATE_REQUEST_LINE) {
+        if (overflow) {
+            http_fail(request, 414);
+        } else if (size) {
+            // blank lines before the request are allowed
+            http_request_line(request, line);
+        }
+    } else if (size == 0) {
+        http_head_end(request);
+    } else if (!overflow) {
+        http_header_line(request, line);
+    }
+}
+
+static size_t http_consume_head(http_request_t *request, const uint8_t *data, size_t size) {
+    size_t i = 0;
+    while (i < size && request->state <= HTTP_STATE_HEADERS) {
+        char c = data[i++];
+        if (c == '\n') {
+            http_line(request);
+        } else if (request->line_used < HTTP_LINE_SIZE - 1) {
+            request->out[request->line_used++] = c;
+        } else {
+            request->line_overflow = true;
+        }
+    }
+    return i;
+}
+
+static size_t http_consume_body(http_request_t *request, const uint8_t *data, size_t size) {
+    size_t n = min((uint32_t)size, request->remaining);
+    memcpy(request->data + request->body + request->body_size, data, n);
+    request->body_size += n;
+    request->remaining -= n;
+    if (request->remaining) {
+        return n;
+    }
+
+    request->data[request->body + request->body_size] = '\0';
+    request->data_used += request->body_size + 1;
+    const char *type = http_header(request, HTTP_HEADER_CONTENT_TYPE);
+    if (type && strncasecmp(type, "application/x-www-form-urlencoded", 33) == 0) {
+        if (!http_parse_args(request, request->body)) {
+            http_fail(request, 413);
+            return n;
+        }
+        request->body = HTTP_NONE;
+    }
+    http_dispatch(request);
+    return n;
+}
+
+static void http_upload(http_request_t *request, http_upload_stage_t stage, const uint8_t *data, size_t size) {
+    if (stage == HTTP_UPLOAD_END || stage == HTTP_UPLOAD_ABORT) {
+        request->upload_ended = true;
+    }
+    request->route->upload(request, stage, data, size);
+}
+
+static void http_scan_drop(http_request_t *request, size_t size) {
+    request->scan_used -= size;
+    memmove(request->out, request->out + size, request->scan_used);
+}
+
+static int http_find(const char *data, size_t size, const char *needle, size_t needle_size) {
+    for (size_t i = 0; i + needle_size <= size; i++) {
+        if (data[i] == needle[0] && memcmp(data + i, needle, needle_size) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// multipart/form-data: the first part with a filename goes to the upload
+// callback, everything else is skipped
+static bool http_scan(http_request_t *request) {
+    const char *delimiter = request->data + request->delimiter;
+    size_t delimiter_size = request->delimiter_size;
+    char *buffer = request->out;
+
+    for (;;) {
+        switch (request->part) {
+            case HTTP_PART_PREAMBLE:
+            case HTTP_PART_DATA: {
+                bool upload = request->part == HTTP_PART_DATA && request->part_file;
+                int at = http_find(buffer, request->scan_used, delimiter, delimiter_size);
+                if (at >= 0) {
+                    if (upload) {
+                        if (at) {
+                            http_upload(request, HTTP_UPLOAD_DATA, (const uint8_t *)buffer, at);
+                        }
+                        http_upload(request, HTTP_UPLOAD_END, nullptr, 0);
+                        request->part_file = false;
+                    }
+                    http_scan_drop(request, at + delimiter_size);
+                    request->part = HTTP_PART_DELIMITER;
+                    break;
+                }
+                // keep what could be the start of a delimiter
+                if (request->scan_used >= delimiter_size) {
+                    size_t safe = request->scan_used - (delimiter_size - 1);
+                    if (upload) {
+                        http_upload(request, HTTP_UPLOAD_DATA, (const uint8_t *)buffer, safe);
+                    }
+                    http_scan_drop(request, safe);
+                }
+                return true;
+            }
+
+            case HTTP_PART_DELIMITER:
+                if (request->scan_used < 2) {
+                    return true;
+                }
+                if (buffer[0] == '-' && buffer[1] == '-') {
+                    request->part = HTTP_PART_EPILOGUE;
+                } else if (buffer[0] == '\r' && buffer[1] == '\n') {
+                    request->part = HTTP_PART_HEADERS;
+                } else {
+                    return false;
+                }
+                http_scan_drop(request, 2);
+                break;
+
+            case HTTP_PART_HEADERS: {
+                int at = http_find(buffer, request->scan_used, "\r\n", 2);
+                if (at < 0) {
+                    return request->scan_used < HTTP_OUT_SIZE;
+                }
+                if (at == 0) {
+                    request->part = HTTP_PART_DATA;
+                } else if (at > 20 && strncasecmp(buffer, "Content-Disposition:", 20) == 0 && !request->upload_started) {
+                    buffer[at] = '\0';
+                    char *name = strstr(buffer, " name=\"");
+                    if (strstr(buffer, "filename=") && name) {
+                        name += 7;
+                        name[strcspn(name, "\"")] = '\0';
+                        request->part_file = true;
+                        request->upload_started = true;
+                        http_upload(request, HTTP_UPLOAD_START, (const uint8_t *)name, strlen(name));
+                    }
+                }
+                http_scan_drop(request, at + 2);
+                break;
+            }
+
+            case HTTP_PART_EPILOGUE:
+                request->scan_used = 0;
+                return true;
+        }
+    }
+}
+
+static size_t http_consume_upload(http_request_t *request, const uint8_t *data, size_t size) {
+    size_t n = min(min((uint32_t)size, request->remaining), (uint32_t)(HTTP_OUT_SIZE - request->scan_used));
+    memcpy(request->out + request->scan_used, data, n);
+    request->scan_used += n;
+    request->remaining -= n;
+
+    bool valid = http_scan(request);
+    if (valid && request->remaining) {
+        return n;
+    }
+
+    if (request->part != HTTP_PART_EPILOGUE || !valid) {
+        if (request->upload_started && !request->upload_ended) {
+            http_upload(request, HTTP_UPLOAD_ABORT, nullptr, 0);
+        }
+        request->scan_used = 0;
+        http_fail(request, 400);
+        return n;
+    }
+    http_dispatch(request);
+    return n;
+}
+
+static void http_receive(http_request_t *request) {
+    uint8_t chunk[128];
+    size_t budget = HTTP_READ_BUDGET;
+    while (budget && request->state < HTTP_STATE_SEND) {
+        int available = request->client.available();
+        if (available <= 0) {
+            return;
+        }
+        int size = request->client.read(chunk, min(min((size_t)available, sizeof(chunk)), budget));
+        if (size <= 0) {
+            return;
+        }
+        budget -= size;
+        request->last_progress = millis();
+
+        for (int i = 0; i < size && request->state < HTTP_STATE_SEND;) {
+            switch (request->state) {
+                case HTTP_STATE_REQUEST_LINE:
+                case HTTP_STATE_HEADERS:
+                    i += http_consume_head(request, chunk + i, size - i);
+                    break;
+                case HTTP_STATE_BODY:
+                    i += http_consume_body(request, chunk + i, size - i);
+                    break;
+                case HTTP_STATE_UPLOAD:
+                    i += http_consume_upload(request, chunk + i, size - i);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+// response sending
+
+static void http_chunk_size(char *out, uint16_t size) {
+    static const char hex[] = "0123456789abcdef";
+    for (int8_t i = 3; i >= 0; i--) {
+        out[i] = hex[size & 0xf];
+        size >>= 4;
+    }
+    out[4] = '\r';
+    out[5] = '\n';
+}
+
+// top up out from the body source
+static void http_fill(http_request_t *request) {
+    if (request->source == HTTP_SOURCE_NONE) {
+        return;
+    }
+    if (request->out_start) {
+        request->out_end -= request->out_start;
+        memmove(request->out, request->out + request->out_start, request->out_end);
+        request->out_start = 0;
+    }
+
+    size_t room = HTTP_OUT_SIZE - request->out_end;
+    switch (request->source) {
+        case HTTP_SOURCE_PROGMEM: {
+            size_t n = min(room, request->progmem_left);
+            memcpy_P(request->out + request->out_end, request->progmem, n);
+            request->out_end += n;
+            request->progmem += n;
+            request->progmem_left -= n;
+            if (!request->progmem_left) {
+                request->source = HTTP_SOURCE_NONE;
+            }
+            break;
+        }
+
+        case HTTP_SOURCE_FILE: {
+            size_t n = request->file.read((uint8_t *)request->out + request->out_end, room);
+            request->out_end += n;
+            if (!request->file.available()) {
+                request->file.close();
+                request->source = HTTP_SOURCE_NONE;
+            }
+            break;
+        }
+
+        case HTTP_SOURCE_STEPS:
+            while (request->source == HTTP_SOURCE_STEPS &&
+                    room >= HTTP_CHUNK_HEAD + HTTP_STEP_SIZE + HTTP_CHUNK_TAIL) {
+                uint16_t start = request->out_end;
+                request->out_end += HTTP_CHUNK_HEAD;
+                bool more = request->step(request, request->step_index++);
+                request->json.flush();
+                if (request->overflow) {
+                    MIE_LOG_WARNING("HTTP step too large for %s", http_path(request));
+                    return;
+                }
+
+                uint16_t size = request->out_end - start - HTTP_CHUNK_HEAD;
+                if (size) {
+                    http_chunk_size(request->out + start, size);
+                    memcpy(request->out + request->out_end, "\r\n", 2);
+                    request->out_end += 2;
+                } else {
+                    request->out_end = start;
+                }
+                if (!more) {
+                    memcpy(request->out + request->out_end, "0\r\n\r\n", 5);
+                    request->out_end += 5;
+                    request->source = HTTP_SOURCE_NONE;
+                }
+                room = HTTP_OUT_SIZE - request->out_end;
+            }
+            break;
+
+        case HTTP_SOURCE_NONE:
+            break;
+    }
+}
+
+static void http_transmit(http_request_t *request) {
+    for (;;) {
+        http_fill(request);
+        if (request->overflow) {
+            return;
+        }
+        size_t pending = request->out_end - request->out_start;
+        if (!pending) {
+            if (request->source == HTTP_SOURCE_NONE) {
+                request->state = HTTP_STATE_DONE;
+            }
+            return;
+        }
+
+        size_t room = request->client.availableForWrite();
+        if (!room) {
+            return;
+        }
+        size_t n = request->client.write((const uint8_t *)request->out + request->out_start, min(pending, room));
+        if (!n) {
+            return;
+        }
+        request->last_progress = millis();
+        request->out_start += n;
+        if (request->out_start == request->out_end) {
+            request->out_start = request->out_end = 0;
+        }
+    }
+}
+
+static void http_close(uint8_t index) {
+    http_request_t *request = connections[index];
+    if (request->upload_started && !request->upload_ended) {
+        http_upload(request, HTTP_UPLOAD_ABORT, nullptr, 0);
+    }
+    if (!request->detached) {
+        request->client.stop();
+    }
+    if (request->file) {
+        request->file.close();
+    }
+    void (*callback)() = request->on_close;
+    delete request;
+    connections[index] = nullptr;
+    if (callback) {
+        callback();
+    }
+}
+
+static void http_accept() {
+    WiFiClient client = server->available();
+    if (!client) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+        if (!connections[i]) {
+            http_request_t *request = new (std::nothrow) http_request_t(client);
+            if (!request) {
+                break;
+            }
+            request->last_progress = millis();
+            connections[i] = request;
+            return;
+        }
+    }
+
+    static const char busy[] PROGMEM =
+        "HTTP/1.1 503 Service Unavailable\r\n"
+        "Retry-After: 1\r\n"
+        "Content-Length: 0\r\n"
+        "Connection: close\r\n\r\n";
+    client.write_P(busy, sizeof(busy) - 1);
+    client.stop();
+}
+
+void http_server_loop() {
+    if (!server) {
+        return;
+    }
+    http_accept();
+
+    for (uint8_t i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+        http_request_t *request = connections[i];
+        if (!request) {
+            continue;
+        }
+        if (request->state < HTTP_STATE_SEND) {
+            http_receive(request);
+        }
+        if (request->state == HTTP_STATE_SEND && !request->overflow) {
+            http_transmit(request);
+        }
+
+        if (request->state == HTTP_STATE_DONE || request->overflow) {
+            http_close(i);
+        } else if (!request->client.connected()) {
+            http_close(i);
+        } else if (millis() - request->last_progress > HTTP_TIMEOUT) {
+            MIE_LOG_WARNING("HTTP connection timed out");
+            http_close(i);
+        }
+    }
+}
+
+uint8_t http_connection_count() {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+        count += connections[i] != nullptr;
+    }
+    return count;
+}
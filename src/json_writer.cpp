@@ -0,0 +1,175 @@
+#include "json_writer.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+JsonWriter::JsonWriter(char *buffer, size_t size, sink_t sink, void *context) :
+        buffer(buffer), size(size), used(0), total(0), sink(sink), context(context),
+        nonEmpty(0), depth(0), afterKey(false) {
+}
+
+void JsonWriter::flush() {
+    if (used) {
+        sink(context, buffer, used);
+        used = 0;
+    }
+}
+
+void JsonWriter::put(char c) {
+    if (used == size) {
+        flush();
+    }
+    buffer[used++] = c;
+    total++;
+}
+
+void JsonWriter::write(const char *data, size_t length) {
+    while (length) {
+        if (used == size) {
+            flush();
+        }
+        size_t n = length < size - used ? length : size - used;
+        memcpy(buffer + used, data, n);
+        used += n;
+        total += n;
+        data += n;
+        length -= n;
+    }
+}
+
+// comma before every element but the first in a container
+void JsonWriter::separate() {
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+    if (depth == 0) {
+        return;
+    }
+    uint32_t bit = 1UL << (depth - 1);
+    if (nonEmpty & bit) {
+        put(',');
+    }
+    nonEmpty |= bit;
+}
+
+void JsonWriter::open(char c) {
+    separate();
+    put(c);
+    depth++;
+    nonEmpty &= ~(1UL << (depth - 1));
+}
+
+void JsonWriter::close(char c) {
+    depth--;
+    put(c);
+}
+
+void JsonWriter::beginObject() {
+    open('{');
+}
+
+void JsonWriter::endObject() {
+    close('}');
+}
+
+void JsonWriter::beginArray() {
+    open('[');
+}
+
+void JsonWriter::endArray() {
+    close(']');
+}
+
+void JsonWriter::string(const char *str) {
+    static const char hex[] = "0123456789abcdef";
+
+    put('"');
+    const char *run = str;
+    for (const char *p = str; *p; p++) {
+        unsigned char c = *p;
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        write(run, p - run);
+        run = p + 1;
+        put('\\');
+        if (c == '"' || c == '\\') {
+            put(c);
+        } else if (c == '\n') {
+            put('n');
+        } else if (c == '\r') {
+            put('r');
+        } else if (c == '\t') {
+            put('t');
+        } else {
+            write("u00", 3);
+            put(hex[c >> 4]);
+            put(hex[c & 0xf]);
+        }
+    }
+    write(run, strlen(run));
+    put('"');
+}
+
+void JsonWriter::key(const char *name) {
+    separate();
+    string(name);
+    put(':');
+    afterKey = true;
+}
+
+void JsonWriter::value(const char *str) {
+    if (!str) {
+        null();
+        return;
+    }
+    separate();
+    string(str);
+}
+
+void JsonWriter::value(bool b) {
+    separate();
+    if (b) {
+        write("true", 4);
+    } else {
+        write("false", 5);
+    }
+}
+
+void JsonWriter::value(int n) {
+    value((long)n);
+}
+
+void JsonWriter::value(unsigned int n) {
+    value((unsigned long)n);
+}
+
+void JsonWriter::value(long n) {
+    char str[24];
+    separate();
+    write(str, snprintf(str, sizeof(str), "%ld", n));
+}
+
+void JsonWriter::value(unsigned long n) {
+    char str[24];
+    separate();
+    write(str, snprintf(str, sizeof(str), "%lu", n));
+}
+
+void JsonWriter::value(double n, uint8_t decimals) {
+    if (!isfinite(n)) {
+        null();
+        return;
+    }
+    char str[24];
+    separate();
+    size_t length = snprintf(str, sizeof(str), "%.*f", decimals, n);
+    write(str, length < sizeof(str) ? length : sizeof(str) - 1);
+}
+
+void JsonWriter::null() {
+    separate();
+    write("null", 4);
+}
@@ -1,14 +1,18 @@
 #include <Arduino.h>
-#include <Ticker.h>
 
+#include "counters.h"
 #include "debug.h"
 #include "env_sensor.h"
+#include "heap_tracker.h"
 #include "heatpump_client.h"
 #include "homekit.h"
 #include "led_status_patterns.h"
 #include "mqtt.h"
 #include "ntp_clock.h"
+#include "profiler.h"
+#include "scheduler.h"
 #include "settings.h"
+#include "stack_monitor.h"
 #include "web.h"
 #include "wifi_manager.h"
 
@@ -19,6 +23,8 @@ char name[25];
 char hostname[25];
 
 void setup() {
+    StackProbe probe(STACK_SETUP);
+
     Serial.begin(115200);
     Serial.println();
 
@@ -28,25 +34,51 @@ void setup() {
     sprintf(hostname, HOSTNAME_PREFIX "%06x", ESP.getChipId());
 
     settings_init();
+    counters_init();
+    heap_tag_set(HEAP_TAG_LOGGER);
     debug_init(name);
+    heap_tag_set(HEAP_TAG_SYSTEM);
     wifi_init(name);
     ntp_clock_init();
+    heap_tag_set(HEAP_TAG_WEB);
     web_init(hostname);
+    heap_tag_set(HEAP_TAG_MQTT);
     mqtt_init(name);
+    heap_tag_set(HEAP_TAG_SENSOR);
     env_sensor_init();
 
+    heap_tag_set(HEAP_TAG_HOMEKIT);
     homekit_init(name, loop);
 
+    heap_tag_set(HEAP_TAG_HEATPUMP);
     if (!heatpump_init()) {
         led_status_signal(&status_led_error);
     }
 
+    heap_tag_set(HEAP_TAG_SYSTEM);
+    heap_tracker_init();
+
     led_status_done();
 }
 
+// scheduler tasks tag their own allocations
 void loop() {
+    profiler_start();
+    heap_tag_t tag = heap_tag_set(HEAP_TAG_WEB);
     web_loop();
+    profiler_mark(PROFILER_WEB);
+    heap_tag_set(HEAP_TAG_HOMEKIT);
     homekit_loop();
+    profiler_mark(PROFILER_HOMEKIT);
+    heap_tag_set(HEAP_TAG_SYSTEM);
+    scheduler_loop();
+    profiler_mark(PROFILER_SCHEDULER);
+    heap_tag_set(HEAP_TAG_MQTT);
     mqtt_loop();
+    profiler_mark(PROFILER_MQTT);
+    heap_tag_set(HEAP_TAG_LOGGER);
     debug_loop();
+    profiler_mark(PROFILER_DEBUG);
+    heap_tag_set(tag);
+    profiler_end();
 }
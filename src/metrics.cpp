@@ -0,0 +1,130 @@
+#include "metrics.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include "debug.h"
+
+// exposed buckets are 2, 4, ... 24: up to 3us, 15us, ... ~16.8s
+#define METRICS_EXPOSED_BUCKETS (METRICS_BUCKETS / 2)
+// buckets, +Inf, sum and count
+#define METRICS_HISTOGRAM_LINES (METRICS_EXPOSED_BUCKETS + 3)
+
+static const metric_t *metrics[METRICS_MAX];
+static uint8_t metrics_count = 0;
+
+static const char *const type_names[] = {"gauge", "counter", "histogram"};
+
+void metrics_observe(metrics_histogram_t *histogram, uint32_t us) {
+    uint8_t bucket = us ? 32 - __builtin_clz(us) : 0;
+    histogram->count++;
+    histogram->sum += us;
+    histogram->buckets[bucket < METRICS_BUCKETS ? bucket : METRICS_BUCKETS]++;
+    if (us > histogram->max) {
+        histogram->max = us;
+    }
+}
+
+void metrics_register(const metric_t *metric) {
+    if (metrics_count == METRICS_MAX) {
+        MIE_LOG_WARNING("Too many metrics, %s not registered", metric->name);
+        return;
+    }
+    metrics[metrics_count++] = metric;
+}
+
+static uint8_t metric_series(const metric_t *metric) {
+    return metric->label ? metric->series : 1;
+}
+
+static uint16_t metric_lines(const metric_t *metric) {
+    uint16_t per_series = metric->type == METRIC_HISTOGRAM ? METRICS_HISTOGRAM_LINES : 1;
+    // HELP and TYPE
+    return 2 + metric_series(metric) * per_series;
+}
+
+// {label="value"} with extra appended inside the braces, empty without
+// either
+static void metric_labels(const metric_t *metric, uint8_t index, const char *extra,
+        char *str, size_t size) {
+    if (metric->label && extra) {
+        snprintf(str, size, "{%s=\"%s\",%s}", metric->label, metric->label_value(index), extra);
+    } else if (metric->label) {
+        snprintf(str, size, "{%s=\"%s\"}", metric->label, metric->label_value(index));
+    } else if (extra) {
+        snprintf(str, size, "{%s}", extra);
+    } else {
+        str[0] = '\0';
+    }
+}
+
+static int histogram_line(const metric_t *metric, uint8_t index, uint8_t line, char *str, size_t size) {
+    const metrics_histogram_t *histogram = metric->histogram(index);
+    char labels[64];
+
+    if (line < METRICS_EXPOSED_BUCKETS) {
+        uint8_t last = 2 * (line + 1);
+        uint32_t cumulative = 0;
+        for (uint8_t i = 0; i <= last; i++) {
+            cumulative += histogram->buckets[i];
+        }
+        char le[20];
+        snprintf(le, sizeof(le), "le=\"%.6f\"", ((1UL << last) - 1) / 1e6);
+        metric_labels(metric, index, le, labels, sizeof(labels));
+        return snprintf(str, size, "%s_bucket%s %u\n", metric->name, labels, cumulative);
+    }
+
+    switch (line - METRICS_EXPOSED_BUCKETS) {
+        case 0:
+            metric_labels(metric, index, "le=\"+Inf\"", labels, sizeof(labels));
+            return snprintf(str, size, "%s_bucket%s %u\n", metric->name, labels, histogram->count);
+        case 1:
+            metric_labels(metric, index, nullptr, labels, sizeof(labels));
+            return snprintf(str, size, "%s_sum%s %.6f\n", metric->name, labels, histogram->sum / 1e6);
+        default:
+            metric_labels(metric, index, nullptr, labels, sizeof(labels));
+            return snprintf(str, size, "%s_count%s %u\n", metric->name, labels, histogram->count);
+    }
+}
+
+static int value_line(const metric_t *metric, uint8_t index, char *str, size_t size) {
+    double value = metric->value(index);
+    if (isnan(value)) {
+        str[0] = '\0';
+        return 0;
+    }
+    char labels[64];
+    metric_labels(metric, index, nullptr, labels, sizeof(labels));
+    return snprintf(str, size, "%s%s %.10g\n", metric->name, labels, value);
+}
+
+bool metrics_line(uint16_t index, char *line, size_t size) {
+    uint8_t i = 0;
+    while (i < metrics_count && index >= metric_lines(metrics[i])) {
+        index -= metric_lines(metrics[i]);
+        i++;
+    }
+    if (i == metrics_count) {
+        return false;
+    }
+
+    const metric_t *metric = metrics[i];
+    int length;
+    if (index == 0) {
+        length = snprintf(line, size, "# HELP %s %s\n", metric->name, metric->help);
+    } else if (index == 1) {
+        length = snprintf(line, size, "# TYPE %s %s\n", metric->name, type_names[metric->type]);
+    } else if (metric->type == METRIC_HISTOGRAM) {
+        index -= 2;
+        length = histogram_line(metric, index / METRICS_HISTOGRAM_LINES, index % METRICS_HISTOGRAM_LINES,
+                line, size);
+    } else {
+        length = value_line(metric, index - 2, line, size);
+    }
+
+    if (length < 0 || (size_t)length >= size) {
+        MIE_LOG_WARNING("Metric line too long for %s", metric->name);
+        line[0] = '\0';
+    }
+    return true;
+}
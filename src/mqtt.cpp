@@ -5,6 +5,7 @@
 #include <Ticker.h>
 
 #include "debug.h"
+#include "metrics.h"
 #include "settings.h"
 
 static WiFiClient net;
@@ -16,9 +17,34 @@ bool mqtt_is_configured() {
     return strlen(settings.mqtt_server);
 }
 
+static double metric_connected(uint8_t index) {
+    return mqtt.connected();
+}
+
+// PubSubClient state: 0 connected, negative for connection errors
+static double metric_state(uint8_t index) {
+    return mqtt.state();
+}
+
+static const metric_t metrics[] = {
+    {"mel_mqtt_connected", METRIC_GAUGE, "Whether the MQTT broker is connected", metric_connected},
+    {"mel_mqtt_state", METRIC_GAUGE, "MQTT client state, negative for errors", metric_state},
+};
+
+static void mqtt_register_metrics() {
+    static bool registered = false;
+    if (!registered) {
+        for (const metric_t &metric : metrics) {
+            metrics_register(&metric);
+        }
+        registered = true;
+    }
+}
+
 bool mqtt_init(const char* name) {
+    client_id = name;
     if (mqtt_is_configured()) {
-        client_id = name;
+        mqtt_register_metrics();
         MIE_LOG("Connecting to MQTT broker %s:%u", settings.mqtt_server, settings.mqtt_port);
         mqtt.setServer(settings.mqtt_server, settings.mqtt_port);
         return mqtt_connect();
@@ -28,6 +54,17 @@ bool mqtt_init(const char* name) {
     }
 }
 
+void mqtt_reload() {
+    mqtt.disconnect();
+    if (mqtt_is_configured()) {
+        mqtt_register_metrics();
+        MIE_LOG("MQTT broker changed to %s:%u", settings.mqtt_server, settings.mqtt_port);
+        mqtt.setServer(settings.mqtt_server, settings.mqtt_port);
+    } else {
+        MIE_LOG("MQTT reporting disabled");
+    }
+}
+
 bool mqtt_connect() {
     if (!mqtt_is_configured()) {
         return false;
@@ -46,7 +83,7 @@ bool mqtt_connect() {
     if (tick < timeout) {
         return true;
     } else {
-        MIE_LOG("MQTT connection failed");
+        MIE_LOG_WARNING("MQTT connection failed");
         return false;
     }
 }
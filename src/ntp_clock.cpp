@@ -24,7 +24,7 @@ void ntp_clock_init() {
         delay(500);
     }
     if (!timeWasSet) {
-        MIE_LOG("NTP timed out");
+        MIE_LOG_WARNING("NTP timed out");
     }
 
     setSyncProvider([] { return time(nullptr); });
@@ -0,0 +1,97 @@
+#include "profiler.h"
+
+#include <Arduino.h>
+
+static const char *const section_names[PROFILER_SECTIONS] = {
+    "system", "web", "homekit", "scheduler", "mqtt", "debug", "loop",
+};
+
+static profiler_histogram_t histograms[PROFILER_SECTIONS];
+static profiler_stall_t stalls[PROFILER_STALLS];
+
+// cycle counts; the counter wraps after ~26s at 160MHz, longer sections
+// are not measured correctly
+static uint32_t loop_start;
+static uint32_t last_mark;
+static bool ended = false;
+static uint32_t iteration[PROFILER_SECTIONS];
+
+static uint32_t elapsed_us(uint32_t now, uint32_t since) {
+    return (now - since) / ESP.getCpuFreqMHz();
+}
+
+static void record_stall(uint32_t duration) {
+    uint8_t slot = PROFILER_STALLS;
+    while (slot > 0 && stalls[slot - 1].duration < duration) {
+        slot--;
+    }
+    if (slot == PROFILER_STALLS) {
+        return;
+    }
+    memmove(&stalls[slot + 1], &stalls[slot], (PROFILER_STALLS - slot - 1) * sizeof(profiler_stall_t));
+
+    profiler_stall_t *stall = &stalls[slot];
+    stall->at = millis();
+    stall->duration = duration;
+    stall->cause = PROFILER_LOOP;
+    stall->cause_duration = 0;
+    for (uint8_t i = 0; i < PROFILER_LOOP; i++) {
+        if (iteration[i] > stall->cause_duration) {
+            stall->cause = (profiler_section_t)i;
+            stall->cause_duration = iteration[i];
+        }
+    }
+}
+
+void profiler_start() {
+    uint32_t now = ESP.getCycleCount();
+    if (ended) {
+        metrics_observe(&histograms[PROFILER_SYSTEM], elapsed_us(now, last_mark));
+    }
+    memset(iteration, 0, sizeof(iteration));
+    loop_start = now;
+    last_mark = now;
+}
+
+void profiler_mark(profiler_section_t section) {
+    uint32_t now = ESP.getCycleCount();
+    uint32_t us = elapsed_us(now, last_mark);
+    iteration[section] += us;
+    metrics_observe(&histograms[section], us);
+    last_mark = now;
+}
+
+void profiler_end() {
+    uint32_t now = ESP.getCycleCount();
+    uint32_t us = elapsed_us(now, loop_start);
+    metrics_observe(&histograms[PROFILER_LOOP], us);
+    record_stall(us);
+    last_mark = now;
+    ended = true;
+}
+
+const char *profiler_section_name(profiler_section_t section) {
+    return section_names[section];
+}
+
+const profiler_histogram_t *profiler_histogram(profiler_section_t section) {
+    return &histograms[section];
+}
+
+uint32_t profiler_percentile(profiler_section_t section, uint8_t percentile) {
+    const profiler_histogram_t *histogram = &histograms[section];
+    uint32_t rank = ((uint64_t)histogram->count * percentile + 99) / 100;
+    uint32_t seen = 0;
+    for (uint8_t bucket = 0; bucket < PROFILER_BUCKETS; bucket++) {
+        seen += histogram->buckets[bucket];
+        if (seen >= rank && seen > 0) {
+            uint32_t upper = bucket ? (1UL << bucket) - 1 : 0;
+            return min(upper, histogram->max);
+        }
+    }
+    return histogram->max;
+}
+
+const profiler_stall_t *profiler_stalls() {
+    return stalls;
+}
@@ -0,0 +1,150 @@
+#include "scheduler.h"
+
+#include <Arduino.h>
+
+#include "debug.h"
+
+static scheduler_task_t tasks[SCHEDULER_MAX_TASKS];
+static uint8_t task_count = 0;
+
+static uint32_t defer_until = 0;
+static bool deferring = false;
+
+static bool is_due(const scheduler_task_t *task, uint32_t now) {
+    return task->armed && (int32_t)(now - task->next) >= 0;
+}
+
+static bool is_deferred(const scheduler_task_t *task, uint32_t now) {
+    if (deferring && (int32_t)(now - defer_until) >= 0) {
+        deferring = false;
+    }
+    return deferring && task->priority == SCHEDULER_PRIORITY_LOW;
+}
+
+static scheduler_task_t *add_task(const char *name, uint32_t interval, scheduler_priority_t priority,
+        uint32_t budget, std::function<void()> callback) {
+    if (task_count == SCHEDULER_MAX_TASKS) {
+        MIE_LOG_WARNING("Too many tasks, %s not scheduled", name);
+        return nullptr;
+    }
+
+    scheduler_task_t *task = &tasks[task_count++];
+    *task = scheduler_task_t();
+    task->name = name;
+    task->callback = callback;
+    task->priority = priority;
+    task->interval = interval;
+    task->budget = budget;
+    return task;
+}
+
+scheduler_task_t *scheduler_every(const char *name, uint32_t interval, scheduler_priority_t priority,
+        uint32_t budget, std::function<void()> callback) {
+    // stagger first runs so tasks with related intervals don't stay aligned
+    uint32_t phase = (task_count * SCHEDULER_STAGGER_MS) % interval;
+    scheduler_task_t *task = add_task(name, interval, priority, budget, callback);
+    if (task) {
+        task->next = millis() + interval + phase;
+        task->armed = true;
+    }
+    return task;
+}
+
+scheduler_task_t *scheduler_once(const char *name, scheduler_priority_t priority,
+        uint32_t budget, std::function<void()> callback) {
+    return add_task(name, 0, priority, budget, callback);
+}
+
+void scheduler_run_in(scheduler_task_t *task, uint32_t delay) {
+    if (!task) {
+        return;
+    }
+    task->next = millis() + delay;
+    task->armed = true;
+    task->waiting = false;
+}
+
+void scheduler_defer(uint32_t duration) {
+    uint32_t until = millis() + duration;
+    if (!deferring || (int32_t)(until - defer_until) > 0) {
+        defer_until = until;
+    }
+    deferring = true;
+}
+
+// highest priority due task, the one waiting longest among equals
+static scheduler_task_t *next_task(uint32_t now) {
+    scheduler_task_t *next = nullptr;
+    for (uint8_t i = 0; i < task_count; i++) {
+        scheduler_task_t *task = &tasks[i];
+        if (!is_due(task, now)) {
+            continue;
+        }
+        if (is_deferred(task, now)) {
+            if (!task->waiting) {
+                task->waiting = true;
+                task->deferrals++;
+            }
+            continue;
+        }
+        if (!next || task->priority < next->priority ||
+                (task->priority == next->priority && (int32_t)(task->next - next->next) < 0)) {
+            next = task;
+        }
+    }
+    return next;
+}
+
+static void run_task(scheduler_task_t *task, uint32_t now) {
+    uint32_t late = now - task->next;
+    if (task->interval) {
+        task->next += task->interval;
+        // skip missed runs instead of catching up in a burst
+        if ((int32_t)(now - task->next) >= 0) {
+            task->next = now + task->interval;
+        }
+    } else {
+        task->armed = false;
+    }
+    task->waiting = false;
+
+    uint32_t start = micros();
+    task->callback();
+    uint32_t elapsed = micros() - start;
+
+    task->runs++;
+    task->total_us += elapsed;
+    task->max_us = max(task->max_us, elapsed);
+    task->max_late = max(task->max_late, late);
+    if (elapsed > task->budget) {
+        task->overruns++;
+        MIE_LOG_WARNING("Task %s %ums over budget", task->name, (elapsed - task->budget) / 1000);
+    }
+}
+
+void scheduler_loop() {
+    uint32_t start = micros();
+    scheduler_task_t *task;
+    while ((task = next_task(millis()))) {
+        if (micros() - start >= SCHEDULER_PASS_BUDGET) {
+            // mark what is left so the delay shows in the statistics
+            uint32_t now = millis();
+            for (uint8_t i = 0; i < task_count; i++) {
+                if (is_due(&tasks[i], now) && !tasks[i].waiting) {
+                    tasks[i].waiting = true;
+                    tasks[i].deferrals++;
+                }
+            }
+            break;
+        }
+        run_task(task, millis());
+    }
+}
+
+uint8_t scheduler_task_count() {
+    return task_count;
+}
+
+const scheduler_task_t *scheduler_task(uint8_t index) {
+    return index < task_count ? &tasks[index] : nullptr;
+}
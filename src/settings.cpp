@@ -1,37 +1,306 @@
 #include "settings.h"
 
-#include <ArduinoJson.h>
 #include <LittleFS.h>
+#include <ctype.h>
+#include <stddef.h>
+
+#include "debug.h"
+
+#define SETTINGS_MAGIC 0x534c454d // "MELS"
 
 Settings settings;
-#define JSON_CAPACITY 512
 
-void settings_init() {
-    LittleFS.begin();
-    File f = LittleFS.open(CONFIG_FILE, "r");
+#define SETTING_STRING_FIELD(key, field, change, label, placeholder, caption) \
+    {key, SETTING_STRING, offsetof(Settings, field), sizeof(Settings::field), 0, 0, 0, change, label, placeholder, caption}
+#define SETTING_UINT16_FIELD(key, field, min, max, fallback, change, label, placeholder, caption) \
+    {key, SETTING_UINT16, offsetof(Settings, field), sizeof(Settings::field), min, max, fallback, change, label, placeholder, caption}
+#define SETTING_BOOL_FIELD(key, field, change, label, placeholder, caption) \
+    {key, SETTING_BOOL, offsetof(Settings, field), sizeof(Settings::field), 0, 1, 0, change, label, placeholder, caption}
+
+// in web form order; the keys are the ones config.json has always had, so
+// older firmware still reads it after a downgrade
+const setting_t settings_schema[] = {
+    SETTING_STRING_FIELD("mqtt_server", mqtt_server, SETTINGS_CHANGE_MQTT, "MQTT Broker", "Address", nullptr),
+    SETTING_UINT16_FIELD("mqtt_port", mqtt_port, 1, 65535, 1883, SETTINGS_CHANGE_MQTT, nullptr, "Port", nullptr),
+    SETTING_STRING_FIELD("mqtt_temp", mqtt_temp, 0, "Environment Sensor", "Temperature reporting topic", nullptr),
+    SETTING_STRING_FIELD("mqtt_hum", mqtt_humidity, 0, nullptr, "Relative humidity reporting topic", nullptr),
+    SETTING_STRING_FIELD("mqtt_dew_point", mqtt_dew_point, 0, nullptr, "Dew point reporting topic",
+            "If these topics are set, the readings are periodically posted to mqtt. "
+            "— This feature requires an external sensor."),
+    SETTING_STRING_FIELD("syslog_server", syslog_server, SETTINGS_CHANGE_DEBUG, "Syslog", "Server",
+            "If set, log lines are sent to this server over UDP."),
+    SETTING_UINT16_FIELD("syslog_port", syslog_port, 1, 65535, 514, SETTINGS_CHANGE_DEBUG, nullptr, "Port", nullptr),
+    SETTING_BOOL_FIELD("debug", debug, SETTINGS_CHANGE_DEBUG, nullptr, nullptr, nullptr),
+};
+
+const uint8_t settings_schema_count = sizeof(settings_schema) / sizeof(settings_schema[0]);
+
+struct settings_image_t {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+    // CRC-32 of everything after it
+    uint32_t crc;
+    // the copy with the highest one is current
+    uint32_t sequence;
+    Settings settings;
+};
+
+static const char *const slot_files[SETTINGS_SLOTS] = {SETTINGS_FILE_0, SETTINGS_FILE_1};
+
+// sequence of the current image, 0 when there is none
+static uint32_t sequence = 0;
+
+static uint32_t crc32(const void *data, size_t size) {
+    const uint8_t *bytes = (const uint8_t *)data;
+    uint32_t crc = 0xffffffff;
+    for (size_t i = 0; i < size; i++) {
+        crc ^= bytes[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+static uint32_t image_crc(const settings_image_t *image) {
+    return crc32(&image->sequence, sizeof(settings_image_t) - offsetof(settings_image_t, sequence));
+}
+
+static bool image_read(const char *path, settings_image_t *image) {
+    File f = LittleFS.open(path, "r");
     if (!f) {
-        MIE_LOG("Creating empty config file");
-        f = LittleFS.open(CONFIG_FILE, "w");
-        f.write("{}");
-        f.close();
-        f = LittleFS.open(CONFIG_FILE, "r");
+        return false;
+    }
+    size_t n = f.read((uint8_t *)image, sizeof(settings_image_t));
+    f.close();
+    return n == sizeof(settings_image_t) &&
+            image->magic == SETTINGS_MAGIC &&
+            image->version == SETTINGS_VERSION &&
+            image->size == sizeof(Settings) &&
+            image->crc == image_crc(image);
+}
+
+// strings in an image are not trusted to be terminated
+static void settings_terminate() {
+    for (uint8_t i = 0; i < settings_schema_count; i++) {
+        const setting_t *setting = &settings_schema[i];
+        if (setting->type == SETTING_STRING) {
+            ((char *)&settings + setting->offset)[setting->size - 1] = '\0';
+        }
     }
+}
 
+// the newest valid image into settings
+static bool settings_read() {
+    settings_image_t image;
+    sequence = 0;
+    for (uint8_t slot = 0; slot < SETTINGS_SLOTS; slot++) {
+        if (!image_read(slot_files[slot], &image)) {
+            if (LittleFS.exists(slot_files[slot])) {
+                MIE_LOG_WARNING("Settings copy %s is not valid", slot_files[slot]);
+            }
+            continue;
+        }
+        if (image.sequence > sequence) {
+            sequence = image.sequence;
+            settings = image.settings;
+        }
+    }
+    settings_terminate();
+    return sequence > 0;
+}
+
+// from the JSON export, for the first boot with binary settings or after
+// the layout changed
+static void settings_import() {
+    File f = LittleFS.open(CONFIG_FILE, "r");
     StaticJsonDocument<JSON_CAPACITY> doc;
-    DeserializationError error = deserializeJson(doc, f);
-    if (error) {
-        MIE_LOG("Error loading configuration file");
-        LittleFS.remove(CONFIG_FILE);
+    if (f) {
+        DeserializationError error = deserializeJson(doc, f);
+        f.close();
+        if (error) {
+            MIE_LOG_ERROR("Error loading configuration file");
+            doc.clear();
+        } else {
+            MIE_LOG("Importing configuration file");
+        }
+    }
+    settings_load(doc);
+}
+
+void settings_init() {
+    LittleFS.begin();
+    memset(&settings, 0, sizeof(settings));
+    if (!settings_read()) {
+        settings_import();
+        settings_save();
+    } else if (!LittleFS.exists(CONFIG_FILE)) {
+        settings_save();
+    }
+}
+
+static const setting_t *setting_find(const char *key) {
+    for (uint8_t i = 0; i < settings_schema_count; i++) {
+        if (strcmp(key, settings_schema[i].key) == 0) {
+            return &settings_schema[i];
+        }
+    }
+    return nullptr;
+}
+
+// value from its text into field, or only checked when field is null;
+// false if it's not valid
+static bool setting_parse(const setting_t *setting, const char *value, void *field) {
+    switch (setting->type) {
+        case SETTING_STRING:
+            if (strlen(value) >= setting->size) {
+                return false;
+            }
+            if (field) {
+                strlcpy((char *)field, value, setting->size);
+            }
+            return true;
+
+        case SETTING_UINT16: {
+            char *end;
+            unsigned long number = strtoul(value, &end, 10);
+            if (!isdigit(value[0]) || *end != '\0' || number < setting->min || number > setting->max) {
+                return false;
+            }
+            if (field) {
+                *(uint16_t *)field = number;
+            }
+            return true;
+        }
+
+        case SETTING_BOOL: {
+            bool enabled = strcmp(value, "1") == 0 || strcmp(value, "true") == 0;
+            if (!enabled && strcmp(value, "0") != 0 && strcmp(value, "false") != 0) {
+                return false;
+            }
+            if (field) {
+                *(bool *)field = enabled;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+static void setting_reset(const setting_t *setting, void *field) {
+    switch (setting->type) {
+        case SETTING_STRING:
+            *(char *)field = '\0';
+            break;
+        case SETTING_UINT16:
+            *(uint16_t *)field = setting->fallback;
+            break;
+        case SETTING_BOOL:
+            *(bool *)field = setting->fallback;
+            break;
     }
+}
 
-    uint16_t port = strtol(doc["mqtt_port"] | "", nullptr, 10);
-    settings.mqtt_port = port > 0 ? port : 1883;
-    strlcpy(settings.mqtt_server, doc["mqtt_server"] | "", sizeof(settings.mqtt_server));
-    strlcpy(settings.mqtt_temp, doc["mqtt_temp"] | "", sizeof(settings.mqtt_temp));
-    strlcpy(settings.mqtt_humidity, doc["mqtt_hum"] | "", sizeof(settings.mqtt_humidity));
-    strlcpy(settings.mqtt_dew_point, doc["mqtt_dew_point"] | "", sizeof(settings.mqtt_dew_point));
-    const char *value = doc["debug"] | "0";
-    settings.debug = strcmp(value, "1") == 0 || strcmp(value, "true") == 0;
+static bool setting_changed(const setting_t *setting, const Settings *previous) {
+    const void *before = (const uint8_t *)previous + setting->offset;
+    const void *after = (const uint8_t *)&settings + setting->offset;
+    if (setting->type == SETTING_STRING) {
+        return strcmp((const char *)before, (const char *)after) != 0;
+    }
+    return memcmp(before, after, setting->size) != 0;
+}
 
+uint8_t settings_load(const JsonDocument &doc) {
+    Settings previous = settings;
+    uint8_t changes = 0;
+    for (uint8_t i = 0; i < settings_schema_count; i++) {
+        const setting_t *setting = &settings_schema[i];
+        void *field = (uint8_t *)&settings + setting->offset;
+        const char *value = doc[setting->key] | "";
+        if (!setting_parse(setting, value, field)) {
+            if (strlen(value)) {
+                MIE_LOG_WARNING("Ignoring invalid setting %s", setting->key);
+            }
+            setting_reset(setting, field);
+        }
+        if (setting_changed(setting, &previous)) {
+            changes |= setting->change;
+        }
+    }
+    return changes;
+}
+
+// values as strings and empty or disabled ones left out, like the web UI
+// stores them; char * so the document keeps copies
+void settings_export(JsonDocument &doc) {
+    doc.clear();
+    for (uint8_t i = 0; i < settings_schema_count; i++) {
+        const setting_t *setting = &settings_schema[i];
+        const void *field = (const uint8_t *)&settings + setting->offset;
+        switch (setting->type) {
+            case SETTING_STRING:
+                if (strlen((const char *)field)) {
+                    doc[setting->key] = (char *)field;
+                }
+                break;
+            case SETTING_UINT16: {
+                char number[6];
+                snprintf(number, sizeof(number), "%u", *(const uint16_t *)field);
+                doc[setting->key] = (char *)number;
+                break;
+            }
+            case SETTING_BOOL:
+                if (*(const bool *)field) {
+                    doc[setting->key] = (char *)"1";
+                }
+                break;
+        }
+    }
+}
+
+bool settings_save() {
+    settings_image_t image;
+    memset(&image, 0, sizeof(image));
+    image.magic = SETTINGS_MAGIC;
+    image.version = SETTINGS_VERSION;
+    image.size = sizeof(Settings);
+    image.sequence = sequence + 1;
+    image.settings = settings;
+    image.crc = image_crc(&image);
+
+    // over the older copy, the current one stays until this one is complete
+    File f = LittleFS.open(slot_files[image.sequence % SETTINGS_SLOTS], "w");
+    size_t written = f ? f.write((const uint8_t *)&image, sizeof(image)) : 0;
     f.close();
+    if (written != sizeof(image)) {
+        MIE_LOG_ERROR("Error saving settings");
+        return false;
+    }
+    sequence = image.sequence;
+
+    StaticJsonDocument<JSON_CAPACITY> doc;
+    settings_export(doc);
+    f = LittleFS.open(CONFIG_FILE, "w");
+    serializeJson(doc, f);
+    f.close();
+    return true;
+}
+
+// key and value are not const so the document stores copies
+bool settings_update(JsonDocument &doc, char *key, char *value) {
+    const setting_t *setting = setting_find(key);
+    if (!setting) {
+        return false;
+    }
+
+    if (strlen(value) > 0) {
+        if (!setting_parse(setting, value, nullptr)) {
+            return false;
+        }
+        doc[key] = value;
+    } else {
+        doc.remove(key);
+    }
+    return true;
 }
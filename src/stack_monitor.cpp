@@ -0,0 +1,75 @@
+#include "stack_monitor.h"
+
+#include <Arduino.h>
+
+static const char *const entry_names[STACK_ENTRIES] = {
+    "setup",
+    "web index",
+    "web get settings",
+    "web post settings",
+    "web status",
+    "web tasks",
+    "web heap",
+    "web stack",
+    "web events",
+    "web events push",
+    "web metrics",
+    "hk target state",
+    "hk target temperature",
+    "hk dehumidifier active",
+    "hk horizontal swing",
+    "hk fan active",
+    "hk fan speed",
+    "hk fan auto",
+    "hk vertical swing",
+    "hp sync",
+    "hp update",
+    "hp settings changed",
+    "hp status changed",
+};
+
+static stack_entry_stats_t stats[STACK_ENTRIES];
+static uint32_t min_free = UINT32_MAX;
+
+StackProbe *StackProbe::active = nullptr;
+
+// the depth reached so far counts for every probe still open
+void StackProbe::observe(uint32_t free) {
+    for (StackProbe *probe = this; probe; probe = probe->outer) {
+        probe->minFree = min(probe->minFree, free);
+    }
+    min_free = min(min_free, free);
+}
+
+StackProbe::StackProbe(stack_entry_t entry) : entry(entry), minFree(UINT32_MAX), outer(active) {
+    if (outer) {
+        outer->observe(ESP.getFreeContStack());
+    } else {
+        min_free = min(min_free, ESP.getFreeContStack());
+    }
+    ESP.resetFreeContStack();
+    active = this;
+}
+
+StackProbe::~StackProbe() {
+    observe(ESP.getFreeContStack());
+    active = outer;
+
+    stack_entry_stats_t *entryStats = &stats[entry];
+    entryStats->calls++;
+    entryStats->min_free = entryStats->calls > 1 ? min(entryStats->min_free, minFree) : minFree;
+}
+
+const char *stack_entry_name(stack_entry_t entry) {
+    return entry_names[entry];
+}
+
+const stack_entry_stats_t *stack_entry_stats(stack_entry_t entry) {
+    return &stats[entry];
+}
+
+uint32_t stack_min_free() {
+    // includes whatever ran outside a probe since the last repaint
+    min_free = min(min_free, ESP.getFreeContStack());
+    return min_free;
+}
@@ -1,48 +1,114 @@
 #include "web.h"
 
 #include <ArduinoJson.h>
-#include <ESP8266HTTPUpdateServer.h>
-#include <ESP8266WebServer.h>
 #include <ESP8266mDNS.h>
 #include <LittleFS.h>
 #include <Time.h>
+#include <Updater.h>
+#include <WiFiUdp.h>
 
+#include "control_api.h"
+#include "counters.h"
+#include "crash_log.h"
 #include "debug.h"
 #include "env_sensor.h"
+#include "heap_tracker.h"
 #include "heatpump_client.h"
 #include "homekit.h"
+#include "http_server.h"
+#include "json_writer.h"
+#include "metrics.h"
 #include "mqtt.h"
+#include "profiler.h"
+#include "scheduler.h"
 #include "settings.h"
+#include "stack_monitor.h"
 #include "wifi_manager.h"
 
 // CLI update:
 // curl -F "firmware=@<FILENAME>.bin" <ADDRESS>/_update
 
-#define JSON_CAPACITY 512
+#define MIME_HTML "text/html"
+#define MIME_JSON "application/json"
+#define MIME_TEXT "text/plain"
+#define MIME_PROMETHEUS "text/plain; version=0.0.4"
 
-static ESP8266WebServer httpServer(80);
-static ESP8266HTTPUpdateServer updateServer;
+// /_status is served from a snapshot rebuilt when the state changes or
+// after this many milliseconds
+#define STATUS_SNAPSHOT_PERIOD 5000
+#define STATUS_SNAPSHOT_SIZE 512
 
-using namespace mime;
+// /_events pushes the status fields that changed every EVENTS_INTERVAL to at
+// most EVENTS_MAX_CLIENTS subscribers
+#define EVENTS_MAX_CLIENTS 2
+#define EVENTS_INTERVAL 1000
+#define EVENTS_STALL_TIMEOUT 10000
+#define EVENTS_BUFFER_SIZE 600
+#define EVENTS_BUDGET 20000
 
-extern const char* index_html;
+// generated from web/index.html by scripts/process_html.py
+extern const uint8_t index_html_gz[];
+extern const size_t index_html_gz_size;
+extern const char *index_html_etag;
 
-template <size_t SIZE>
-static void status_heap(char (&str)[SIZE]) {
-    snprintf(str, sizeof(str), "%d.%03dB / %d%% / %d.%03dB",
-            ESP.getFreeHeap() / 1000, ESP.getFreeHeap() % 1000,
-            ESP.getHeapFragmentation(),
-            ESP.getMaxFreeBlockSize() / 1000, ESP.getMaxFreeBlockSize() % 1000);
+static void status_title(char *str, size_t size) {
+    strlcpy(str, WiFi.hostname().c_str(), size);
+}
+
+static void status_heatpump(char *str, size_t size) {
+    strlcpy(str, heatpump.isConnected() ? "connected" : "not connected", size);
+}
+
+// what the unit is set to and doing
+static void status_state(char *str, size_t size) {
+    if (!heatpump.isConnected()) {
+        strlcpy(str, "-", size);
+        return;
+    }
+
+    heatpumpSettings settings = heatpump.getSettings();
+    float room = heatpump.getRoomTemperature();
+    if (!heatpump.getPowerSettingBool()) {
+        snprintf(str, size, "off, room %.1fºC", room);
+    } else {
+        snprintf(str, size, "%s %.1fºC fan %s, room %.1fºC%s",
+                settings.mode, settings.temperature, settings.fan, room,
+                heatpump.getOperating() ? ", running" : "");
+    }
+}
+
+static void status_homekit(char *str, size_t size) {
+    if (homekit_is_paired()) {
+        int clients = homekit_clients_count();
+        snprintf(str, size, "paired, %d client%s", clients, clients == 1 ? "" : "s");
+    } else {
+        snprintf(str, size, "waiting for pairing");
+    }
+}
+
+static void status_env(char *str, size_t size) {
+    strlcpy(str, strlen(env_sensor_status) ? env_sensor_status : "not connected", size);
+}
+
+static void status_mqtt(char *str, size_t size) {
+    if (!mqtt_is_configured()) {
+        strlcpy(str, "not configured", size);
+    } else if (mqtt.state() == MQTT_CONNECTED) {
+        strlcpy(str, "connected", size);
+    } else if (mqtt.state() == MQTT_DISCONNECTED) {
+        strlcpy(str, "disconnected", size);
+    } else {
+        snprintf(str, size, "connection error: %d", mqtt.state());
+    }
 }
 
-static void status_uptime(char (&str)[20]) {
+static void status_uptime(char *str, size_t size) {
     long val = millis() / 1000;
     int days = elapsedDays(val);
     int hours = numberOfHours(val);
     int minutes = numberOfMinutes(val);
     int seconds = numberOfSeconds(val);
 
-    size_t size = sizeof(str);
     if (days > 0) {
         snprintf(str, size, "%dd %dh %dm %ds", days, hours, minutes, seconds);
     } else if (hours > 0) {
@@ -54,140 +120,725 @@ static void status_uptime(char (&str)[20]) {
     }
 }
 
-static void status_mqtt(char (&str)[22]) {
-    size_t size = sizeof(str);
-    if (!mqtt_is_configured()) {
-        strlcpy(str, "not configured", size);
-    } else if (mqtt.state() == MQTT_CONNECTED) {
-        strlcpy(str, "connected", size);
-    } else if (mqtt.state() == MQTT_DISCONNECTED) {
-        strlcpy(str, "disconnected", size);
-    } else {
-        snprintf(str, size, "connection error: %d", mqtt.state());
+static void status_heap(char *str, size_t size) {
+    snprintf(str, size, "%d.%03dB / %d%% / %d.%03dB",
+            ESP.getFreeHeap() / 1000, ESP.getFreeHeap() % 1000,
+            ESP.getHeapFragmentation(),
+            ESP.getMaxFreeBlockSize() / 1000, ESP.getMaxFreeBlockSize() % 1000);
+}
+
+// loop() iteration p50 / p99 / max and the cause of the slowest one
+static void status_loop(char *str, size_t size) {
+    const profiler_stall_t *stall = profiler_stalls();
+    snprintf(str, size, "%.1f / %.1f / %.1fms",
+            profiler_percentile(PROFILER_LOOP, 50) / 1000.0,
+            profiler_percentile(PROFILER_LOOP, 99) / 1000.0,
+            profiler_histogram(PROFILER_LOOP)->max / 1000.0);
+    if (stall->duration) {
+        size_t len = strlen(str);
+        snprintf(str + len, size - len, " (%s %ums)",
+                profiler_section_name(stall->cause), stall->cause_duration / 1000);
     }
 }
 
-static void status_homekit(char (&str)[20]) {
-    size_t size = sizeof(str);
-    if (homekit_is_paired()) {
-        int clients = homekit_clients_count();
-        snprintf(str, size, "paired, %d client%s", clients, clients == 1 ? "" : "s");
-    } else {
-        snprintf(str, size, "waiting for pairing");
+static void status_counters(char *str, size_t size) {
+    snprintf(str, size, "%u boots / %u crashes / %uh running / %u starts",
+            counters_get(COUNTER_BOOTS), counters_get(COUNTER_CRASHES),
+            counters_get(COUNTER_RUNTIME) / 3600, counters_get(COUNTER_COMPRESSOR_STARTS));
+}
+
+static void status_reset(char *str, size_t size) {
+    strlcpy(str, crash_log_reset_reason(), size);
+}
+
+static void status_firmware(char *str, size_t size) {
+    snprintf(str, size, "%s (%s)", GIT_DESCRIBE, GIT_HASH);
+}
+
+// fields of /_status and of the event stream, shown in the web UI as
+// #status_<key>
+struct status_field_t {
+    const char *key;
+    void (*format)(char *str, size_t size);
+};
+
+static const status_field_t status_fields[] = {
+    {"title", status_title},
+    {"heatpump", status_heatpump},
+    {"state", status_state},
+    {"homekit", status_homekit},
+    {"env", status_env},
+    {"mqtt", status_mqtt},
+    {"uptime", status_uptime},
+    {"heap", status_heap},
+    {"loop", status_loop},
+    {"counters", status_counters},
+    {"reset", status_reset},
+    {"firmware", status_firmware},
+};
+
+#define STATUS_FIELDS (sizeof(status_fields) / sizeof(status_fields[0]))
+#define STATUS_VALUE_SIZE 60
+
+static uint32_t fnv1a(const char *data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ (uint8_t)data[i]) * 16777619u;
     }
+    return hash;
 }
 
+// a JsonWriter sink for output that must fit in the buffer
+static void json_overflow(void *context, const char *data, size_t size) {
+    (void)data;
+    (void)size;
+    *(bool *)context = true;
+}
 
-static void web_get_settings() {
-    File config = LittleFS.open(CONFIG_FILE, "r");
-    size_t content_size = config.size();
-    char bytes[content_size + 1];
-    config.readBytes(bytes, content_size);
-    bytes[content_size] = '\0';
-    httpServer.send(200, mimeTable[json].mimeType, bytes);
+// write the fields selected by mask as a JSON object into buffer, returns
+// the length or 0 if it doesn't fit
+static size_t status_write(char *buffer, size_t size, uint32_t mask) {
+    bool overflow = false;
+    JsonWriter json(buffer, size, json_overflow, &overflow);
+    json.beginObject();
+    for (uint8_t i = 0; i < STATUS_FIELDS; i++) {
+        if (mask & (1UL << i)) {
+            char value[STATUS_VALUE_SIZE];
+            status_fields[i].format(value, sizeof(value));
+            json.field(status_fields[i].key, value);
+        }
+    }
+    json.endObject();
+
+    if (overflow) {
+        MIE_LOG_WARNING("Status too large: %u", json.written());
+        return 0;
+    }
+    return json.written();
 }
 
-static void web_post_settings() {
+#define STATUS_ALL ((1UL << STATUS_FIELDS) - 1)
+
+// answers 304 when the client already has this version
+static bool web_not_modified(http_request_t *request, const char *etag) {
+    http_add_header(request, "ETag", etag);
+    const char *match = http_header(request, HTTP_HEADER_IF_NONE_MATCH);
+    if (match && strcmp(match, etag) == 0) {
+        http_send(request, 304);
+        return true;
+    }
+    return false;
+}
+
+// the page changes only with the firmware: browsers keep it for a day and
+// revalidate with the ETag on reload
+static void web_get_index(http_request_t *request) {
+    StackProbe probe(STACK_WEB_INDEX);
+    http_add_header(request, "Cache-Control", "max-age=86400");
+    if (web_not_modified(request, index_html_etag)) {
+        return;
+    }
+    http_add_header(request, "Content-Encoding", "gzip");
+    http_send_P(request, 200, MIME_HTML, (PGM_P)index_html_gz, index_html_gz_size);
+}
+
+static void web_get_settings(http_request_t *request) {
+    StackProbe probe(STACK_WEB_GET_SETTINGS);
     File config = LittleFS.open(CONFIG_FILE, "r");
+    http_send_file(request, 200, MIME_JSON, config);
+}
+
+// the settings the web form shows, one per step
+static bool web_settings_schema_step(http_request_t *request, uint16_t step) {
+    JsonWriter &json = http_json(request);
+    if (step == 0) {
+        json.beginArray();
+    }
+    // the step-th setting with a placeholder
+    uint8_t i = 0;
+    for (uint16_t shown = 0; i < settings_schema_count; i++) {
+        if (settings_schema[i].placeholder && shown++ == step) {
+            break;
+        }
+    }
+    if (i < settings_schema_count) {
+        const setting_t *setting = &settings_schema[i];
+        json.beginObject();
+        json.field("key", setting->key);
+        switch (setting->type) {
+            case SETTING_STRING:
+                json.field("type", "text");
+                json.field("maxlength", setting->size - 1);
+                break;
+            case SETTING_UINT16:
+                json.field("type", "number");
+                json.field("min", setting->min);
+                json.field("max", setting->max);
+                break;
+            case SETTING_BOOL:
+                json.field("type", "checkbox");
+                break;
+        }
+        if (setting->label) {
+            json.field("label", setting->label);
+        }
+        json.field("placeholder", setting->placeholder);
+        if (setting->caption) {
+            json.field("caption", setting->caption);
+        }
+        json.endObject();
+        return true;
+    }
+    json.endArray();
+    return false;
+}
+
+static void web_get_settings_schema(http_request_t *request) {
+    http_send_steps(request, 200, MIME_JSON, web_settings_schema_step);
+}
+
+static void web_post_settings(http_request_t *request) {
+    StackProbe probe(STACK_WEB_POST_SETTINGS);
     StaticJsonDocument<JSON_CAPACITY> doc;
-    deserializeJson(doc, config);
-    config.close();
-
-    for (uint8_t i = 0; i < httpServer.args(); i++) {
-        String arg = httpServer.argName(i);
-        String value = httpServer.arg(i);
-        if (arg != "plain") {
-            if (value.length() > 0) {
-                doc[arg] = value;
-            } else {
-                doc.remove(arg);
-            }
+    settings_export(doc);
+
+    for (uint8_t i = 0; i < http_arg_count(request); i++) {
+        // the arguments live in the request buffer, as char * ArduinoJson
+        // copies them
+        if (!settings_update(doc, (char *)http_arg_name(request, i), (char *)http_arg_value(request, i))) {
+            // not echoed, the key may be anything
+            http_send(request, 400, MIME_TEXT, "Invalid setting");
+            return;
         }
     }
 
-    config = LittleFS.open(CONFIG_FILE, "w");
-    serializeJsonPretty(doc, config);
+    // applied right away, only what needs it is restarted
+    uint8_t changes = settings_load(doc);
+    settings_save();
+    if (changes & SETTINGS_CHANGE_MQTT) {
+        mqtt_reload();
+    }
+    if (changes & SETTINGS_CHANGE_DEBUG) {
+        debug_reload();
+    }
+
+    File config = LittleFS.open(CONFIG_FILE, "r");
+    if (changes & SETTINGS_CHANGE_RESTART) {
+        MIE_LOG("Settings changed, rebooting");
+        http_add_header(request, "X-Restart", "1");
+        http_on_close(request, [] {
+            crash_log_restart("settings changed");
+        });
+    }
+    http_send_file(request, 200, MIME_JSON, config);
+}
+
+// values that change the snapshot as soon as they change; uptime, heap and
+// loop times only refresh it every STATUS_SNAPSHOT_PERIOD
+struct status_key_t {
+    bool heatpump;
+    bool paired;
+    int clients;
+    int mqtt;
+    uint32_t env;
+    uint32_t state;
+};
 
-    size_t size = measureJsonPretty(doc);
-    char response[size + 1];
-    serializeJsonPretty(doc, response, sizeof(response));
-    config.close();
+static void status_key(status_key_t *key) {
+    memset(key, 0, sizeof(status_key_t));
+    key->heatpump = heatpump.isConnected();
+    key->paired = homekit_is_paired();
+    key->clients = homekit_clients_count();
+    key->mqtt = mqtt.state();
+    key->env = fnv1a(env_sensor_status, strlen(env_sensor_status));
 
-    httpServer.send(200, mimeTable[json].mimeType, response);
-    delay(1000);
-    ESP.restart();
+    char state[STATUS_VALUE_SIZE];
+    status_state(state, sizeof(state));
+    key->state = fnv1a(state, strlen(state));
 }
 
-static void web_get_status() {
-    char heap_str[25];
-    status_heap(heap_str);
-    char uptime_str[20];
-    status_uptime(uptime_str);
-    char mqtt_str[22];
-    status_mqtt(mqtt_str);
-    char homekit_str[20];
-    status_homekit(homekit_str);
-    char firmware_str[30];
-    snprintf(firmware_str, sizeof(firmware_str), "%s (%s)", GIT_DESCRIBE, GIT_HASH);
+static char status_snapshot[STATUS_SNAPSHOT_SIZE];
+static size_t status_snapshot_length = 0;
+static uint32_t status_snapshot_hash = 0;
+static uint32_t status_snapshot_time = 0;
+static status_key_t status_snapshot_key;
+// quoted, boot id and version
+static char status_etag[20];
 
-    StaticJsonDocument<JSON_CAPACITY> doc;
-    doc["title"] = WiFi.hostname();
-    doc["heatpump"] = heatpump.isConnected() ? "connected" : "not connected";
-    doc["homekit"] = homekit_str;
-    doc["env"] = strlen(env_sensor_status) ? env_sensor_status : "not connected";
-    doc["mqtt"] = mqtt_str;
-    doc["uptime"] = uptime_str;
-    doc["heap"] = heap_str;
-    doc["firmware"] = firmware_str;
-
-    size_t doc_size = measureJsonPretty(doc);
-    char response[doc_size + 1];
-    serializeJsonPretty(doc, response, sizeof(response));
-    httpServer.send(200, mimeTable[json].mimeType, response);
-}
-
-static void web_post_reboot() {
+static void status_snapshot_update() {
+    static uint32_t boot_id = ESP.random() & 0xffff;
+    static uint32_t version = 0;
+
+    status_key_t key;
+    status_key(&key);
+    bool changed = memcmp(&key, &status_snapshot_key, sizeof(key)) != 0;
+    bool expired = millis() - status_snapshot_time >= STATUS_SNAPSHOT_PERIOD;
+    if (version > 0 && !changed && !expired) {
+        return;
+    }
+
+    status_snapshot_key = key;
+    status_snapshot_time = millis();
+    status_snapshot_length = status_write(status_snapshot, sizeof(status_snapshot), STATUS_ALL);
+    if (!status_snapshot_length) {
+        status_snapshot_length = strlcpy(status_snapshot, "{}", sizeof(status_snapshot));
+    }
+
+    uint32_t hash = fnv1a(status_snapshot, status_snapshot_length);
+    if (version == 0 || hash != status_snapshot_hash) {
+        status_snapshot_hash = hash;
+        version++;
+        snprintf(status_etag, sizeof(status_etag), "\"%04x-%u\"", boot_id, version);
+    }
+}
+
+static void web_get_status(http_request_t *request) {
+    StackProbe probe(STACK_WEB_STATUS);
+    status_snapshot_update();
+
+    http_add_header(request, "Cache-Control", "no-cache");
+    if (web_not_modified(request, status_etag)) {
+        return;
+    }
+    http_send(request, 200, MIME_JSON, status_snapshot, status_snapshot_length);
+}
+
+struct events_client_t {
+    WiFiClient client;
+    bool active;
+    // skipped an event, gets every field with the next one
+    bool full;
+    uint32_t last_write;
+};
+
+static events_client_t events_clients[EVENTS_MAX_CLIENTS];
+// fields as last pushed
+static uint32_t events_hashes[STATUS_FIELDS];
+
+// "event: status" with the fields in mask, 0 if it doesn't fit
+static size_t events_format(char *buffer, size_t size, uint32_t mask) {
+    static const char prefix[] = "event: status\ndata: ";
+    size_t offset = sizeof(prefix) - 1;
+    memcpy(buffer, prefix, offset);
+    size_t length = status_write(buffer + offset, size - offset - 2, mask);
+    if (!length) {
+        return 0;
+    }
+    memcpy(buffer + offset + length, "\n\n", 2);
+    return offset + length + 2;
+}
+
+static void events_drop(events_client_t *subscriber) {
+    subscriber->client.stop();
+    subscriber->client = WiFiClient();
+    subscriber->active = false;
+}
+
+// never blocks: an event that doesn't fit in the TCP send buffer is skipped
+// and the subscriber catches up with a full one, or is dropped if it hasn't
+// taken anything for EVENTS_STALL_TIMEOUT
+static void events_send(events_client_t *subscriber, const char *data, size_t length) {
+    if ((size_t)subscriber->client.availableForWrite() < length) {
+        subscriber->full = true;
+        if (millis() - subscriber->last_write >= EVENTS_STALL_TIMEOUT) {
+            MIE_LOG_WARNING("Dropping stalled event subscriber %s", subscriber->client.remoteIP().toString().c_str());
+            events_drop(subscriber);
+        }
+        return;
+    }
+    subscriber->client.write(data, length);
+    subscriber->full = false;
+    subscriber->last_write = millis();
+}
+
+static void events_push() {
+    StackProbe probe(STACK_WEB_EVENTS_PUSH);
+    static char buffer[EVENTS_BUFFER_SIZE];
+
+    bool subscribed = false;
+    bool behind = false;
+    for (uint8_t i = 0; i < EVENTS_MAX_CLIENTS; i++) {
+        events_client_t *subscriber = &events_clients[i];
+        if (subscriber->active && !subscriber->client.connected()) {
+            events_drop(subscriber);
+        }
+        subscribed |= subscriber->active;
+        behind |= subscriber->active && subscriber->full;
+    }
+    if (!subscribed) {
+        return;
+    }
+
+    uint32_t changed = 0;
+    for (uint8_t i = 0; i < STATUS_FIELDS; i++) {
+        char value[STATUS_VALUE_SIZE];
+        status_fields[i].format(value, sizeof(value));
+        uint32_t hash = fnv1a(value, strlen(value));
+        if (hash != events_hashes[i]) {
+            events_hashes[i] = hash;
+            changed |= 1UL << i;
+        }
+    }
+
+    // subscribers that missed an event get every field, then the others
+    // only what changed
+    bool sent[EVENTS_MAX_CLIENTS] = {};
+    size_t length = behind ? events_format(buffer, sizeof(buffer), STATUS_ALL) : 0;
+    for (uint8_t i = 0; i < EVENTS_MAX_CLIENTS && length; i++) {
+        events_client_t *subscriber = &events_clients[i];
+        if (subscriber->active && subscriber->full) {
+            events_send(subscriber, buffer, length);
+            sent[i] = true;
+        }
+    }
+
+    if (!changed) {
+        return;
+    }
+    length = events_format(buffer, sizeof(buffer), changed);
+    for (uint8_t i = 0; i < EVENTS_MAX_CLIENTS && length; i++) {
+        events_client_t *subscriber = &events_clients[i];
+        if (subscriber->active && !subscriber->full && !sent[i]) {
+            events_send(subscriber, buffer, length);
+        }
+    }
+}
+
+static void web_get_events(http_request_t *request) {
+    StackProbe probe(STACK_WEB_EVENTS);
+
+    events_client_t *subscriber = nullptr;
+    for (uint8_t i = 0; i < EVENTS_MAX_CLIENTS; i++) {
+        if (events_clients[i].active && !events_clients[i].client.connected()) {
+            events_drop(&events_clients[i]);
+        }
+        if (!events_clients[i].active) {
+            subscriber = &events_clients[i];
+            break;
+        }
+    }
+    if (!subscriber) {
+        http_add_header(request, "Retry-After", "60");
+        http_send(request, 503, MIME_TEXT, "Too many subscribers");
+        return;
+    }
+
+    // the response stays open, taken over from the server
+    static const char head[] PROGMEM = "HTTP/1.1 200 OK\r\n"
+            "Content-Type: text/event-stream\r\n"
+            "Cache-Control: no-cache\r\n"
+            "Connection: keep-alive\r\n\r\n"
+            "retry: 5000\n\n";
+    subscriber->client = http_detach(request);
+    subscriber->client.setNoDelay(true);
+    subscriber->client.write_P(head, sizeof(head) - 1);
+    subscriber->active = true;
+    subscriber->full = true;
+    subscriber->last_write = millis();
+    MIE_LOG("Event subscriber %s", subscriber->client.remoteIP().toString().c_str());
+
+    // first event right away rather than at the next push
+    events_push();
+}
+
+static bool web_tasks_step(http_request_t *request, uint16_t step) {
+    JsonWriter &json = http_json(request);
+    if (step == 0) {
+        json.beginArray();
+    }
+    if (step < scheduler_task_count()) {
+        const scheduler_task_t *task = scheduler_task(step);
+        json.beginObject();
+        json.field("name", task->name);
+        json.field("priority", (int)task->priority);
+        json.field("runs", task->runs);
+        json.field("avg_us", task->runs ? (uint32_t)(task->total_us / task->runs) : 0);
+        json.field("max_us", task->max_us);
+        json.field("overruns", task->overruns);
+        json.field("deferrals", task->deferrals);
+        json.field("max_late_ms", task->max_late);
+        json.endObject();
+    }
+    if (step + 1 >= scheduler_task_count()) {
+        json.endArray();
+        return false;
+    }
+    return true;
+}
+
+static void web_get_tasks(http_request_t *request) {
+    StackProbe probe(STACK_WEB_TASKS);
+    http_send_steps(request, 200, MIME_JSON, web_tasks_step);
+}
+
+// a step per tag, then one per sample
+static bool web_heap_step(http_request_t *request, uint16_t step) {
+    JsonWriter &json = http_json(request);
+    if (step == 0) {
+        json.beginObject();
+        json.key("tags");
+        json.beginArray();
+    }
+    if (step < HEAP_TAG_COUNT) {
+        const heap_tag_stats_t *stats = heap_tag_stats((heap_tag_t)step);
+        json.beginObject();
+        json.field("name", heap_tag_name((heap_tag_t)step));
+        json.field("live", stats->live);
+        json.field("peak", stats->peak);
+        json.field("allocs", stats->allocs);
+        json.field("frees", stats->frees);
+        json.endObject();
+        return true;
+    }
+
+    uint16_t index = step - HEAP_TAG_COUNT;
+    if (index == 0) {
+        json.endArray();
+        json.field("untracked", heap_untracked());
+        json.key("samples");
+        json.beginArray();
+    }
+    if (index < heap_sample_count()) {
+        const heap_sample_t *sample = heap_sample(index);
+        json.beginObject();
+        json.field("at", sample->at);
+        json.field("free", sample->free);
+        json.field("max_block", sample->max_block);
+        json.field("fragmentation", sample->fragmentation);
+        json.endObject();
+    }
+    if (index + 1 >= heap_sample_count()) {
+        json.endArray();
+        json.endObject();
+        return false;
+    }
+    return true;
+}
+
+static void web_get_heap(http_request_t *request) {
+    StackProbe probe(STACK_WEB_HEAP);
+    http_send_steps(request, 200, MIME_JSON, web_heap_step);
+}
+
+static bool web_stack_step(http_request_t *request, uint16_t step) {
+    JsonWriter &json = http_json(request);
+    if (step == 0) {
+        json.beginObject();
+        json.field("min_free", stack_min_free());
+        json.key("entries");
+        json.beginArray();
+    }
+
+    const stack_entry_stats_t *stats = stack_entry_stats((stack_entry_t)step);
+    json.beginObject();
+    json.field("name", stack_entry_name((stack_entry_t)step));
+    json.field("calls", stats->calls);
+    if (stats->calls) {
+        json.field("min_free", stats->min_free);
+    }
+    json.endObject();
+
+    if (step + 1 == STACK_ENTRIES) {
+        json.endArray();
+        json.endObject();
+        return false;
+    }
+    return true;
+}
+
+static void web_get_stack(http_request_t *request) {
+    StackProbe probe(STACK_WEB_STACK);
+    http_send_steps(request, 200, MIME_JSON, web_stack_step);
+}
+
+// lines are short enough that a step always has room for this many
+#define METRICS_LINES_PER_STEP (HTTP_STEP_SIZE / METRICS_LINE_SIZE)
+
+static bool web_metrics_step(http_request_t *request, uint16_t step) {
+    char line[METRICS_LINE_SIZE];
+    for (uint8_t i = 0; i < METRICS_LINES_PER_STEP; i++) {
+        if (!metrics_line(step * METRICS_LINES_PER_STEP + i, line, sizeof(line))) {
+            return false;
+        }
+        http_write(request, line, strlen(line));
+    }
+    return true;
+}
+
+static void web_get_metrics(http_request_t *request) {
+    StackProbe probe(STACK_WEB_METRICS);
+    http_send_steps(request, 200, MIME_PROMETHEUS, web_metrics_step);
+}
+
+// a line per step, the position in the log is the step data so lines added
+// while sending don't shift it
+static bool web_log_step(http_request_t *request, uint16_t step) {
+    char line[HTTP_STEP_SIZE + 1];
+    if (!debug_log_line(http_step_data(request), line, sizeof(line))) {
+        return false;
+    }
+    size_t length = strlen(line);
+    if (length == sizeof(line) - 1) {
+        // cut to the step
+        line[length - 1] = '\n';
+    } else if (length == 0 || line[length - 1] != '\n') {
+        line[length++] = '\n';
+    }
+    http_write(request, line, length);
+    return true;
+}
+
+static void web_get_log(http_request_t *request) {
+    http_send_steps(request, 200, MIME_TEXT, web_log_step);
+}
+
+static void web_get_crash(http_request_t *request) {
+    File crash = LittleFS.open(CRASH_LOG_FILE, "r");
+    http_send_file(request, 200, MIME_TEXT, crash);
+}
+
+static double metric_uptime(uint8_t index) {
+    return millis() / 1000;
+}
+
+static double metric_heap_free(uint8_t index) {
+    return ESP.getFreeHeap();
+}
+
+static double metric_heap_max_block(uint8_t index) {
+    return ESP.getMaxFreeBlockSize();
+}
+
+static double metric_heap_fragmentation(uint8_t index) {
+    return ESP.getHeapFragmentation();
+}
+
+static double metric_stack_min_free(uint8_t index) {
+    return stack_min_free();
+}
+
+static const char *metric_loop_section(uint8_t index) {
+    return profiler_section_name((profiler_section_t)index);
+}
+
+static const metrics_histogram_t *metric_loop_durations(uint8_t index) {
+    return profiler_histogram((profiler_section_t)index);
+}
+
+static const metric_t web_metrics[] = {
+    {"mel_uptime_seconds", METRIC_COUNTER, "Seconds since boot", metric_uptime},
+    {"mel_heap_free_bytes", METRIC_GAUGE, "Free heap", metric_heap_free},
+    {"mel_heap_max_block_bytes", METRIC_GAUGE, "Largest free heap block", metric_heap_max_block},
+    {"mel_heap_fragmentation_percent", METRIC_GAUGE, "Heap fragmentation", metric_heap_fragmentation},
+    {"mel_stack_min_free_bytes", METRIC_GAUGE, "Least free stack seen since boot", metric_stack_min_free},
+    {"mel_loop_duration_seconds", METRIC_HISTOGRAM, "Time spent in each part of loop(), loop is the whole iteration",
+            nullptr, metric_loop_durations, "section", PROFILER_SECTIONS, metric_loop_section},
+};
+
+// OTA update from the web UI or the CLI, the image is written to flash as it
+// arrives
+static void web_update_upload(http_request_t *request, http_upload_stage_t stage,
+        const uint8_t *data, size_t size) {
+    switch (stage) {
+        case HTTP_UPLOAD_START: {
+            MIE_LOG("Firmware update started");
+            WiFiUDP::stopAll();
+            uint32_t space = (ESP.getFreeSketchSpace() - 0x1000) & 0xfffff000;
+            Update.begin(space, U_FLASH);
+            break;
+        }
+        case HTTP_UPLOAD_DATA:
+            if (!Update.hasError()) {
+                Update.write((uint8_t *)data, size);
+            }
+            break;
+        case HTTP_UPLOAD_END:
+            if (!Update.hasError()) {
+                Update.end(true);
+            }
+            break;
+        case HTTP_UPLOAD_ABORT:
+            MIE_LOG_WARNING("Firmware update aborted");
+            Update.end();
+            break;
+    }
+}
+
+static void web_post_update(http_request_t *request) {
+    if (!Update.isFinished() || Update.hasError()) {
+        char message[80];
+        snprintf(message, sizeof(message), "Update error: %s",
+                Update.hasError() ? Update.getErrorString().c_str() : "no firmware");
+        MIE_LOG_ERROR("%s", message);
+        Update.clearError();
+        http_send(request, 200, MIME_HTML, message);
+        return;
+    }
+    MIE_LOG("Firmware update done, rebooting");
+    http_send(request, 200, MIME_HTML, "Update Success! Rebooting...");
+    http_on_close(request, [] {
+        crash_log_restart("firmware update");
+    });
+}
+
+static void web_post_reboot(http_request_t *request) {
     MIE_LOG("Reboot from web UI");
-    httpServer.send(200, mimeTable[html].mimeType, "Rebooting...");
-    delay(1000);
-    ESP.restart();
+    http_send(request, 200, MIME_HTML, "Rebooting...");
+    http_on_close(request, [] {
+        crash_log_restart("reboot from web UI");
+    });
 }
 
-static void web_post_reset_wifi() {
+static void web_post_reset_wifi(http_request_t *request) {
     MIE_LOG("Reset WiFi settings");
-    httpServer.send(200, mimeTable[html].mimeType, "Reset WiFi settings. Rebooting...");
-    delay(1000);
-    wifiManager.resetSettings();
-    ESP.restart();
+    http_send(request, 200, MIME_HTML, "Reset WiFi settings. Rebooting...");
+    http_on_close(request, [] {
+        wifiManager.resetSettings();
+        crash_log_restart("WiFi settings reset");
+    });
 }
 
-static void web_post_unpair() {
+static void web_post_unpair(http_request_t *request) {
     MIE_LOG("Reset HomeKit pairing");
-    httpServer.send(200, mimeTable[html].mimeType, "Reset HomeKit pairing. Rebooting...");
-    delay(1000);
-    homekit_storage_reset();
-    ESP.restart();
+    http_send(request, 200, MIME_HTML, "Reset HomeKit pairing. Rebooting...");
+    http_on_close(request, [] {
+        homekit_storage_reset();
+        crash_log_restart("HomeKit pairing reset");
+    });
 }
 
 void web_init(const char* hostname) {
-    updateServer.setup(&httpServer, "/_update");
+    http_server_init(80);
 
-    httpServer.on("/", HTTP_GET, []() {
-        httpServer.send(200, mimeTable[html].mimeType, index_html);
-    });
+    http_on("/", HTTP_METHOD_GET, web_get_index);
+
+    http_on("/_settings", HTTP_METHOD_GET, web_get_settings);
+    http_on("/_settings", HTTP_METHOD_POST, web_post_settings);
+    http_on("/_settings/schema", HTTP_METHOD_GET, web_get_settings_schema);
+    http_on("/_status", HTTP_METHOD_GET, web_get_status);
+    http_on("/_events", HTTP_METHOD_GET, web_get_events);
+    http_on("/_tasks", HTTP_METHOD_GET, web_get_tasks);
+    http_on("/_heap", HTTP_METHOD_GET, web_get_heap);
+    http_on("/_stack", HTTP_METHOD_GET, web_get_stack);
+    http_on("/metrics", HTTP_METHOD_GET, web_get_metrics);
+    http_on("/_log", HTTP_METHOD_GET, web_get_log);
+    http_on("/_crash", HTTP_METHOD_GET, web_get_crash);
+    http_on("/_update", HTTP_METHOD_POST, web_post_update, web_update_upload);
+    http_on("/_reboot", HTTP_METHOD_POST, web_post_reboot);
+    http_on("/_reset_wifi", HTTP_METHOD_POST, web_post_reset_wifi);
+    http_on("/_unpair", HTTP_METHOD_POST, web_post_unpair);
+    control_api_init();
+
+    for (const metric_t &metric : web_metrics) {
+        metrics_register(&metric);
+    }
 
-    httpServer.on("/_settings", HTTP_GET, web_get_settings);
-    httpServer.on("/_settings", HTTP_POST, web_post_settings);
-    httpServer.on("/_status", HTTP_GET, web_get_status);
-    httpServer.on("/_reboot", HTTP_POST, web_post_reboot);
-    httpServer.on("/_reset_wifi", HTTP_POST, web_post_reset_wifi);
-    httpServer.on("/_unpair", HTTP_POST, web_post_unpair);
+    scheduler_every("web events", EVENTS_INTERVAL, SCHEDULER_PRIORITY_LOW, EVENTS_BUDGET, events_push);
 
     MDNS.begin(hostname);
     MDNS.addService("http", "tcp", 80);
-    httpServer.begin();
 }
 
 void web_loop() {
-    httpServer.handleClient();
+    http_server_loop();
 }
@@ -3,6 +3,7 @@
 #include <DoubleResetDetect.h>
 #include <Ticker.h>
 
+#include "crash_log.h"
 #include "debug.h"
 #include "homekit.h"
 #include "led_status_patterns.h"
@@ -28,13 +29,13 @@ void wifi_init(const char* ssid) {
     if (drd.detect()) {
         led_status_signal(&status_led_double_reset);
         while (!wifiManager.startConfigPortal(ssid)) {
-            MIE_LOG("WiFi config portail timed out, restarting");
+            MIE_LOG_WARNING("WiFi config portail timed out, restarting");
             delay(1000);
-            ESP.restart();
+            crash_log_restart("WiFi portal timed out");
         }
     } else {
         while (!wifiManager.autoConnect(ssid)) {
-            MIE_LOG("WiFi connection failed, trying again");
+            MIE_LOG_WARNING("WiFi connection failed, trying again");
         }
     }
 
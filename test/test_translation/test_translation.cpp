@@ -0,0 +1,273 @@
+// Heat pump <-> HomeKit translation: pio test -e native
+//
+// Runs the real src/heatpump_client.cpp, src/homekit.cpp and src/accessory.c
+// against the host shims. Without an attached unit, HeatPump::update()
+// reports the settings it was sent back as the unit's, so a setter test
+// sees the whole round trip.
+
+#include <Arduino.h>
+#include <HeatPump.h>
+#include <homekit/characteristics.h>
+#include <unity.h>
+
+#include "accessory.h"
+#include "heatpump_client.h"
+#include "homekit.h"
+#include "scheduler.h"
+
+// matches UPDATE_INTERVAL in src/homekit.cpp
+#define UPDATE_INTERVAL 5000
+
+static const heatpumpSettings off = {"OFF", "HEAT", 20, "QUIET", "AUTO", "|", false, true};
+static const heatpumpSettings cool = {"ON", "COOL", 22, "2", "SWING", "|", false, true};
+static const heatpumpSettings heat = {"ON", "HEAT", 24, "AUTO", "AUTO", "SWING", false, true};
+static const heatpumpSettings dry = {"ON", "DRY", 22, "AUTO", "AUTO", "|", false, true};
+
+static const heatpumpStatus running = {23.5, true, {"NONE", 0, 0, 0, 0}, 42};
+static const heatpumpStatus idle = {22.0, false, {"NONE", 0, 0, 0, 0}, 0};
+
+// lets the throttled update go out
+static void send_update() {
+    native_advance(UPDATE_INTERVAL);
+    scheduler_loop();
+}
+
+// the unit reports settings, through off so they always change
+static void receive(const heatpumpSettings &settings) {
+    heatpump.receiveSettings(off);
+    heatpump.receiveSettings(settings);
+}
+
+void setUp() {
+    // anything a previous test left pending goes out first
+    send_update();
+    receive(heat);
+}
+
+void tearDown() {
+}
+
+// --- Settings from the unit
+
+static void test_settings_cool() {
+    receive(cool);
+    TEST_ASSERT_EQUAL_UINT8(HOMEKIT_TARGET_HEATING_COOLING_STATE_COOL,
+            ch_thermostat_target_heating_cooling_state.value.uint8_value);
+    TEST_ASSERT_EQUAL_FLOAT(22, ch_thermostat_target_temperature.value.float_value);
+    TEST_ASSERT_EQUAL_UINT8(1, ch_fan_active.value.uint8_value);
+    TEST_ASSERT_EQUAL_FLOAT(HK_SPEED(3), ch_fan_rotation_speed.value.float_value);
+    TEST_ASSERT_EQUAL_UINT8(FAN_TARGET_STATE_MANUAL, ch_fan_target_state.value.uint8_value);
+    TEST_ASSERT_EQUAL_UINT8(1, ch_fan_swing_mode.value.uint8_value);
+    TEST_ASSERT_EQUAL_UINT8(0, ch_dehumidifier_active.value.uint8_value);
+    TEST_ASSERT_EQUAL_UINT8(0, ch_dehumidifier_swing_mode.value.uint8_value);
+}
+
+static void test_settings_heat_auto_fan() {
+    TEST_ASSERT_EQUAL_UINT8(HOMEKIT_TARGET_HEATING_COOLING_STATE_HEAT,
+            ch_thermostat_target_heating_cooling_state.value.uint8_value);
+    TEST_ASSERT_EQUAL_UINT8(FAN_TARGET_STATE_AUTO, ch_fan_target_state.value.uint8_value);
+    TEST_ASSERT_EQUAL_FLOAT(HK_SPEED(AUTO_FAN_SPEED), ch_fan_rotation_speed.value.float_value);
+    TEST_ASSERT_EQUAL_UINT8(0, ch_fan_swing_mode.value.uint8_value);
+    TEST_ASSERT_EQUAL_UINT8(1, ch_dehumidifier_swing_mode.value.uint8_value);
+}
+
+static void test_settings_dry() {
+    receive(dry);
+    TEST_ASSERT_EQUAL_UINT8(HOMEKIT_TARGET_HEATING_COOLING_STATE_OFF,
+            ch_thermostat_target_heating_cooling_state.value.uint8_value);
+    TEST_ASSERT_EQUAL_UINT8(1, ch_dehumidifier_active.value.uint8_value);
+    TEST_ASSERT_EQUAL_UINT8(1, ch_fan_active.value.uint8_value);
+}
+
+static void test_settings_off() {
+    heatpump.receiveSettings(off);
+    TEST_ASSERT_EQUAL_UINT8(HOMEKIT_TARGET_HEATING_COOLING_STATE_OFF,
+            ch_thermostat_target_heating_cooling_state.value.uint8_value);
+    TEST_ASSERT_EQUAL_UINT8(0, ch_fan_active.value.uint8_value);
+    TEST_ASSERT_EQUAL_UINT8(0, ch_dehumidifier_active.value.uint8_value);
+    TEST_ASSERT_EQUAL_FLOAT(HK_SPEED(1), ch_fan_rotation_speed.value.float_value);
+}
+
+// --- Status from the unit
+
+static void test_status_running() {
+    heatpump.receiveStatus(running);
+    TEST_ASSERT_EQUAL_FLOAT(23.5f, ch_thermostat_current_temperature.value.float_value);
+    TEST_ASSERT_EQUAL_UINT8(HOMEKIT_CURRENT_HEATING_COOLING_STATE_HEAT,
+            ch_thermostat_current_heating_cooling_state.value.uint8_value);
+    TEST_ASSERT_EQUAL_UINT8(FAN_CURRENT_STATE_BLOWING, ch_fan_current_state.value.uint8_value);
+}
+
+static void test_status_idle() {
+    heatpump.receiveStatus(running);
+    heatpump.receiveStatus(idle);
+    TEST_ASSERT_EQUAL_FLOAT(22.0f, ch_thermostat_current_temperature.value.float_value);
+    TEST_ASSERT_EQUAL_UINT8(HOMEKIT_CURRENT_HEATING_COOLING_STATE_OFF,
+            ch_thermostat_current_heating_cooling_state.value.uint8_value);
+    TEST_ASSERT_EQUAL_UINT8(FAN_CURRENT_STATE_IDLE, ch_fan_current_state.value.uint8_value);
+}
+
+// --- HomeKit setters
+
+static void test_setter_thermostat() {
+    ch_thermostat_target_heating_cooling_state.setter(HOMEKIT_UINT8_CPP(HOMEKIT_TARGET_HEATING_COOLING_STATE_COOL));
+    ch_thermostat_target_temperature.setter(HOMEKIT_FLOAT_CPP(19));
+    TEST_ASSERT_TRUE(homekit_update_pending());
+    send_update();
+
+    heatpumpSettings wanted = heatpump.wantedSettings();
+    TEST_ASSERT_EQUAL_STRING("ON", wanted.power);
+    TEST_ASSERT_EQUAL_STRING("COOL", wanted.mode);
+    TEST_ASSERT_EQUAL_FLOAT(19, wanted.temperature);
+    TEST_ASSERT_EQUAL_STRING("COOL", heatpump.getModeSetting());
+    TEST_ASSERT_FALSE(homekit_update_pending());
+}
+
+// the thermostat and the dehumidifier are one unit's modes, turning one on
+// turns the other off
+static void test_setter_thermostat_stops_dehumidifier() {
+    receive(dry);
+    ch_thermostat_target_heating_cooling_state.setter(HOMEKIT_UINT8_CPP(HOMEKIT_TARGET_HEATING_COOLING_STATE_HEAT));
+    TEST_ASSERT_EQUAL_UINT8(0, ch_dehumidifier_active.value.uint8_value);
+    TEST_ASSERT_EQUAL_UINT8(1, ch_fan_active.value.uint8_value);
+    send_update();
+
+    TEST_ASSERT_EQUAL_STRING("HEAT", heatpump.wantedSettings().mode);
+}
+
+static void test_setter_dehumidifier_stops_thermostat() {
+    ch_dehumidifier_active.setter(HOMEKIT_UINT8_CPP(1));
+    TEST_ASSERT_EQUAL_UINT8(HOMEKIT_TARGET_HEATING_COOLING_STATE_OFF,
+            ch_thermostat_target_heating_cooling_state.value.uint8_value);
+    send_update();
+
+    heatpumpSettings wanted = heatpump.wantedSettings();
+    TEST_ASSERT_EQUAL_STRING("ON", wanted.power);
+    TEST_ASSERT_EQUAL_STRING("DRY", wanted.mode);
+    TEST_ASSERT_EQUAL_UINT8(1, ch_dehumidifier_active.value.uint8_value);
+}
+
+static void test_setter_fan_off_resets_modes() {
+    receive(dry);
+    ch_fan_active.setter(HOMEKIT_UINT8_CPP(0));
+    TEST_ASSERT_EQUAL_UINT8(0, ch_dehumidifier_active.value.uint8_value);
+    TEST_ASSERT_EQUAL_UINT8(HOMEKIT_TARGET_HEATING_COOLING_STATE_OFF,
+            ch_thermostat_target_heating_cooling_state.value.uint8_value);
+    send_update();
+
+    TEST_ASSERT_EQUAL_STRING("OFF", heatpump.wantedSettings().power);
+}
+
+static void test_setter_fan_only() {
+    heatpump.receiveSettings(off);
+    ch_fan_active.setter(HOMEKIT_UINT8_CPP(1));
+    send_update();
+
+    heatpumpSettings wanted = heatpump.wantedSettings();
+    TEST_ASSERT_EQUAL_STRING("ON", wanted.power);
+    TEST_ASSERT_EQUAL_STRING("FAN", wanted.mode);
+}
+
+// in auto the speed shows the auto speed, a speed set then is put back
+static void test_setter_fan_speed_in_auto() {
+    ch_fan_rotation_speed.setter(HOMEKIT_FLOAT_CPP(60));
+    TEST_ASSERT_EQUAL_UINT8(FAN_TARGET_STATE_AUTO, ch_fan_target_state.value.uint8_value);
+    TEST_ASSERT_EQUAL_FLOAT(HK_SPEED(AUTO_FAN_SPEED), ch_fan_rotation_speed.value.float_value);
+    send_update();
+
+    TEST_ASSERT_EQUAL_STRING("AUTO", heatpump.wantedSettings().fan);
+}
+
+static void test_setter_fan_speed_manual() {
+    receive(cool);
+    ch_fan_rotation_speed.setter(HOMEKIT_FLOAT_CPP(99.6f));
+    TEST_ASSERT_EQUAL_FLOAT(100, ch_fan_rotation_speed.value.float_value);
+    TEST_ASSERT_EQUAL_UINT8(FAN_TARGET_STATE_MANUAL, ch_fan_target_state.value.uint8_value);
+    send_update();
+
+    TEST_ASSERT_EQUAL_STRING("4", heatpump.wantedSettings().fan);
+    TEST_ASSERT_EQUAL_FLOAT(HK_SPEED(5), ch_fan_rotation_speed.value.float_value);
+}
+
+// a speed set while the fan is off takes it out of auto
+static void test_setter_fan_speed_leaves_auto_when_off() {
+    heatpump.receiveSettings(off);
+    receive({"OFF", "HEAT", 20, "AUTO", "AUTO", "|", false, true});
+    ch_fan_rotation_speed.setter(HOMEKIT_FLOAT_CPP(40));
+    TEST_ASSERT_EQUAL_UINT8(FAN_TARGET_STATE_MANUAL, ch_fan_target_state.value.uint8_value);
+    TEST_ASSERT_EQUAL_FLOAT(40, ch_fan_rotation_speed.value.float_value);
+}
+
+static void test_setter_fan_auto() {
+    receive(cool);
+    ch_fan_target_state.setter(HOMEKIT_UINT8_CPP(FAN_TARGET_STATE_AUTO));
+    TEST_ASSERT_EQUAL_FLOAT(HK_SPEED(AUTO_FAN_SPEED), ch_fan_rotation_speed.value.float_value);
+    send_update();
+
+    TEST_ASSERT_EQUAL_STRING("AUTO", heatpump.wantedSettings().fan);
+    TEST_ASSERT_EQUAL_UINT8(FAN_TARGET_STATE_AUTO, ch_fan_target_state.value.uint8_value);
+}
+
+static void test_setter_fan_manual() {
+    receive(cool);
+    ch_fan_target_state.setter(HOMEKIT_UINT8_CPP(FAN_TARGET_STATE_MANUAL));
+    send_update();
+
+    TEST_ASSERT_EQUAL_STRING("2", heatpump.wantedSettings().fan);
+}
+
+// turning on with the speed at 0 would send no fan speed, it goes to auto
+static void test_setter_fan_on_without_speed() {
+    heatpump.receiveSettings(off);
+    accessory_set_float(&ch_fan_rotation_speed, 0, false);
+    accessory_set_uint8(&ch_fan_target_state, FAN_TARGET_STATE_MANUAL, false);
+    ch_thermostat_target_heating_cooling_state.setter(HOMEKIT_UINT8_CPP(HOMEKIT_TARGET_HEATING_COOLING_STATE_HEAT));
+    TEST_ASSERT_EQUAL_UINT8(1, ch_fan_active.value.uint8_value);
+    TEST_ASSERT_EQUAL_UINT8(FAN_TARGET_STATE_AUTO, ch_fan_target_state.value.uint8_value);
+    TEST_ASSERT_EQUAL_FLOAT(HK_SPEED(AUTO_FAN_SPEED), ch_fan_rotation_speed.value.float_value);
+}
+
+static void test_setter_swing() {
+    ch_fan_swing_mode.setter(HOMEKIT_UINT8_CPP(1));
+    ch_dehumidifier_swing_mode.setter(HOMEKIT_UINT8_CPP(0));
+    send_update();
+
+    heatpumpSettings wanted = heatpump.wantedSettings();
+    TEST_ASSERT_EQUAL_STRING("SWING", wanted.vane);
+    TEST_ASSERT_EQUAL_STRING("|", wanted.wideVane);
+}
+
+static void test_control_bounds() {
+    TEST_ASSERT_TRUE(homekit_control(&ch_thermostat_target_temperature, HOMEKIT_FLOAT_CPP(21)));
+    TEST_ASSERT_FALSE(homekit_control(&ch_thermostat_target_temperature, HOMEKIT_FLOAT_CPP(99)));
+    TEST_ASSERT_FALSE(homekit_control(&ch_thermostat_target_temperature, HOMEKIT_UINT8_CPP(21)));
+    TEST_ASSERT_FALSE(homekit_control(&ch_thermostat_target_heating_cooling_state, HOMEKIT_UINT8_CPP(7)));
+    TEST_ASSERT_EQUAL_FLOAT(21, ch_thermostat_target_temperature.value.float_value);
+}
+
+int main() {
+    homekit_init("Heat Pump test", [] {});
+    heatpump_init();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_settings_cool);
+    RUN_TEST(test_settings_heat_auto_fan);
+    RUN_TEST(test_settings_dry);
+    RUN_TEST(test_settings_off);
+    RUN_TEST(test_status_running);
+    RUN_TEST(test_status_idle);
+    RUN_TEST(test_setter_thermostat);
+    RUN_TEST(test_setter_thermostat_stops_dehumidifier);
+    RUN_TEST(test_setter_dehumidifier_stops_thermostat);
+    RUN_TEST(test_setter_fan_off_resets_modes);
+    RUN_TEST(test_setter_fan_only);
+    RUN_TEST(test_setter_fan_speed_in_auto);
+    RUN_TEST(test_setter_fan_speed_manual);
+    RUN_TEST(test_setter_fan_speed_leaves_auto_when_off);
+    RUN_TEST(test_setter_fan_auto);
+    RUN_TEST(test_setter_fan_manual);
+    RUN_TEST(test_setter_fan_on_without_speed);
+    RUN_TEST(test_setter_swing);
+    RUN_TEST(test_control_bounds);
+    return UNITY_END();
+}
@@ -0,0 +1,360 @@
+// The logger's host-buildable parts: pio test -e native
+//
+// The bounded queue the network sinks use, the syslog message format, how
+// repeated lines are told apart, and the syslog and telnet sinks against the WiFiUDP and WiFiClient shims. The
+// syslog sink sends real datagrams, received here on a loopback socket.
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <logline.h>
+#include <logqueue.h>
+#include <logrepeat.h>
+#include <logring.h>
+#include <logsink.h>
+#include <unity.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <string>
+
+// 2023-11-14T22:13:20Z
+#define BOOT_TIME 1700000000
+
+void setUp() {
+    WiFi.connected = true;
+}
+
+void tearDown() {
+}
+
+static std::string peek(const LogQueue &queue) {
+    char line[64];
+    uint16_t length = queue.peek(line, sizeof(line));
+    return std::string(line, length);
+}
+
+// --- LogQueue
+
+static void test_queue_order() {
+    uint8_t buffer[64];
+    LogQueue queue(buffer, sizeof(buffer));
+    TEST_ASSERT_EQUAL_UINT16(0, queue.peek(nullptr, 0));
+    TEST_ASSERT_TRUE(queue.push("one", 3));
+    TEST_ASSERT_TRUE(queue.push("two", 3));
+    TEST_ASSERT_EQUAL_UINT16(2, queue.count());
+    TEST_ASSERT_EQUAL_UINT16(2 * (sizeof(uint16_t) + 3), queue.used());
+
+    TEST_ASSERT_EQUAL_STRING("one", peek(queue).c_str());
+    queue.pop();
+    TEST_ASSERT_EQUAL_STRING("two", peek(queue).c_str());
+    queue.pop();
+    TEST_ASSERT_EQUAL_UINT16(0, queue.count());
+    TEST_ASSERT_EQUAL_UINT16(0, queue.used());
+    // popping an empty queue does nothing
+    queue.pop();
+    TEST_ASSERT_EQUAL_UINT16(0, queue.count());
+}
+
+// lines and their lengths split where the buffer wraps read back whole
+static void test_queue_wraps() {
+    uint8_t buffer[23];
+    LogQueue queue(buffer, sizeof(buffer));
+    char line[8];
+    for (int i = 0; i < 50; i++) {
+        int length = snprintf(line, sizeof(line), "line%d", i);
+        TEST_ASSERT_TRUE(queue.push(line, length));
+        if (i > 0) {
+            snprintf(line, sizeof(line), "line%d", i - 1);
+            TEST_ASSERT_EQUAL_STRING(line, peek(queue).c_str());
+            queue.pop();
+        }
+        TEST_ASSERT_EQUAL_UINT16(1, queue.count());
+    }
+}
+
+// a line that doesn't fit isn't queued, the ones queued stay as they are
+static void test_queue_full() {
+    uint8_t buffer[16];
+    LogQueue queue(buffer, sizeof(buffer));
+    TEST_ASSERT_TRUE(queue.push("12345", 5));
+    TEST_ASSERT_FALSE(queue.push("12345678", 8));
+    TEST_ASSERT_EQUAL_UINT16(1, queue.count());
+    TEST_ASSERT_TRUE(queue.push("1234567", 7));
+    TEST_ASSERT_EQUAL_UINT16(sizeof(buffer), queue.used());
+    TEST_ASSERT_FALSE(queue.push("1", 1));
+    TEST_ASSERT_FALSE(queue.push("", 0));
+
+    TEST_ASSERT_EQUAL_STRING("12345", peek(queue).c_str());
+    queue.pop();
+    TEST_ASSERT_EQUAL_STRING("1234567", peek(queue).c_str());
+    queue.clear();
+    TEST_ASSERT_EQUAL_UINT16(0, queue.count());
+    TEST_ASSERT_TRUE(queue.push("12345678901234", 14));
+}
+
+static void test_queue_peek_cuts() {
+    uint8_t buffer[32];
+    LogQueue queue(buffer, sizeof(buffer));
+    queue.push("0123456789", 10);
+    char line[4];
+    TEST_ASSERT_EQUAL_UINT16(4, queue.peek(line, sizeof(line)));
+    TEST_ASSERT_EQUAL_MEMORY("0123", line, 4);
+    // the line stays whole in the queue
+    TEST_ASSERT_EQUAL_STRING("0123456789", peek(queue).c_str());
+}
+
+// --- logSyslog()
+
+static std::string syslog_line(LogLevel level, time_t bootTime, int logTime, const char *text) {
+    LogLineFormat format;
+    format.bootTime = bootTime;
+    LogHeader header;
+    header.logLevel = level;
+    header.logTime = logTime;
+    char line[LOG_LINE_LENGTH];
+    size_t length = logSyslog(line, sizeof(line), format, header, "mie-c0ffee", "mie", text, strlen(text));
+    TEST_ASSERT_EQUAL_size_t(strlen(line), length);
+    return line;
+}
+
+// facility user (1), so the PRI is 8 + the severity
+static void test_syslog_priority() {
+    TEST_ASSERT_EQUAL_STRING("<11>1 - mie-c0ffee mie - - - failed",
+            syslog_line(llError, 0, 0, "failed").c_str());
+    TEST_ASSERT_EQUAL_STRING("<12>1 - mie-c0ffee mie - - - careful",
+            syslog_line(llWarning, 0, 0, "careful").c_str());
+    TEST_ASSERT_EQUAL_STRING("<14>1 - mie-c0ffee mie - - - fine",
+            syslog_line(llInfo, 0, 0, "fine").c_str());
+    TEST_ASSERT_EQUAL_STRING("<15>1 - mie-c0ffee mie - - - detail",
+            syslog_line(llDebug, 0, 0, "detail").c_str());
+}
+
+// with the clock set the line has its time in UTC, in milliseconds;
+// without it the timestamp is the nil value
+static void test_syslog_timestamp() {
+    TEST_ASSERT_EQUAL_STRING("<14>1 2023-11-14T22:13:21.234Z mie-c0ffee mie - - - fine",
+            syslog_line(llInfo, BOOT_TIME, 1234, "fine").c_str());
+    TEST_ASSERT_EQUAL_STRING("<14>1 - mie-c0ffee mie - - - fine",
+            syslog_line(llInfo, 0, 1234, "fine").c_str());
+}
+
+static void test_syslog_strips_line_end() {
+    TEST_ASSERT_EQUAL_STRING("<14>1 - mie-c0ffee mie - - - line",
+            syslog_line(llInfo, 0, 0, "line\r\n").c_str());
+    TEST_ASSERT_EQUAL_STRING("<14>1 - mie-c0ffee mie - - - two\r\nlines",
+            syslog_line(llInfo, 0, 0, "two\r\nlines\n\n").c_str());
+    TEST_ASSERT_EQUAL_STRING("<14>1 - mie-c0ffee mie - - - ",
+            syslog_line(llInfo, 0, 0, "\r\n").c_str());
+}
+
+static void test_syslog_cut() {
+    LogLineFormat format;
+    LogHeader header;
+    char line[32];
+    const char *text = "a line longer than the buffer";
+    size_t length = logSyslog(line, sizeof(line), format, header, "host", "app", text, strlen(text));
+    TEST_ASSERT_EQUAL_size_t(sizeof(line) - 1, length);
+    TEST_ASSERT_EQUAL_STRING("<14>1 - host app - - - a line l", line);
+}
+
+// --- LogSyslogSink
+
+static int listen_udp(uint16_t *port) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    TEST_ASSERT_TRUE(fd >= 0);
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    TEST_ASSERT_EQUAL_INT(0, bind(fd, (struct sockaddr *)&addr, sizeof(addr)));
+    socklen_t size = sizeof(addr);
+    getsockname(fd, (struct sockaddr *)&addr, &size);
+    *port = ntohs(addr.sin_port);
+    struct timeval timeout = {1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    return fd;
+}
+
+// a datagram, empty if none came
+static std::string receive_udp(int fd) {
+    char buffer[LOG_LINE_LENGTH];
+    ssize_t n = recvfrom(fd, buffer, sizeof(buffer), 0, nullptr, nullptr);
+    return n > 0 ? std::string(buffer, n) : std::string();
+}
+
+static void sink_write(LogSink &sink, LogLevel level, const char *text) {
+    LogLineFormat format;
+    format.bootTime = BOOT_TIME;
+    LogHeader header;
+    header.logLevel = level;
+    header.logTime = 500;
+    sink.write(format, header, text, strlen(text));
+}
+
+static void test_syslog_sink_sends() {
+    uint16_t port;
+    int fd = listen_udp(&port);
+    static LogSyslogSink sink;
+    TEST_ASSERT_FALSE(sink.active());
+    sink.begin("127.0.0.1", port, "mie-c0ffee", "mie");
+    TEST_ASSERT_TRUE(sink.active());
+
+    sink_write(sink, llWarning, "first\r\n");
+    sink_write(sink, llInfo, "second\r\n");
+    // nothing goes out from write()
+    char buffer[16];
+    TEST_ASSERT_TRUE(recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT) < 0);
+
+    sink.handle();
+    TEST_ASSERT_EQUAL_STRING("<12>1 2023-11-14T22:13:20.500Z mie-c0ffee mie - - - first",
+            receive_udp(fd).c_str());
+    TEST_ASSERT_EQUAL_STRING("<14>1 2023-11-14T22:13:20.500Z mie-c0ffee mie - - - second",
+            receive_udp(fd).c_str());
+    TEST_ASSERT_EQUAL_UINT32(0, sink.dropped);
+
+    sink.begin("", port, "mie-c0ffee", "mie");
+    TEST_ASSERT_FALSE(sink.active());
+    close(fd);
+}
+
+// a full queue drops and counts lines; at most SYSLOG_SENDS go out per
+// handle(), and none while WiFi is down
+static void test_syslog_sink_drops() {
+    uint16_t port;
+    int fd = listen_udp(&port);
+    static LogSyslogSink sink;
+    sink.begin("127.0.0.1", port, "mie-c0ffee", "mie");
+
+    char text[40];
+    memset(text, 'x', sizeof(text) - 1);
+    text[sizeof(text) - 1] = '\0';
+    uint8_t queued = 0;
+    for (int i = 0; i < 20; i++) {
+        sink_write(sink, llInfo, text);
+        if (sink.dropped == 0) {
+            queued++;
+        }
+    }
+    TEST_ASSERT_TRUE(queued > SYSLOG_SENDS && queued < 20);
+    TEST_ASSERT_EQUAL_UINT32(20 - queued, sink.dropped);
+
+    WiFi.connected = false;
+    sink.handle();
+    char buffer[16];
+    TEST_ASSERT_TRUE(recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT) < 0);
+
+    WiFi.connected = true;
+    sink.handle();
+    for (uint8_t i = 0; i < SYSLOG_SENDS; i++) {
+        TEST_ASSERT_TRUE(receive_udp(fd).find(text) != std::string::npos);
+    }
+    TEST_ASSERT_TRUE(recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT) < 0);
+    while (queued > SYSLOG_SENDS) {
+        sink.handle();
+        for (uint8_t i = 0; i < SYSLOG_SENDS && queued > SYSLOG_SENDS; i++, queued--) {
+            TEST_ASSERT_TRUE(receive_udp(fd).size() > 0);
+        }
+    }
+    close(fd);
+}
+
+// --- LogRepeat
+
+// the newest record is compared in place, also when it wraps around the end
+// of the ring
+static void test_ring_newest() {
+    static LogRing ring;
+    LogHeader header;
+    header.logLevel = llInfo;
+    TEST_ASSERT_FALSE(ring.isNewest(header, "line"));
+    char line[100];
+    for (int i = 0; i < 100; i++) {
+        header.logSize = snprintf(line, sizeof(line), "%0*d", 40 + i % 50, i);
+        ring.add(header, line);
+        TEST_ASSERT_TRUE(ring.isNewest(header, line));
+        line[0] ^= 1;
+        TEST_ASSERT_FALSE(ring.isNewest(header, line));
+        line[0] ^= 1;
+        line[header.logSize - 1] ^= 1;
+        TEST_ASSERT_FALSE(ring.isNewest(header, line));
+        line[header.logSize - 1] ^= 1;
+    }
+    header.logLevel = llWarning;
+    TEST_ASSERT_FALSE(ring.isNewest(header, line));
+}
+
+// only the same bytes are a repeat, and only while the line kept is the
+// newest one in the ring
+static void test_repeat_same_bytes() {
+    static LogRing ring;
+    LogRepeat repeat;
+    LogHeader header;
+    header.logSize = 4;
+    repeat.keep(header);
+    ring.add(header, "abcd");
+
+    header.logTime = 1000;
+    TEST_ASSERT_TRUE(repeat.repeated(header, "abcd", ring));
+    TEST_ASSERT_FALSE(repeat.repeated(header, "abce", ring));
+    TEST_ASSERT_FALSE(repeat.repeated(header, "bacd", ring));
+    header.logLevel = llError;
+    TEST_ASSERT_FALSE(repeat.repeated(header, "abcd", ring));
+
+    header.logLevel = llInfo;
+    ring.add(header, "efgh");
+    TEST_ASSERT_FALSE(repeat.repeated(header, "abcd", ring));
+    LogHeader report;
+    TEST_ASSERT_EQUAL_UINT16(1, repeat.take(report));
+}
+
+// --- LogClientSink
+
+// the client's send window takes part of a line, the rest follows once it
+// has room again
+static void test_telnet_sink_window() {
+    WiFiServer server(23);
+    auto socket = WiFiServer::connect();
+    WiFiClient client = server.available();
+    socket->window = 10;
+    static LogClientSink sink(client);
+    sink.enable(true);
+
+    LogLineFormat format;
+    format.timeFormat = ltNone;
+    format.showLevel = false;
+    LogHeader header;
+    sink.write(format, header, "first line\r\n", 12);
+    sink.write(format, header, "second\r\n", 8);
+    TEST_ASSERT_EQUAL_STRING("first line", socket->output.c_str());
+
+    std::string received = socket->output;
+    while (received.size() < 20) {
+        socket->output.clear();
+        sink.handle();
+        TEST_ASSERT_TRUE(socket->output.size() > 0);
+        received += socket->output;
+    }
+    TEST_ASSERT_EQUAL_STRING("first line\r\nsecond\r\n", received.c_str());
+    TEST_ASSERT_EQUAL_UINT32(0, sink.dropped);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_queue_order);
+    RUN_TEST(test_queue_wraps);
+    RUN_TEST(test_queue_full);
+    RUN_TEST(test_queue_peek_cuts);
+    RUN_TEST(test_syslog_priority);
+    RUN_TEST(test_syslog_timestamp);
+    RUN_TEST(test_syslog_strips_line_end);
+    RUN_TEST(test_syslog_cut);
+    RUN_TEST(test_syslog_sink_sends);
+    RUN_TEST(test_syslog_sink_drops);
+    RUN_TEST(test_ring_newest);
+    RUN_TEST(test_repeat_same_bytes);
+    RUN_TEST(test_telnet_sink_window);
+    return UNITY_END();
+}